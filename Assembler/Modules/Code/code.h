@@ -15,7 +15,7 @@
 class Code {
   private:
      /** @brief Maps computation mnemonics to their 7-bit binary encodings. */
-     static constexpr std::array<std::pair<std::string_view, uint8_t>, 25> m_comp_map {
+     static constexpr std::array<std::pair<std::string_view, uint8_t>, 34> m_comp_map {
        std::pair {"0",   0b0101010},
        std::pair {"1",   0b0111111},
        std::pair {"-1",  0b0111010},
@@ -25,6 +25,9 @@ class Code {
        std::pair {"!D",  0b0001101},
        std::pair {"!A",  0b0110001},
        std::pair {"!M",  0b1110001},
+       std::pair {"-D",  0b0001111},
+       std::pair {"-A",  0b0110011},
+       std::pair {"-M",  0b1110011},
        std::pair {"D+1", 0b0011111},
        std::pair {"A+1", 0b0110111},
        std::pair {"M+1", 0b1110111},
@@ -41,6 +44,13 @@ class Code {
        std::pair {"D&M", 0b1000000},
        std::pair {"D|A", 0b0010101},
        std::pair {"D|M", 0b1010101},
+       // Commuted spellings emitted by the VM translator (e.g. "M=M+D").
+       std::pair {"A+D", 0b0000010},
+       std::pair {"M+D", 0b1000010},
+       std::pair {"A&D", 0b0000000},
+       std::pair {"M&D", 0b1000000},
+       std::pair {"A|D", 0b0010101},
+       std::pair {"M|D", 0b1010101},
     };
 
     /** @brief Maps destination mnemonics to their 3-bit binary encodings. */
@@ -84,6 +94,18 @@ class Code {
     return 0;
   }
 
+   /** @brief Whether `key` is one of the mnemonics of an encoding table. */
+   template <typename  T, std::size_t n>
+   static constexpr bool contains (std::string_view key, const std::array<std::pair<std::string_view, T>, n>& map) noexcept {
+
+    for (auto&& [mnemonic, bits] : map) {
+      if (mnemonic == key)
+        return true;
+    }
+
+    return false;
+  }
+
   public:
     Code() = default;
     Code& operator=(const Code&) = delete;
@@ -108,4 +130,25 @@ class Code {
      * @return The 3-bit encoding, or 0 if invalid.
      */
     uint8_t jump(std::string_view mnemo) noexcept;
+
+    /**
+     * @brief Checks a destination mnemonic against the encoding table.
+     * @param mnemo The destination field; empty when the result is not stored.
+     * @return True if `mnemo` is empty or a known destination.
+     */
+    static constexpr bool isDest(std::string_view mnemo) noexcept { return mnemo.empty() || contains(mnemo, m_dest_map); }
+
+    /**
+     * @brief Checks a computation mnemonic against the encoding table.
+     * @param mnemo The computation field.
+     * @return True if `mnemo` is a known computation.
+     */
+    static constexpr bool isComp(std::string_view mnemo) noexcept { return contains(mnemo, m_comp_map); }
+
+    /**
+     * @brief Checks a jump mnemonic against the encoding table.
+     * @param mnemo The jump field; empty when the instruction does not jump.
+     * @return True if `mnemo` is empty or a known jump condition.
+     */
+    static constexpr bool isJump(std::string_view mnemo) noexcept { return mnemo.empty() || contains(mnemo, m_jump_map); }
 };
@@ -109,3 +109,13 @@ TEST_F(CodeTestObject, canReadJmpBits) {
 
   ASSERT_EQ(expectedJmpBits, jmpBits);
 }
+
+TEST_F(CodeTestObject, canEncodeNegatedAndCommutedComp) {
+  ASSERT_TRUE(code);
+
+  EXPECT_EQ(code->comp("-M"),  0b1110011);
+  EXPECT_EQ(code->comp("-D"),  0b0001111);
+  EXPECT_EQ(code->comp("M+D"), code->comp("D+M"));
+  EXPECT_EQ(code->comp("M&D"), code->comp("D&M"));
+  EXPECT_EQ(code->comp("M|D"), code->comp("D|M"));
+}
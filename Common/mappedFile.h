@@ -0,0 +1,81 @@
+/** @file
+ *  @brief Read-only, whole-file view used by the Jack tokenizer and the `.vmb` reader.
+ */
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+  #include <fstream>
+  #include <iterator>
+  #include <vector>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+/**
+ * @brief Maps a file into memory where mmap exists and reads it into a buffer otherwise.
+ *
+ * The bytes stay valid, and at the same address, for the lifetime of the object,
+ * so callers can hand out `std::string_view`s into them.
+ */
+class MappedFile {
+  private:
+    const char* m_data{};
+    std::size_t m_size{};
+#if defined(_WIN32)
+    std::vector<char> m_bytes;
+#endif
+
+  public:
+    /** @throws std::runtime_error if the file cannot be opened or mapped. */
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+      std::ifstream file(path, std::ios::binary);
+      if (!file)
+        throw std::runtime_error("[ERROR] Failed to open: " + path);
+      m_bytes.assign(std::istreambuf_iterator<char>(file), {});
+      m_data = m_bytes.data();
+      m_size = m_bytes.size();
+#else
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw std::runtime_error("[ERROR] Failed to open: " + path);
+      struct stat info {};
+      if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("[ERROR] Failed to stat: " + path);
+      }
+      m_size = static_cast<std::size_t>(info.st_size);
+      if (m_size > 0) {
+        void* mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+          ::close(fd);
+          throw std::runtime_error("[ERROR] Failed to map: " + path);
+        }
+        m_data = static_cast<const char*>(mapped);
+      }
+      ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+      if (m_data)
+        ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    std::string_view view() const { return { m_data, m_size }; }
+};
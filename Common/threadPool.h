@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * @file threadPool.h
+ * @brief Minimal fixed-size worker pool used to compile or translate files concurrently.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Runs submitted tasks on a fixed set of worker threads.
+ *
+ * Each task is wrapped in a `std::packaged_task`, so exceptions thrown by a
+ * task surface from the returned future's `get()` in the caller's thread.
+ */
+class ThreadPool {
+  private:
+    /** @brief Worker threads draining the task queue. */
+    std::vector<std::thread> m_workers;
+    /** @brief Pending tasks in submission order. */
+    std::queue<std::function<void()>> m_tasks;
+    /** @brief Guards `m_tasks` and `m_stopping`. */
+    std::mutex m_mutex;
+    /** @brief Signalled when a task is queued or the pool shuts down. */
+    std::condition_variable m_ready;
+    /** @brief Set once the destructor starts draining the pool. */
+    bool m_stopping{false};
+
+    void workerLoop() {
+      while (true) {
+        std::function<void()> task;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_ready.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+          if (m_stopping && m_tasks.empty())
+            return;
+          task = std::move(m_tasks.front());
+          m_tasks.pop();
+        }
+        task();
+      }
+    }
+
+  public:
+    /**
+     * @brief Starts the worker threads.
+     * @param nThreads Number of workers; 0 selects `std::thread::hardware_concurrency()`.
+     */
+    explicit ThreadPool(std::size_t nThreads = 0) {
+      if (nThreads == 0)
+        nThreads = std::thread::hardware_concurrency();
+      if (nThreads == 0)
+        nThreads = 1;
+
+      m_workers.reserve(nThreads);
+      for (std::size_t i{}; i < nThreads; ++i)
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Finishes all queued tasks and joins the workers. */
+    ~ThreadPool() {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+      }
+      m_ready.notify_all();
+      for (std::thread& worker : m_workers)
+        worker.join();
+    }
+
+    /**
+     * @brief Queues a task for execution on a worker.
+     * @return Future that becomes ready when the task finishes (or rethrows its exception).
+     */
+    template <typename Task>
+    std::future<void> submit(Task&& task) {
+      auto packaged = std::make_shared<std::packaged_task<void()>>(std::forward<Task>(task));
+      std::future<void> done = packaged->get_future();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace([packaged] { (*packaged)(); });
+      }
+      m_ready.notify_one();
+      return done;
+    }
+};
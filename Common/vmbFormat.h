@@ -0,0 +1,99 @@
+/** @file
+ *  @brief Binary VM format (`.vmb`) shared by the compiler and the VM translator.
+ *
+ *  Layout (all integers are unsigned LEB128 varints):
+ *
+ *      "VMB" kVmbVersion           4-byte magic
+ *      stringCount  { length bytes }*   function and label names, asm instructions
+ *      commandCount { command }*
+ *
+ *  A command is one opcode byte followed by its operands:
+ *
+ *      kOpAdd .. kOpNot                      (none)
+ *      kOpPush + segment, kOpPop + segment   index
+ *      kOpLabel, kOpGoto, kOpIfGoto          string id
+ *      kOpFunction                           string id, local count
+ *      kOpCall, kOpCallVoid                  string id, argument count
+ *      kOpReturn, kOpReturnVoid              (none)
+ *      kOpAsm                                string id (a Hack instruction)
+ *
+ *  `segment` is the value of `Segment` (constant, argument, local, static,
+ *  this, that, pointer, temp). Version 1 files have no void opcodes and
+ *  version 2 files no `asm`; both are still read, and an opcode newer than
+ *  the file's version is an error. Indices and counts are at most
+ *  `kMaxOperand`.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace vmb {
+
+inline constexpr char    kMagic[3]   { 'V', 'M', 'B' };
+inline constexpr uint8_t kVersion    { 3 };
+
+/** @brief Arithmetic opcodes, in `Command` order: add sub neg eq gt lt and or not. */
+inline constexpr uint8_t kOpAdd      { 0x00 };
+inline constexpr uint8_t kOpNot      { 0x08 };
+/** @brief Push/pop opcodes; the low three bits hold the segment. */
+inline constexpr uint8_t kOpPush     { 0x10 };
+inline constexpr uint8_t kOpPop      { 0x18 };
+inline constexpr uint8_t kOpLabel    { 0x20 };
+inline constexpr uint8_t kOpGoto     { 0x21 };
+inline constexpr uint8_t kOpIfGoto   { 0x22 };
+inline constexpr uint8_t kOpFunction { 0x23 };
+inline constexpr uint8_t kOpCall     { 0x24 };
+inline constexpr uint8_t kOpReturn   { 0x25 };
+/** @brief `call-void` / `return-void` (version 2). */
+inline constexpr uint8_t kOpCallVoid   { 0x26 };
+inline constexpr uint8_t kOpReturnVoid { 0x27 };
+/** @brief `asm instruction` (version 3). */
+inline constexpr uint8_t kOpAsm        { 0x28 };
+
+/** @brief Largest index or count an operand may hold: the biggest value an A-instruction loads. */
+inline constexpr uint32_t kMaxOperand { 0x7FFF };
+
+/** @brief First format version that has opcode `op`. */
+inline constexpr uint8_t versionOf(uint8_t op) {
+  if (op == kOpAsm)
+    return 3;
+  if (op == kOpCallVoid || op == kOpReturnVoid)
+    return 2;
+  return 1;
+}
+
+/** @brief Textual names of the arithmetic opcodes, indexed by opcode. */
+inline constexpr const char* kArithmeticNames[] { "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not" };
+/** @brief Textual names of the segments, indexed by the low bits of a push/pop opcode. */
+inline constexpr const char* kSegmentNames[] { "constant", "argument", "local", "static", "this", "that", "pointer", "temp" };
+
+/** @brief Appends `value` as an unsigned LEB128 varint. */
+inline void appendVarint(std::string& out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Decodes a varint starting at `pos`, advancing `pos` past it.
+ * @return The value, or nothing if the data ends inside the varint or it overflows 32 bits.
+ */
+inline std::optional<uint32_t> readVarint(const unsigned char* data, std::size_t size, std::size_t& pos) {
+  uint32_t value{};
+  for (unsigned shift{}; shift < 35 && pos < size; shift += 7) {
+    const unsigned char byte = data[pos++];
+    if (shift == 28 && (byte & 0x70))
+      return std::nullopt;
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+  return std::nullopt;
+}
+
+}
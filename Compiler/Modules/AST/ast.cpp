@@ -0,0 +1,53 @@
+#include "ast.h"
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+void Ast::clear() {
+  m_exprs.clear();
+  m_stmts.clear();
+  m_lists.clear();
+  m_strings.clear();
+  className.clear();
+  fieldCount = 0;
+  staticCount = 0;
+  subroutines.clear();
+}
+
+NodeId Ast::addExpr(const Expr& expr) {
+  m_exprs.push_back(expr);
+  return static_cast<NodeId>(m_exprs.size() - 1);
+}
+
+NodeId Ast::addStmt(const Stmt& stmt) {
+  m_stmts.push_back(stmt);
+  return static_cast<NodeId>(m_stmts.size() - 1);
+}
+
+NodeList Ast::addList(std::vector<NodeId>& scratch, std::size_t from) {
+  const NodeList list { static_cast<uint32_t>(m_lists.size()), static_cast<uint32_t>(scratch.size() - from) };
+  m_lists.insert(m_lists.end(), scratch.begin() + static_cast<std::ptrdiff_t>(from), scratch.end());
+  scratch.resize(from);
+  return list;
+}
+
+uint32_t Ast::addString(std::string_view text) {
+  m_strings.emplace_back(text);
+  return static_cast<uint32_t>(m_strings.size() - 1);
+}
+
+std::vector<std::string_view> inlineCalls(std::string_view code) {
+  std::vector<std::string_view> names;
+  while (!code.empty()) {
+    const std::size_t end { std::min(code.find('\n'), code.size()) };
+    const std::string_view line { code.substr(0, end) };
+    code.remove_prefix(std::min(end + 1, code.size()));
+
+    const std::size_t name { line.find(' ') + 1 };
+    if (line.rfind("call ", 0) == 0 || line.rfind("call-void ", 0) == 0)
+      names.push_back(line.substr(name, line.find(' ', name) - name));
+  }
+  return names;
+}
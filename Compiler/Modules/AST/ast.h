@@ -0,0 +1,154 @@
+/** @file
+ *  @brief Abstract syntax tree of one Jack class, stored in contiguous arenas.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Utils/keyword.h"
+#include "../Utils/segment.h"
+
+/** @brief Index of an `Expr` or `Stmt` in its `Ast` arena. */
+using NodeId = uint32_t;
+
+/** @brief Marks an absent optional child (e.g. the value of `return;`). */
+inline constexpr NodeId kNoNode { UINT32_MAX };
+
+/** @brief A run of `count` child ids stored contiguously in the `Ast` list arena. */
+struct NodeList {
+  uint32_t first {};
+  uint32_t count {};
+};
+
+enum class ExprKind : uint8_t {
+  IntConst,
+  StringConst,
+  KeywordConst,
+  Var,
+  ArrayElem,
+  Call,
+  Unary,
+  Binary,
+};
+
+/**
+ * @brief Expression node. Variables are already resolved to their segment and
+ *        index, and calls to their full `Class.sub` name.
+ */
+struct Expr {
+  ExprKind kind;
+  char     op {};            /**< Unary, Binary: the Jack operator symbol. */
+  Keyword  keyword {};       /**< KeywordConst: `true`, `false`, `null` or `this`. */
+  Segment  segment {};       /**< Var, ArrayElem: segment of the variable. Call: of the receiver. */
+  bool     hasReceiver {};   /**< Call: push `segment index` as the hidden first argument. */
+  uint32_t value {};         /**< IntConst: the value. StringConst, Call: id in the string pool. */
+  uint32_t index {};         /**< Var, ArrayElem, Call receiver: index within `segment`. */
+  NodeId   lhs { kNoNode };  /**< Unary operand, Binary left operand, ArrayElem subscript. */
+  NodeId   rhs { kNoNode };  /**< Binary right operand. */
+  NodeList args {};          /**< Call: the explicit arguments. */
+};
+
+enum class StmtKind : uint8_t {
+  Let,
+  If,
+  While,
+  Do,
+  Return,
+  Vm,
+  Asm,
+};
+
+/**
+ * @brief Statement node.
+ *
+ * `vm { ... }` and `asm { ... }` blocks keep their code as text, one VM
+ * command or Hack instruction per line, with variable names and the
+ * block's labels already resolved.
+ */
+struct Stmt {
+  StmtKind kind;
+  Segment  segment {};              /**< Let: segment of the assigned variable. */
+  uint32_t index {};                /**< Let: index of the assigned variable. Vm, Asm: the code's id in the string pool. */
+  NodeId   subscript { kNoNode };   /**< Let: array subscript, or `kNoNode` for a plain assignment. */
+  NodeId   expr { kNoNode };        /**< Let: value. If, While: condition. Do: the call. Return: value, if any. */
+  NodeList body {};                 /**< If: then-branch. While: loop body. */
+  NodeList orElse {};               /**< If: else-branch. */
+  bool     hasElse {};              /**< If: an `else` was written, even an empty one. */
+};
+
+enum class SubroutineKind : uint8_t {
+  Constructor,
+  Function,
+  Method,
+};
+
+/** @brief One subroutine declaration and its body. */
+struct Subroutine {
+  SubroutineKind kind;
+  std::string    name;        /**< Name without the class prefix. */
+  std::string    returnType;  /**< `void`, a primitive type or a class name. */
+  std::vector<std::string> parameterTypes;  /**< Declared types, without the implicit `this`. */
+  uint32_t       nLocals {};
+  NodeList       body {};
+  bool           removed {};  /**< Never called; kept for the class interface but not emitted. */
+};
+
+/**
+ * @brief Arena owning every node of one class.
+ *
+ * Nodes refer to each other by index, so each kind lives in one contiguous
+ * vector and the tree is freed in one go. Child lists (statement blocks and
+ * call arguments) are runs in a shared id vector.
+ */
+class Ast {
+  private:
+    std::vector<Expr>        m_exprs;
+    std::vector<Stmt>        m_stmts;
+    std::vector<NodeId>      m_lists;
+    std::vector<std::string> m_strings;
+
+  public:
+    std::string             className;
+    uint32_t                fieldCount {};  /**< Number of `field` variables, allocated by constructors. */
+    uint32_t                staticCount {}; /**< Number of `static` variables; generated statics come after them. */
+    std::vector<Subroutine> subroutines;
+
+    /** @brief Drop every node, e.g. before parsing the next class. */
+    void clear();
+
+    /** @brief Append an expression node and return its id. */
+    NodeId addExpr(const Expr& expr);
+
+    /** @brief Append a statement node and return its id. */
+    NodeId addStmt(const Stmt& stmt);
+
+    /**
+     * @brief Move the ids in `scratch` from `from` onwards into a new list,
+     *        truncating `scratch` back to `from`.
+     *
+     * Parsers collect the children of nested blocks on one shared scratch
+     * stack, so building a list never allocates a vector of its own.
+     */
+    NodeList addList(std::vector<NodeId>& scratch, std::size_t from);
+
+    /** @brief Add `text` to the string pool and return its id. */
+    uint32_t addString(std::string_view text);
+
+    Expr&       expr(NodeId id)       { return m_exprs[id]; }
+    const Expr& expr(NodeId id) const { return m_exprs[id]; }
+    Stmt&       stmt(NodeId id)       { return m_stmts[id]; }
+    const Stmt& stmt(NodeId id) const { return m_stmts[id]; }
+
+    /** @brief The `i`-th id of `list`. */
+    NodeId child(NodeList list, uint32_t i) const { return m_lists[list.first + i]; }
+
+    const std::string& string(uint32_t id) const { return m_strings[id]; }
+
+    std::size_t exprCount() const { return m_exprs.size(); }
+    std::size_t stmtCount() const { return m_stmts.size(); }
+};
+
+/** @brief Functions named by the `call` and `call-void` lines of a `vm` block's code. */
+std::vector<std::string_view> inlineCalls(std::string_view code);
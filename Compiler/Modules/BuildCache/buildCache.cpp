@@ -0,0 +1,219 @@
+#include "buildCache.h"
+#include "../AST/ast.h"
+#include "../../../Common/mappedFile.h"
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+constexpr uint64_t kFnvOffset { 0xcbf29ce484222325ull };
+constexpr uint64_t kFnvPrime  { 0x100000001b3ull };
+
+const char* kindName(SubroutineKind kind) {
+  switch (kind) {
+    case SubroutineKind::Constructor: return "constructor";
+    case SubroutineKind::Method:      return "method";
+    default:                          return "function";
+  }
+}
+
+bool isIdentifierChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isSpace(char c) {
+  return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+std::string header(const std::string& fingerprint) {
+  return "jack-build-cache " + std::to_string(BuildCache::kVersion) + " " + fingerprint;
+}
+}
+
+uint64_t hashBytes(std::string_view bytes) {
+  uint64_t hash { kFnvOffset };
+  for (char byte : bytes)
+    hash = (hash ^ static_cast<unsigned char>(byte)) * kFnvPrime;
+  return hash;
+}
+
+std::optional<uint64_t> hashFile(const std::filesystem::path& path) {
+  try {
+    const MappedFile file(path.string());
+    return hashBytes(file.view());
+  } catch (const std::runtime_error&) {
+    return std::nullopt;
+  }
+}
+
+uint64_t ClassInterface::hash() const {
+  std::string text { std::to_string(fieldCount) };
+  for (const std::string& subroutine : subroutines)
+    text += '\n' + subroutine;
+  return hashBytes(text);
+}
+
+std::set<std::string> qualifiedNames(std::string_view source) {
+  std::set<std::string> names;
+  const auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+  // Dots are rare, so find them first and read the identifiers on each side.
+  for (std::size_t dot { source.find('.') }; dot != std::string_view::npos; dot = source.find('.', dot + 1)) {
+    std::size_t ownerEnd { dot };
+    while (ownerEnd > 0 && isSpace(source[ownerEnd - 1]))
+      --ownerEnd;
+    std::size_t owner { ownerEnd };
+    while (owner > 0 && isIdentifierChar(source[owner - 1]))
+      --owner;
+
+    std::size_t member { dot + 1 };
+    while (member < source.size() && isSpace(source[member]))
+      ++member;
+    std::size_t memberEnd { member };
+    while (memberEnd < source.size() && isIdentifierChar(source[memberEnd]))
+      ++memberEnd;
+
+    if (owner == ownerEnd || memberEnd == member || isDigit(source[owner]) || isDigit(source[member]))
+      continue;
+    names.insert(std::string(source.substr(owner, ownerEnd - owner)) + "." +
+                 std::string(source.substr(member, memberEnd - member)));
+  }
+  return names;
+}
+
+ClassInterface extractInterface(const Ast& ast) {
+  ClassInterface interface { ast.fieldCount, {} };
+  for (const Subroutine& subroutine : ast.subroutines) {
+    std::string signature { std::string(kindName(subroutine.kind)) + " " + subroutine.returnType + " " +
+                            subroutine.name + "(" };
+    for (std::size_t i{}; i < subroutine.parameterTypes.size(); ++i)
+      signature += (i ? "," : "") + subroutine.parameterTypes[i];
+    interface.subroutines.push_back(signature + ")");
+  }
+  return interface;
+}
+
+std::set<std::string> referencedClasses(const Ast& ast) {
+  std::set<std::string> classes;
+  for (NodeId id{}; id < ast.exprCount(); ++id) {
+    const Expr& expr = ast.expr(id);
+    if (expr.kind != ExprKind::Call)
+      continue;
+    const std::string& name = ast.string(expr.value);
+    std::string owner { name.substr(0, name.find('.')) };
+    if (owner != ast.className)
+      classes.insert(std::move(owner));
+  }
+  for (NodeId id{}; id < ast.stmtCount(); ++id) {
+    const Stmt& stmt = ast.stmt(id);
+    if (stmt.kind != StmtKind::Vm)
+      continue;
+    for (std::string_view name : inlineCalls(ast.string(stmt.index))) {
+      std::string owner { name.substr(0, name.find('.')) };
+      if (owner != ast.className)
+        classes.insert(std::move(owner));
+    }
+  }
+  return classes;
+}
+
+BuildCache::BuildCache(std::string fingerprint)
+  : m_fingerprint(std::move(fingerprint))
+{}
+
+void BuildCache::load(const std::filesystem::path& path) {
+  m_entries.clear();
+
+  std::ifstream file(path);
+  std::string line;
+  if (!file || !std::getline(file, line) || line != header(m_fingerprint))
+    return;
+
+  std::map<std::string, CacheEntry> entries;
+  std::string name;
+  CacheEntry entry;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string tag;
+    fields >> tag;
+
+    bool ok { true };
+    if (tag == "class") {
+      ok = static_cast<bool>(fields >> name);
+      entry = {};
+    } else if (tag == "source") {
+      ok = static_cast<bool>(fields >> std::hex >> entry.sourceHash);
+    } else if (tag == "output") {
+      ok = static_cast<bool>(fields >> std::hex >> entry.outputHash);
+    } else if (tag == "callers") {
+      ok = static_cast<bool>(fields >> std::hex >> entry.callersHash);
+    } else if (tag == "fields") {
+      ok = static_cast<bool>(fields >> entry.interface.fieldCount);
+    } else if (tag == "sub") {
+      std::string signature;
+      std::getline(fields >> std::ws, signature);
+      entry.interface.subroutines.push_back(signature);
+    } else if (tag == "uses") {
+      std::string used;
+      uint64_t hash {};
+      ok = static_cast<bool>(fields >> used >> std::hex >> hash);
+      entry.uses[used] = hash;
+    } else if (tag == "end") {
+      ok = !name.empty();
+      entries[name] = std::move(entry);
+      name.clear();
+    } else {
+      ok = false;
+    }
+
+    if (!ok)
+      return;
+  }
+  if (name.empty())
+    m_entries = std::move(entries);
+}
+
+void BuildCache::save(const std::filesystem::path& path) const {
+  std::ofstream file(path);
+  file << header(m_fingerprint) << '\n' << std::hex;
+  for (const auto& [name, entry] : m_entries) {
+    file << "class " << name << '\n'
+         << "source " << entry.sourceHash << '\n'
+         << "output " << entry.outputHash << '\n'
+         << "callers " << entry.callersHash << '\n'
+         << "fields " << std::dec << entry.interface.fieldCount << std::hex << '\n';
+    for (const std::string& signature : entry.interface.subroutines)
+      file << "sub " << signature << '\n';
+    for (const auto& [used, hash] : entry.uses)
+      file << "uses " << used << ' ' << hash << '\n';
+    file << "end\n";
+  }
+}
+
+const CacheEntry* BuildCache::find(const std::string& file) const {
+  const auto it = m_entries.find(file);
+  return it == m_entries.end() ? nullptr : &it->second;
+}
+
+void BuildCache::store(const std::string& file, CacheEntry entry) {
+  m_entries[file] = std::move(entry);
+}
+
+void BuildCache::erase(const std::string& file) {
+  m_entries.erase(file);
+}
+
+void BuildCache::retain(const std::set<std::string>& files) {
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+    it = files.count(it->first) ? std::next(it) : m_entries.erase(it);
+}
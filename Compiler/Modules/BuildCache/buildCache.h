@@ -0,0 +1,91 @@
+/** @file
+ *  @brief Build cache for incremental project compilation: content hashes,
+ *         class interfaces and the interfaces each class was compiled against.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../AST/ast.h"
+
+/** @brief 64-bit FNV-1a hash of `bytes`. */
+uint64_t hashBytes(std::string_view bytes);
+
+/** @brief Hash of a file's contents, or nothing if it cannot be read. */
+std::optional<uint64_t> hashFile(const std::filesystem::path& path);
+
+/**
+ * @brief What other classes can see of a class: its field count and the
+ *        kind, return type, name and parameter types of each subroutine.
+ */
+struct ClassInterface {
+  uint32_t fieldCount {};
+  std::vector<std::string> subroutines;  /**< `method int get(int,Point)`, in declaration order. */
+
+  uint64_t hash() const;
+};
+
+/** @brief Interface of the class in `ast`. */
+ClassInterface extractInterface(const Ast& ast);
+
+/** @brief Classes whose subroutines `ast` calls, other than its own. */
+std::set<std::string> referencedClasses(const Ast& ast);
+
+/**
+ * @brief Every `Name.name` pair in Jack `source`, such as `Output.printInt` or
+ *        `p.getX`, with any whitespace around the dot removed.
+ *
+ * A text scan, so it is cheap enough to run over a whole project before
+ * anything is parsed. Comments and strings are scanned too, which can only
+ * add names.
+ */
+std::set<std::string> qualifiedNames(std::string_view source);
+
+/** @brief What the cache remembers about one `.jack` file. */
+struct CacheEntry {
+  uint64_t sourceHash {};
+  uint64_t outputHash {};              /**< Hash of the `.vm` / `.vmb` it produced. */
+  ClassInterface interface;
+  std::map<std::string, uint64_t> uses; /**< Referenced class → its interface hash then (0 if not in the project). */
+  uint64_t callersHash {};             /**< Hash of the class's subroutines other classes called then. */
+};
+
+/**
+ * @brief Per-directory record of the last successful compile of each class.
+ *
+ * Stored as a small text file. Entries only count when the compiler settings
+ * fingerprint matches, so a cache written with other options, or by a
+ * compiler with a different `kVersion`, is ignored.
+ */
+class BuildCache {
+  private:
+    std::string m_fingerprint;
+    std::map<std::string, CacheEntry> m_entries;  /**< By file name. */
+
+  public:
+    /** @brief Bump when generated code changes for the same options. */
+    static constexpr uint32_t kVersion { 3 };
+
+    /** @brief Name of the cache file inside a project directory. */
+    static constexpr const char* kFileName { ".jackcache" };
+
+    /** @param fingerprint Compiler settings the cached outputs were built with. */
+    explicit BuildCache(std::string fingerprint);
+
+    /** @brief Replace the entries by those in `path`; a missing, stale or malformed file leaves the cache empty. */
+    void load(const std::filesystem::path& path);
+    void save(const std::filesystem::path& path) const;
+
+    const CacheEntry* find(const std::string& file) const;
+    void store(const std::string& file, CacheEntry entry);
+    void erase(const std::string& file);
+
+    /** @brief Drop entries of files not in `files`. */
+    void retain(const std::set<std::string>& files);
+};
@@ -0,0 +1,627 @@
+#include "codeGenerator.h"
+#include "../AST/ast.h"
+#include "../VMWriter/vmWriter.h"
+#include "../Utils/command.h"
+#include "../Utils/compilerOptions.h"
+#include "../Utils/keyword.h"
+#include "../Utils/segment.h"
+#include "strengthReduction.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+constexpr uint32_t kMaxPushConstant { 32767 };
+
+enum class Intrinsic : uint8_t {
+  None,
+  Peek,
+  Poke,
+  Abs,
+  Min,
+  Max,
+};
+
+struct IntrinsicName {
+  const char* name;
+  uint32_t    nArgs;
+  Intrinsic   intrinsic;
+};
+
+constexpr IntrinsicName kIntrinsics[] {
+  { "Memory.peek", 1, Intrinsic::Peek },
+  { "Memory.poke", 2, Intrinsic::Poke },
+  { "Math.abs",    1, Intrinsic::Abs  },
+  { "Math.min",    2, Intrinsic::Min  },
+  { "Math.max",    2, Intrinsic::Max  },
+};
+
+Intrinsic intrinsicOf(const std::string& name, uint32_t nArgs) {
+  for (const IntrinsicName& candidate : kIntrinsics)
+    if (candidate.nArgs == nArgs && name == candidate.name)
+      return candidate.intrinsic;
+  return Intrinsic::None;
+}
+}
+
+CodeGenerator::CodeGenerator(VmWriter& vmWriter, const CompilerOptions& options)
+  : m_VmWriter(vmWriter)
+  , m_options(options)
+{}
+
+std::string CodeGenerator::makeLabel(const std::string& base, uint32_t index) const {
+  return m_ast->className + "." + m_subroutine->name + "$" + base + std::to_string(index);
+}
+
+void CodeGenerator::generate(const Ast& ast) {
+  m_ast = &ast;
+  m_ifLabelIdx = 0;
+  m_whileLabelIdx = 0;
+  m_stringLabelIdx = 0;
+  m_pool.clear();
+  m_poolSlots.clear();
+
+  for (const Subroutine& subroutine : ast.subroutines)
+    if (!subroutine.removed)
+      generateSubroutine(subroutine);
+
+  if (!m_pool.empty())
+    generateStringPool();
+}
+
+void CodeGenerator::generateSubroutine(const Subroutine& subroutine) {
+  m_subroutine = &subroutine;
+  m_VmWriter.writeFunction(m_ast->className + "." + subroutine.name, subroutine.nLocals);
+
+  if (subroutine.kind == SubroutineKind::Constructor) {
+    m_VmWriter.writePush(Segment::Constant, m_ast->fieldCount);
+    m_VmWriter.writeCall("Memory.alloc", 1);
+    m_VmWriter.writePop(Segment::Pointer, 0);
+  } else if (subroutine.kind == SubroutineKind::Method) {
+    m_VmWriter.writePush(Segment::Argument, 0);
+    m_VmWriter.writePop(Segment::Pointer, 0);
+  }
+
+  generateStatements(subroutine.body);
+}
+
+void CodeGenerator::generateStatements(NodeList statements) {
+  for (uint32_t i{}; i < statements.count; ++i)
+    generateStatement(m_ast->stmt(m_ast->child(statements, i)));
+}
+
+void CodeGenerator::generateStatement(const Stmt& stmt) {
+  switch (stmt.kind) {
+    case StmtKind::Let:
+      generateLet(stmt);
+      break;
+    case StmtKind::If:
+      generateIf(stmt);
+      break;
+    case StmtKind::While:
+      generateWhile(stmt);
+      break;
+    case StmtKind::Do: {
+      const Expr& call { m_ast->expr(stmt.expr) };
+      if (generateIntrinsic(call, false))
+        break;
+      if (call.kind == ExprKind::Call) {
+        generateCall(call, false);
+        break;
+      }
+      generateExpression(stmt.expr);
+      m_VmWriter.writePop(Segment::Temp, 0);
+      break;
+    }
+    case StmtKind::Return:
+      if (stmt.expr == kNoNode && m_options.voidCalls) {
+        m_VmWriter.writeReturnVoid();
+        break;
+      }
+      if (stmt.expr != kNoNode)
+        generateExpression(stmt.expr);
+      else
+        m_VmWriter.writePush(Segment::Constant, 0);
+      m_VmWriter.writeReturn();
+      break;
+    case StmtKind::Vm:
+    case StmtKind::Asm:
+      generateInline(stmt);
+      break;
+  }
+}
+
+void CodeGenerator::generateInline(const Stmt& block) {
+  std::string_view code { m_ast->string(block.index) };
+  while (!code.empty()) {
+    const std::string_view line { code.substr(0, code.find('\n')) };
+    code.remove_prefix(line.size() + 1);
+    if (block.kind == StmtKind::Asm) {
+      m_VmWriter.writeAsm(line);
+      continue;
+    }
+
+    // The engine stored each command in canonical form: `op [name|segment] [number]`.
+    std::string_view words[3] {};
+    std::string_view rest { line };
+    for (std::string_view& word : words) {
+      word = rest.substr(0, rest.find(' '));
+      rest.remove_prefix(std::min(word.size() + 1, rest.size()));
+    }
+    const std::string_view op { words[0] };
+    uint32_t number {};
+    std::from_chars(words[2].data(), words[2].data() + words[2].size(), number);
+
+    if (op == "push") {
+      m_VmWriter.writePush(*segmentNamed(words[1]), number);
+    } else if (op == "pop") {
+      m_VmWriter.writePop(*segmentNamed(words[1]), number);
+    } else if (op == "label") {
+      m_VmWriter.writeLabel(words[1]);
+    } else if (op == "goto") {
+      m_VmWriter.writeGoto(words[1]);
+    } else if (op == "if-goto") {
+      m_VmWriter.writeIf(words[1]);
+    } else if (op == "call") {
+      m_VmWriter.writeCall(words[1], number);
+    } else if (op == "call-void" && m_options.voidCalls) {
+      m_VmWriter.writeCallVoid(words[1], number);
+    } else if (op == "call-void") {
+      m_VmWriter.writeCall(words[1], number);
+      m_VmWriter.writePop(Segment::Temp, 0);
+    } else if (op == "return") {
+      m_VmWriter.writeReturn();
+    } else if (op == "return-void" && m_options.voidCalls) {
+      m_VmWriter.writeReturnVoid();
+    } else if (op == "return-void") {
+      m_VmWriter.writePush(Segment::Constant, 0);
+      m_VmWriter.writeReturn();
+    } else {
+      m_VmWriter.writeArithmetic(*commandNamed(op));
+    }
+  }
+}
+
+void CodeGenerator::generateLet(const Stmt& stmt) {
+  if (stmt.subscript == kNoNode) {
+    generateExpression(stmt.expr);
+    m_VmWriter.writePop(stmt.segment, stmt.index);
+    return;
+  }
+
+  m_VmWriter.writePush(stmt.segment, stmt.index);
+  generateExpression(stmt.subscript);
+  m_VmWriter.writeArithmetic(Command::Add);
+
+  generateExpression(stmt.expr);
+
+  m_VmWriter.writePop(Segment::Temp, 0);
+  m_VmWriter.writePop(Segment::Pointer, 1);
+  m_VmWriter.writePush(Segment::Temp, 0);
+  m_VmWriter.writePop(Segment::That, 0);
+}
+
+void CodeGenerator::generateIf(const Stmt& stmt) {
+  uint32_t idx { m_ifLabelIdx++ };
+  std::string labelTrue  = makeLabel("IF_TRUE", idx);
+  std::string labelFalse = makeLabel("IF_FALSE", idx);
+  std::string labelEnd   = makeLabel("IF_END", idx);
+
+  // `if-goto` takes any non-zero value as true, so only conditions known to
+  // be -1/0 can be inverted with `not`.
+  if (m_options.compactBranches && isBoolean(stmt.expr)) {
+    generateBranch(stmt.expr, false, labelFalse);
+  } else {
+    generateExpression(stmt.expr);
+
+    m_VmWriter.writeIf(labelTrue);
+    m_VmWriter.writeGoto(labelFalse);
+    m_VmWriter.writeLabel(labelTrue);
+  }
+
+  generateStatements(stmt.body);
+
+  if (stmt.hasElse) {
+    m_VmWriter.writeGoto(labelEnd);
+    m_VmWriter.writeLabel(labelFalse);
+    generateStatements(stmt.orElse);
+    m_VmWriter.writeLabel(labelEnd);
+  } else {
+    m_VmWriter.writeLabel(labelFalse);
+  }
+}
+
+void CodeGenerator::generateWhile(const Stmt& stmt) {
+  uint32_t idx = m_whileLabelIdx++;
+  std::string labelExp = makeLabel("WHILE_EXP", idx);
+
+  // Rotated: one entry jump to the test at the bottom, which branches back
+  // while the condition holds.
+  if (m_options.compactBranches && isBoolean(stmt.expr)) {
+    std::string labelBody = makeLabel("WHILE_BODY", idx);
+
+    m_VmWriter.writeGoto(labelExp);
+    m_VmWriter.writeLabel(labelBody);
+    generateStatements(stmt.body);
+    m_VmWriter.writeLabel(labelExp);
+    generateBranch(stmt.expr, true, labelBody);
+    return;
+  }
+
+  std::string labelEnd = makeLabel("WHILE_END", idx);
+
+  m_VmWriter.writeLabel(labelExp);
+
+  generateExpression(stmt.expr);
+  m_VmWriter.writeArithmetic(Command::Not);
+  m_VmWriter.writeIf(labelEnd);
+
+  generateStatements(stmt.body);
+
+  m_VmWriter.writeGoto(labelExp);
+  m_VmWriter.writeLabel(labelEnd);
+}
+
+bool CodeGenerator::isBoolean(NodeId id) const {
+  const Expr& expr = m_ast->expr(id);
+  switch (expr.kind) {
+    case ExprKind::KeywordConst:
+      return expr.keyword == Keyword::True || expr.keyword == Keyword::False;
+    case ExprKind::Unary:
+      return expr.op == '~' && isBoolean(expr.lhs);
+    case ExprKind::Binary:
+      if (expr.op == '=' || expr.op == '<' || expr.op == '>')
+        return true;
+      return (expr.op == '&' || expr.op == '|') && isBoolean(expr.lhs) && isBoolean(expr.rhs);
+    default:
+      return false;
+  }
+}
+
+void CodeGenerator::generateBranch(NodeId condition, bool whenTrue, const std::string& label) {
+  const Expr& expr = m_ast->expr(condition);
+
+  if (expr.kind == ExprKind::Unary && expr.op == '~') {
+    generateBranch(expr.lhs, !whenTrue, label);
+    return;
+  }
+
+  if (expr.kind == ExprKind::KeywordConst) {
+    if ((expr.keyword == Keyword::True) == whenTrue)
+      m_VmWriter.writeGoto(label);
+    return;
+  }
+
+  if (expr.kind == ExprKind::Binary && expr.op == '=' && !whenTrue) {
+    generateExpression(expr.lhs);
+    generateExpression(expr.rhs);
+    m_VmWriter.writeArithmetic(Command::Sub);
+    m_VmWriter.writeIf(label);
+    return;
+  }
+
+  generateExpression(condition);
+  if (!whenTrue)
+    m_VmWriter.writeArithmetic(Command::Not);
+  m_VmWriter.writeIf(label);
+}
+
+void CodeGenerator::generateExpression(NodeId id) {
+  const Expr& expr = m_ast->expr(id);
+
+  switch (expr.kind) {
+    case ExprKind::IntConst:
+      writeConstant(expr.value & 0xFFFFu);
+      break;
+
+    case ExprKind::StringConst:
+      if (m_options.stringPool)
+        generatePooledString(m_ast->string(expr.value));
+      else
+        writeNewString(m_ast->string(expr.value));
+      break;
+
+    case ExprKind::KeywordConst:
+      if (expr.keyword == Keyword::This) {
+        m_VmWriter.writePush(Segment::Pointer, 0);
+      } else {
+        m_VmWriter.writePush(Segment::Constant, 0);
+        if (expr.keyword == Keyword::True)
+          m_VmWriter.writeArithmetic(Command::Not);
+      }
+      break;
+
+    case ExprKind::Var:
+      m_VmWriter.writePush(expr.segment, expr.index);
+      break;
+
+    case ExprKind::ArrayElem:
+      m_VmWriter.writePush(expr.segment, expr.index);
+      generateExpression(expr.lhs);
+      m_VmWriter.writeArithmetic(Command::Add);
+      m_VmWriter.writePop(Segment::Pointer, 1);
+      m_VmWriter.writePush(Segment::That, 0);
+      break;
+
+    case ExprKind::Call:
+      if (!generateIntrinsic(expr, true))
+        generateCall(expr);
+      break;
+
+    case ExprKind::Unary:
+      generateExpression(expr.lhs);
+      m_VmWriter.writeArithmetic(expr.op == '-' ? Command::Neg : Command::Not);
+      break;
+
+    case ExprKind::Binary:
+      if ((expr.op == '*' || expr.op == '/') && m_options.strengthReduction && generateReducedBinary(expr))
+        break;
+      generateExpression(expr.lhs);
+      generateExpression(expr.rhs);
+      switch (expr.op) {
+        case '+': m_VmWriter.writeArithmetic(Command::Add); break;
+        case '-': m_VmWriter.writeArithmetic(Command::Sub); break;
+        case '&': m_VmWriter.writeArithmetic(Command::And); break;
+        case '|': m_VmWriter.writeArithmetic(Command::Or);  break;
+        case '<': m_VmWriter.writeArithmetic(Command::Lt);  break;
+        case '>': m_VmWriter.writeArithmetic(Command::Gt);  break;
+        case '=': m_VmWriter.writeArithmetic(Command::Eq);  break;
+        case '*':
+          m_VmWriter.writeCall("Math.multiply", 2);
+          break;
+        case '/':
+          m_VmWriter.writeCall("Math.divide", 2);
+          break;
+      }
+      break;
+  }
+}
+
+void CodeGenerator::generateCall(const Expr& call, bool valueUsed) {
+  if (call.hasReceiver)
+    m_VmWriter.writePush(call.segment, call.index);
+
+  for (uint32_t i{}; i < call.args.count; ++i)
+    generateExpression(m_ast->child(call.args, i));
+
+  const uint32_t nArgs { call.args.count + (call.hasReceiver ? 1 : 0) };
+  if (valueUsed) {
+    m_VmWriter.writeCall(m_ast->string(call.value), nArgs);
+  } else if (m_options.voidCalls) {
+    m_VmWriter.writeCallVoid(m_ast->string(call.value), nArgs);
+  } else {
+    m_VmWriter.writeCall(m_ast->string(call.value), nArgs);
+    m_VmWriter.writePop(Segment::Temp, 0);
+  }
+}
+
+bool CodeGenerator::isSimple(NodeId id) const {
+  const ExprKind kind { m_ast->expr(id).kind };
+  return kind == ExprKind::Var || kind == ExprKind::IntConst || kind == ExprKind::KeywordConst;
+}
+
+bool CodeGenerator::hasCall(NodeId id) const {
+  const Expr& expr = m_ast->expr(id);
+  switch (expr.kind) {
+    case ExprKind::Call:
+    case ExprKind::StringConst:
+      return true;
+    case ExprKind::ArrayElem:
+    case ExprKind::Unary:
+      return hasCall(expr.lhs);
+    case ExprKind::Binary:
+      return hasCall(expr.lhs) || hasCall(expr.rhs);
+    default:
+      return false;
+  }
+}
+
+bool CodeGenerator::generateIntrinsic(const Expr& call, bool valueUsed) {
+  if (!m_options.intrinsics || call.kind != ExprKind::Call || call.hasReceiver)
+    return false;
+  const Intrinsic intrinsic { intrinsicOf(m_ast->string(call.value), call.args.count) };
+  if (intrinsic == Intrinsic::None)
+    return false;
+
+  const NodeId first { m_ast->child(call.args, 0) };
+  const NodeId second { call.args.count > 1 ? m_ast->child(call.args, 1) : kNoNode };
+
+  if (intrinsic == Intrinsic::Poke) {
+    generateExpression(first);
+    if (isSimple(second)) {
+      m_VmWriter.writePop(Segment::Pointer, 1);
+      generateExpression(second);
+    } else {
+      generateExpression(second);
+      m_VmWriter.writePop(Segment::Temp, 0);
+      m_VmWriter.writePop(Segment::Pointer, 1);
+      m_VmWriter.writePush(Segment::Temp, 0);
+    }
+    m_VmWriter.writePop(Segment::That, 0);
+    if (valueUsed)
+      m_VmWriter.writePush(Segment::Constant, 0);
+    return true;
+  }
+
+  if (intrinsic == Intrinsic::Peek) {
+    generateExpression(first);
+    m_VmWriter.writePop(Segment::Pointer, 1);
+    m_VmWriter.writePush(Segment::That, 0);
+  } else {
+    // Operands are read several times: variables and constants are pushed
+    // again, anything else is evaluated once, in order, and spilled. The
+    // first operand is only re-read if the second cannot have changed it.
+    const bool reloadFirst { isSimple(first) && (second == kNoNode || !hasCall(second)) };
+    const bool reloadSecond { second != kNoNode && isSimple(second) };
+    if (!reloadFirst)
+      generateExpression(first);
+    if (second != kNoNode && !reloadSecond)
+      generateExpression(second);
+    if (second != kNoNode && !reloadSecond)
+      m_VmWriter.writePop(Segment::Temp, kScratchTemp);
+    if (!reloadFirst)
+      m_VmWriter.writePop(Segment::Temp, kSpillTemp);
+
+    const auto pushFirst = [&] {
+      if (reloadFirst)
+        generateExpression(first);
+      else
+        m_VmWriter.writePush(Segment::Temp, kSpillTemp);
+    };
+    const auto pushSecond = [&] {
+      if (reloadSecond)
+        generateExpression(second);
+      else
+        m_VmWriter.writePush(Segment::Temp, kScratchTemp);
+    };
+
+    if (intrinsic == Intrinsic::Abs) {
+      // x + ((x < 0) & -(x + x))
+      pushFirst();
+      pushFirst();
+      m_VmWriter.writePush(Segment::Constant, 0);
+      m_VmWriter.writeArithmetic(Command::Lt);
+      pushFirst();
+      pushFirst();
+      m_VmWriter.writeArithmetic(Command::Add);
+      m_VmWriter.writeArithmetic(Command::Neg);
+    } else {
+      // b + ((a - b) & (a < b)) for min, with `>` for max
+      pushSecond();
+      pushFirst();
+      pushSecond();
+      m_VmWriter.writeArithmetic(Command::Sub);
+      pushFirst();
+      pushSecond();
+      m_VmWriter.writeArithmetic(intrinsic == Intrinsic::Min ? Command::Lt : Command::Gt);
+    }
+    m_VmWriter.writeArithmetic(Command::And);
+    m_VmWriter.writeArithmetic(Command::Add);
+  }
+
+  if (!valueUsed)
+    m_VmWriter.writePop(Segment::Temp, 0);
+  return true;
+}
+
+void CodeGenerator::writeNewString(std::string_view text) {
+  m_VmWriter.writePush(Segment::Constant, static_cast<uint32_t>(text.size()));
+  m_VmWriter.writeCall("String.new", 1);
+  for (char c : text) {
+    m_VmWriter.writePush(Segment::Constant, static_cast<uint32_t>(static_cast<unsigned char>(c)));
+    m_VmWriter.writeCall("String.appendChar", 2);
+  }
+}
+
+void CodeGenerator::generatePooledString(const std::string& text) {
+  const auto [slot, added] = m_poolSlots.try_emplace(text, static_cast<uint32_t>(m_pool.size()));
+  if (added)
+    m_pool.push_back(text);
+
+  // The pool array lives in the first static after the declared ones and is
+  // 0 until the pool function has run.
+  std::string labelReady = makeLabel("STRINGS_READY", m_stringLabelIdx++);
+  m_VmWriter.writePush(Segment::Static, m_ast->staticCount);
+  m_VmWriter.writeIf(labelReady);
+  if (m_options.voidCalls) {
+    m_VmWriter.writeCallVoid(m_ast->className + "." + kStringPoolFunction, 0);
+  } else {
+    m_VmWriter.writeCall(m_ast->className + "." + kStringPoolFunction, 0);
+    m_VmWriter.writePop(Segment::Temp, 0);
+  }
+  m_VmWriter.writeLabel(labelReady);
+
+  m_VmWriter.writePush(Segment::Static, m_ast->staticCount);
+  if (slot->second) {
+    m_VmWriter.writePush(Segment::Constant, slot->second);
+    m_VmWriter.writeArithmetic(Command::Add);
+  }
+  m_VmWriter.writePop(Segment::Pointer, 1);
+  m_VmWriter.writePush(Segment::That, 0);
+}
+
+void CodeGenerator::generateStringPool() {
+  m_VmWriter.writeFunction(m_ast->className + "." + kStringPoolFunction, 0);
+  m_VmWriter.writePush(Segment::Constant, static_cast<uint32_t>(m_pool.size()));
+  m_VmWriter.writeCall("Array.new", 1);
+  m_VmWriter.writePop(Segment::Static, m_ast->staticCount);
+
+  for (uint32_t slot{}; slot < m_pool.size(); ++slot) {
+    m_VmWriter.writePush(Segment::Static, m_ast->staticCount);
+    if (slot) {
+      m_VmWriter.writePush(Segment::Constant, slot);
+      m_VmWriter.writeArithmetic(Command::Add);
+    }
+    writeNewString(m_pool[slot]);
+    m_VmWriter.writePop(Segment::Temp, 0);
+    m_VmWriter.writePop(Segment::Pointer, 1);
+    m_VmWriter.writePush(Segment::Temp, 0);
+    m_VmWriter.writePop(Segment::That, 0);
+  }
+
+  if (m_options.voidCalls) {
+    m_VmWriter.writeReturnVoid();
+  } else {
+    m_VmWriter.writePush(Segment::Constant, 0);
+    m_VmWriter.writeReturn();
+  }
+}
+
+void CodeGenerator::writeConstant(uint32_t bits) {
+  // `push constant` only takes 0..32767; other 16-bit patterns (folded
+  // negative values) are pushed complemented and flipped with `not`.
+  if (bits <= kMaxPushConstant) {
+    m_VmWriter.writePush(Segment::Constant, bits);
+  } else {
+    m_VmWriter.writePush(Segment::Constant, ~bits & 0xFFFFu);
+    m_VmWriter.writeArithmetic(Command::Not);
+  }
+}
+
+void CodeGenerator::writeSequence(const VmSequence& ops) {
+  for (const VmOp& op : ops) {
+    switch (op.kind) {
+      case VmOp::Kind::Push:
+        if (op.segment == Segment::Constant)
+          writeConstant(op.index);
+        else
+          m_VmWriter.writePush(op.segment, op.index);
+        break;
+      case VmOp::Kind::Pop:
+        m_VmWriter.writePop(op.segment, op.index);
+        break;
+      case VmOp::Kind::Arithmetic:
+        m_VmWriter.writeArithmetic(op.command);
+        break;
+    }
+  }
+}
+
+bool CodeGenerator::generateReducedBinary(const Expr& binary) {
+  NodeId operand { binary.lhs };
+  const Expr* constant { &m_ast->expr(binary.rhs) };
+  if (constant->kind != ExprKind::IntConst && binary.op == '*') {
+    operand  = binary.rhs;
+    constant = &m_ast->expr(binary.lhs);
+  }
+  if (constant->kind != ExprKind::IntConst)
+    return false;
+
+  // A variable can be pushed again instead of being spilled to a temp.
+  const Expr& x = m_ast->expr(operand);
+  std::optional<VmOp> reload;
+  if (x.kind == ExprKind::Var)
+    reload = VmOp { VmOp::Kind::Push, x.segment, x.index };
+
+  const std::optional<VmSequence> ops { reduceStrength(binary.op, static_cast<uint16_t>(constant->value), reload) };
+  if (!ops)
+    return false;
+
+  generateExpression(operand);
+  writeSequence(*ops);
+  return true;
+}
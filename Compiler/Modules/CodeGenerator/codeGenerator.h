@@ -0,0 +1,128 @@
+/** @file
+ *  @brief Declaration of the `CodeGenerator`, which walks a Jack `Ast` and
+ *         emits Nand2Tetris VM code.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../AST/ast.h"
+#include "../Utils/compilerOptions.h"
+#include "../VMWriter/vmWriter.h"
+#include "strengthReduction.h"
+
+/**
+ * @brief Emits the VM code of a parsed class through a `VmWriter`.
+ *
+ * Separate from parsing so that passes can rewrite the tree in between; an
+ * unmodified tree produces exactly the code the one-pass compiler used to.
+ */
+class CodeGenerator {
+  private:
+    VmWriter& m_VmWriter;
+    CompilerOptions m_options;
+    const Ast* m_ast {};
+    const Subroutine* m_subroutine {};
+    uint32_t m_ifLabelIdx{0};
+    uint32_t m_whileLabelIdx{0};
+    uint32_t m_stringLabelIdx{0};
+
+    /** @brief Distinct literals of the class in slot order, and the slot of each. */
+    std::vector<std::string_view> m_pool;
+    std::unordered_map<std::string_view, uint32_t> m_poolSlots;
+
+    /** @brief Build a function-scoped label name of the form `Class.sub$baseN`. */
+    std::string makeLabel(const std::string& base, uint32_t index) const;
+
+    void generateSubroutine(const Subroutine& subroutine);
+    void generateStatements(NodeList statements);
+    void generateStatement(const Stmt& stmt);
+    void generateLet(const Stmt& stmt);
+    void generateIf(const Stmt& stmt);
+    void generateWhile(const Stmt& stmt);
+
+    /**
+     * @brief Emit the commands of a `vm` block, or each instruction of an
+     *        `asm` block as an `asm` command.
+     */
+    void generateInline(const Stmt& block);
+
+    /** @brief Whether `id` always evaluates to true (-1) or false (0). */
+    bool isBoolean(NodeId id) const;
+
+    /**
+     * @brief Jump to `label` when the boolean `condition` is `whenTrue`.
+     *
+     * Folds `~` into the branch sense, tests `a = b` for false with `sub`
+     * instead of `eq; not`, and turns `true`/`false` into a `goto` or nothing.
+     */
+    void generateBranch(NodeId condition, bool whenTrue, const std::string& label);
+    void generateExpression(NodeId id);
+    /** @brief Push the receiver and arguments and call; `valueUsed == false` discards the result. */
+    void generateCall(const Expr& call, bool valueUsed = true);
+
+    /** @brief Whether `id` is a variable or constant, which can be pushed again at no cost. */
+    bool isSimple(NodeId id) const;
+
+    /** @brief Whether evaluating `id` calls a subroutine, which may change variables. */
+    bool hasCall(NodeId id) const;
+
+    /**
+     * @brief Emit a `Memory.peek`, `Memory.poke`, `Math.abs`, `Math.min` or
+     *        `Math.max` call inline; returns false, emitting nothing, for any
+     *        other expression.
+     * @param valueUsed Leave the result on the stack; otherwise leave nothing.
+     */
+    bool generateIntrinsic(const Expr& call, bool valueUsed);
+
+    /** @brief Build a new `String` holding `text` with `String.new` and one `appendChar` per character. */
+    void writeNewString(std::string_view text);
+
+    /**
+     * @brief Push the pooled `String` for `text`, calling the class's
+     *        `$strings` function first if the pool has not been built yet.
+     */
+    void generatePooledString(const std::string& text);
+
+    /**
+     * @brief Emit `Class.$strings`, which stores an array of every pooled
+     *        literal in the class's hidden static.
+     */
+    void generateStringPool();
+
+    /** @brief Push a 16-bit pattern, complemented and flipped with `not` above 32767. */
+    void writeConstant(uint32_t bits);
+    void writeSequence(const VmSequence& ops);
+
+    /**
+     * @brief Emit `x * c`, `c * x` or `x / c` inline when the cost model
+     *        prefers it over the OS call; returns false if nothing was emitted.
+     */
+    bool generateReducedBinary(const Expr& binary);
+
+  public:
+    /**
+     * @brief OS functions the generated code calls without the source naming
+     *        them: `*`, `/`, constructors and string literals.
+     */
+    static constexpr std::string_view kImplicitCallees[] {
+      "Math.multiply", "Math.divide", "Memory.alloc", "String.new", "String.appendChar", "Array.new",
+    };
+
+    /** @brief Name, without the class prefix, of the function that builds a class's string pool. */
+    static constexpr const char* kStringPoolFunction { "$strings" };
+
+    /** @brief Construct a code generator writing to the given VM writer. */
+    explicit CodeGenerator(VmWriter& vmWriter, const CompilerOptions& options = {});
+    CodeGenerator& operator=(CodeGenerator&) = delete;
+    CodeGenerator(CodeGenerator&) = delete;
+
+    /**
+     * @brief Emit every subroutine of `ast` not marked `removed`, in declaration
+     *        order, followed by the string pool function if any literal was pooled.
+     */
+    void generate(const Ast& ast);
+};
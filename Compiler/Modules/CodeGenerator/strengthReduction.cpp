@@ -0,0 +1,136 @@
+#include "strengthReduction.h"
+#include "../Utils/command.h"
+#include "../Utils/segment.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace {
+constexpr uint32_t kMaxPushConstant { 32767 };
+
+// Call-site figures measured on VM-Translator output; the routine figures are
+// estimates for the book's OS: `Math.multiply` runs its 16-step loop for every
+// product, `Math.divide` recurses about once per quotient bit. Only the cycle
+// figures decide against the call; ROM size is bounded by kMaxInlineWords.
+constexpr uint32_t kCallWords          { 49 };
+constexpr uint32_t kCallReturnCycles   { 100 };
+constexpr uint32_t kMultiplyBodyCycles { 1900 };
+constexpr uint32_t kDivideBodyCycles   { 2400 };
+
+VmOp push(Segment segment, uint32_t index) {
+  return { VmOp::Kind::Push, segment, index };
+}
+
+VmOp pop(Segment segment, uint32_t index) {
+  return { VmOp::Kind::Pop, segment, index };
+}
+
+VmOp arithmetic(Command command) {
+  return { VmOp::Kind::Arithmetic, Segment::Constant, 0, command };
+}
+
+bool isDirectSegment(Segment segment) {
+  return segment == Segment::Temp || segment == Segment::Pointer || segment == Segment::Static;
+}
+
+VmCost costOf(const VmOp& op) {
+  switch (op.kind) {
+    case VmOp::Kind::Push:
+      if (op.segment == Segment::Constant)
+        return op.index > kMaxPushConstant ? VmCost{ 10, 10 } : VmCost{ 7, 7 };
+      return isDirectSegment(op.segment) ? VmCost{ 7, 7 } : VmCost{ 10, 10 };
+    case VmOp::Kind::Pop:
+      return isDirectSegment(op.segment) ? VmCost{ 5, 5 } : VmCost{ 12, 12 };
+    case VmOp::Kind::Arithmetic:
+      switch (op.command) {
+        case Command::Neg:
+        case Command::Not:
+          return { 3, 3 };
+        case Command::Eq:
+        case Command::Gt:
+        case Command::Lt:
+          return { 12, 15 };
+        default:
+          return { 5, 5 };
+      }
+  }
+  return {};
+}
+
+/** @brief `x * factor` by doubling, most significant bit first. */
+VmSequence multiplyBy(uint16_t factor, const std::optional<VmOp>& reload) {
+  if (factor == 0)
+    return { push(Segment::Constant, 0), arithmetic(Command::And) };
+
+  int top { 15 };
+  while (!((factor >> top) & 1))
+    --top;
+
+  VmSequence ops;
+  const bool spill { (factor & (factor - 1)) != 0 && !reload };
+  if (spill) {
+    ops.push_back(pop(Segment::Temp, kSpillTemp));
+    ops.push_back(push(Segment::Temp, kSpillTemp));
+  }
+  const VmOp pushX { reload ? *reload : push(Segment::Temp, kSpillTemp) };
+
+  for (int bit { top - 1 }; bit >= 0; --bit) {
+    ops.push_back(pop(Segment::Temp, kScratchTemp));
+    ops.push_back(push(Segment::Temp, kScratchTemp));
+    ops.push_back(push(Segment::Temp, kScratchTemp));
+    ops.push_back(arithmetic(Command::Add));
+    if ((factor >> bit) & 1) {
+      ops.push_back(pushX);
+      ops.push_back(arithmetic(Command::Add));
+    }
+  }
+  return ops;
+}
+
+}
+
+VmCost estimateCost(const VmSequence& ops) {
+  VmCost total;
+  for (const VmOp& op : ops) {
+    const VmCost cost { costOf(op) };
+    total.cycles += cost.cycles;
+    total.words  += cost.words;
+  }
+  return total;
+}
+
+VmCost callCost(char op, uint16_t operand) {
+  const VmCost pushOperand { costOf(push(Segment::Constant, operand)) };
+  const uint32_t body { op == '*' ? kMultiplyBodyCycles : kDivideBodyCycles };
+  return { pushOperand.cycles + kCallWords + kCallReturnCycles + body, pushOperand.words + kCallWords };
+}
+
+VmSequence lowerMultiply(uint16_t factor, const std::optional<VmOp>& reload) {
+  VmSequence direct { multiplyBy(factor, reload) };
+  VmSequence negated { multiplyBy(static_cast<uint16_t>(-factor), reload) };
+  negated.push_back(arithmetic(Command::Neg));
+  return estimateCost(negated).score() < estimateCost(direct).score() ? negated : direct;
+}
+
+std::optional<VmSequence> lowerDivide(uint16_t divisor) {
+  if (divisor == 1)
+    return VmSequence{};
+  if (divisor == 0xFFFF)
+    return VmSequence{ arithmetic(Command::Neg) };
+  return std::nullopt;
+}
+
+std::optional<VmSequence> reduceStrength(char op, uint16_t constant, const std::optional<VmOp>& reload) {
+  std::optional<VmSequence> ops;
+  if (op == '*')
+    ops = lowerMultiply(constant, reload);
+  else if (op == '/')
+    ops = lowerDivide(constant);
+
+  if (!ops)
+    return std::nullopt;
+  const VmCost inlined { estimateCost(*ops) };
+  if (inlined.cycles >= callCost(op, constant).cycles || inlined.words > kMaxInlineWords)
+    return std::nullopt;
+  return ops;
+}
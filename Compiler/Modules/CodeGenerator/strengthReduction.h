@@ -0,0 +1,86 @@
+/** @file
+ *  @brief Inline replacements for `Math.multiply` / `Math.divide` calls with
+ *         a constant operand, and the cost model that decides when to use them.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "../Utils/command.h"
+#include "../Utils/segment.h"
+
+/**
+ * @brief One VM command of an inline sequence.
+ *
+ * `push constant` operands are 16-bit patterns; values above 32767 are
+ * emitted complemented followed by `not`, like folded negative literals.
+ */
+struct VmOp {
+  enum class Kind : uint8_t { Push, Pop, Arithmetic };
+
+  Kind kind {};
+  Segment segment {};
+  uint32_t index {};
+  Command command {};
+};
+
+using VmSequence = std::vector<VmOp>;
+
+/** @brief Estimated cost of VM code once translated to Hack. */
+struct VmCost {
+  uint32_t cycles {};  ///< Hack instructions executed.
+  uint32_t words {};   ///< ROM words occupied.
+
+  /** @brief Single figure to choose between two inline forms of the same operation. */
+  uint32_t score() const { return cycles + words; }
+};
+
+/**
+ * @brief Most ROM words an inline sequence may occupy, a little over two call
+ *        sites. Hack ROM holds 32K words, so code that saves cycles is still
+ *        rejected when it would take much more room than the call it replaces.
+ */
+constexpr uint32_t kMaxInlineWords { 128 };
+
+/** @brief Temp registers the sequences use; the code generator only otherwise uses `temp 0`. */
+constexpr uint32_t kSpillTemp   { 1 };
+constexpr uint32_t kScratchTemp { 2 };
+
+/** @brief Estimated cost of `ops`, summed from per-command Hack expansions. */
+VmCost estimateCost(const VmSequence& ops);
+
+/**
+ * @brief Estimated cost of `push constant <operand>; call Math.multiply 2`
+ *        (`op == '*'`) or `Math.divide` (`op == '/'`), including the OS routine.
+ */
+VmCost callCost(char op, uint16_t operand);
+
+/**
+ * @brief Sequence that replaces `x` on top of the stack by `x * factor`.
+ *
+ * Built from doubling with `add`, most significant bit first; the factor or
+ * its negation is used, whichever needs fewer commands.
+ *
+ * @param factor  16-bit pattern of the constant factor.
+ * @param reload  Command that pushes `x` again without side effects (a
+ *                variable); without it `x` is spilled to `temp 1` if needed.
+ */
+VmSequence lowerMultiply(uint16_t factor, const std::optional<VmOp>& reload);
+
+/**
+ * @brief Sequence that replaces `x` on top of the stack by `x / divisor`.
+ *
+ * The VM has no shifts, so a general power-of-two divide takes well over a
+ * hundred commands; only the divisors that need no arithmetic are lowered.
+ *
+ * @return Nothing (for `x`) or `neg` for `1` and `-1`; nothing otherwise.
+ */
+std::optional<VmSequence> lowerDivide(uint16_t divisor);
+
+/**
+ * @brief Lowered form of `x <op> constant`, or nothing when `op` has no
+ *        lowering for `constant`, the call runs faster, or the sequence would
+ *        take more than `kMaxInlineWords` of ROM.
+ */
+std::optional<VmSequence> reduceStrength(char op, uint16_t constant, const std::optional<VmOp>& reload);
@@ -1,4 +1,8 @@
 #include "compileEngine.h"
+#include "../AST/ast.h"
+#include "../CodeGenerator/codeGenerator.h"
+#include "../Optimizer/constantFolder.h"
+#include "../Optimizer/deadCode.h"
 #include "../Tokenizer/tokenizer.h"
 #include "../VMWriter/vmWriter.h"
 #include "../Utils/identifier.h"
@@ -7,12 +11,91 @@
 #include "../Utils/segment.h"
 #include "../Utils/command.h"
 #include "../Utils/log.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** @brief The words of each line of inline code; comments and blank lines are dropped. */
+std::vector<std::vector<std::string_view>> splitLines(std::string_view code) {
+  constexpr std::string_view kBlank { " \t\r\f\v" };
+  std::vector<std::vector<std::string_view>> lines;
+  while (!code.empty()) {
+    const std::size_t end { std::min(code.find('\n'), code.size()) };
+    std::string_view line { code.substr(0, end) };
+    code.remove_prefix(std::min(end + 1, code.size()));
+    line = line.substr(0, line.find("//"));
+
+    std::vector<std::string_view> words;
+    std::size_t start { line.find_first_not_of(kBlank) };
+    while (start != std::string_view::npos) {
+      const std::size_t stop { std::min(line.find_first_of(kBlank, start), line.size()) };
+      words.push_back(line.substr(start, stop - start));
+      start = line.find_first_not_of(kBlank, stop);
+    }
+    if (!words.empty())
+      lines.push_back(std::move(words));
+  }
+  return lines;
+}
+
+std::string joinWords(const std::vector<std::string_view>& words, std::string_view separator) {
+  std::string text;
+  for (std::string_view word : words)
+    text.append(text.empty() ? "" : separator).append(word);
+  return text;
+}
+
+bool parseNumber(std::string_view text, uint32_t& value) {
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return !text.empty() && error == std::errc() && end == text.data() + text.size();
+}
+
+/** @brief Whether `name` is a label or symbol both the VM and Hack assembly accept. */
+bool isSymbolName(std::string_view name) {
+  const auto isSymbolChar = [](char ch) {
+    return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '.' || ch == '$' || ch == ':';
+  };
+  return !name.empty() && !std::isdigit(static_cast<unsigned char>(name.front()))
+      && std::all_of(name.begin(), name.end(), isSymbolChar);
+}
 
-CompilationEngine::CompilationEngine(Tokenizer& tokenizer, VmWriter& vmWriter)
+/** @brief Whether `text` is a well-formed `dest=comp;jump` Hack instruction. */
+bool isComputeInstruction(std::string_view text) {
+  constexpr std::string_view kDests[] { "M", "D", "MD", "A", "AM", "AD", "AMD" };
+  constexpr std::string_view kJumps[] { "JGT", "JEQ", "JGE", "JLT", "JNE", "JLE", "JMP" };
+  const std::size_t assign { text.find('=') };
+  const std::size_t jump { text.find(';') };
+  const std::size_t compStart { assign == std::string_view::npos ? 0 : assign + 1 };
+  const std::string_view dest { text.substr(0, assign == std::string_view::npos ? 0 : assign) };
+  const std::string_view comp { text.substr(compStart, std::min(jump, text.size()) - compStart) };
+
+  if (assign != std::string_view::npos
+      && std::find(std::begin(kDests), std::end(kDests), dest) == std::end(kDests))
+    return false;
+  if (jump != std::string_view::npos
+      && std::find(std::begin(kJumps), std::end(kJumps), text.substr(jump + 1)) == std::end(kJumps))
+    return false;
+  return !comp.empty() && comp.find_first_not_of("01-+!&|ADM") == std::string_view::npos;
+}
+
+} // namespace
+
+CompilationEngine::CompilationEngine(Tokenizer& tokenizer, VmWriter& vmWriter, const CompilerOptions& options)
   : m_tokenizer(tokenizer)
   , m_VmWriter(vmWriter)
+  , m_options(options)
+  , m_subroutineTable(&m_classTable)
 {}
 
 void CompilationEngine::expectKeyword(Keyword kw) {
@@ -29,14 +112,23 @@ void CompilationEngine::expectSymbol(char ch) {
     m_tokenizer.advance();
 }
 
-std::string CompilationEngine::expectIdentifier() {
+std::string_view CompilationEngine::expectIdentifier() {
   if (m_tokenizer.tokenType() != Token::Identifier)
     log<std::runtime_error>("Expected identifier in CompilationEngine");
-  std::string name = m_tokenizer.identifier();
+  std::string_view name = m_tokenizer.getCurrentToken();
   m_tokenizer.advance();
   return name;
 }
 
+std::string_view CompilationEngine::expectType() {
+  if (!isPrimitiveType())
+    return expectIdentifier();
+
+  std::string_view type { m_tokenizer.getCurrentToken() };
+  m_tokenizer.advance();
+  return type;
+}
+
 bool CompilationEngine::isSymbol(char ch) const {
   return (m_tokenizer.tokenType() == Token::Symbol) && (m_tokenizer.symbol() == ch);
 }
@@ -45,6 +137,10 @@ bool CompilationEngine::isKeyword(Keyword kw) const {
   return (m_tokenizer.tokenType() == Token::Keyword) && (m_tokenizer.keyWord() == kw);
 }
 
+bool CompilationEngine::isPrimitiveType() const {
+  return isKeyword(Keyword::Int) || isKeyword(Keyword::Char) || isKeyword(Keyword::Boolean);
+}
+
 Segment CompilationEngine::kindToSegment(IdentifierKind kind) const {
   switch (kind) {
     case IdentifierKind::Static: return Segment::Static;
@@ -57,29 +153,42 @@ Segment CompilationEngine::kindToSegment(IdentifierKind kind) const {
   return Segment::Constant;
 }
 
-std::string CompilationEngine::makeLabel(const std::string& base, uint32_t index) const {
-  return m_className + "." + m_subroutineName + "$" + base + std::to_string(index);
+std::pair<Segment, uint32_t> CompilationEngine::resolveVariable(std::string_view name) const {
+  const Symbol* symbol = m_subroutineTable.resolve(name);
+  if (!symbol)
+    log<std::runtime_error>("Undefined identifier " + std::string(name));
+  return { kindToSegment(symbol->kind), symbol->idx };
 }
 
-void CompilationEngine::compileClass() {
+void CompilationEngine::compileClass(const std::set<std::string>* externalCalls) {
+  m_warnings.clear();
+  parseClass();
+  if (m_options.foldConstants)
+    foldConstants(m_ast);
+  if (m_options.deadCodeElimination)
+    m_warnings = eliminateDeadCode(m_ast, externalCalls).warnings;
+  CodeGenerator(m_VmWriter, m_options).generate(m_ast);
+}
+
+void CompilationEngine::parseClass() {
   expectKeyword(Keyword::Class);
 
+  m_ast.clear();
   m_classTable.reset();
   m_subroutineTable.reset();
+  m_inlineBlockIdx = 0;
   m_className = expectIdentifier();
+  m_ast.className = m_className;
 
   expectSymbol('{');
 
-  while (m_tokenizer.tokenType() == Token::Keyword &&
-         (m_tokenizer.keyWord() == Keyword::Static ||
-          m_tokenizer.keyWord() == Keyword::Field)) {
+  while (isKeyword(Keyword::Static) || isKeyword(Keyword::Field)) {
     compileClassVarDec();
   }
+  m_ast.fieldCount = m_classTable.varCount(IdentifierKind::Field);
+  m_ast.staticCount = m_classTable.varCount(IdentifierKind::Static);
 
-  while (m_tokenizer.tokenType() == Token::Keyword &&
-         (m_tokenizer.keyWord() == Keyword::Constructor ||
-          m_tokenizer.keyWord() == Keyword::Function ||
-          m_tokenizer.keyWord() == Keyword::Method)) {
+  while (isKeyword(Keyword::Constructor) || isKeyword(Keyword::Function) || isKeyword(Keyword::Method)) {
     compileSubroutine();
   }
 
@@ -94,18 +203,9 @@ void CompilationEngine::compileClassVarDec() {
   IdentifierKind kind = isStatic ? IdentifierKind::Static : IdentifierKind::Field;
   m_tokenizer.advance();
 
-  std::string type;
-  if (m_tokenizer.tokenType() == Token::Keyword &&
-      (m_tokenizer.keyWord() == Keyword::Int ||
-       m_tokenizer.keyWord() == Keyword::Char ||
-       m_tokenizer.keyWord() == Keyword::Boolean)) {
-    type = std::string(m_tokenizer.getCurrentToken());
-    m_tokenizer.advance();
-  } else {
-    type = expectIdentifier();
-  }
+  std::string_view type = expectType();
 
-  std::string name = expectIdentifier();
+  std::string_view name = expectIdentifier();
   m_classTable.define(name, type, kind);
 
   while (isSymbol(',')) {
@@ -118,67 +218,57 @@ void CompilationEngine::compileClassVarDec() {
 }
 
 void CompilationEngine::compileSubroutine() {
-  m_isMethod = false;
-  m_isConstructor = false;
+  Subroutine subroutine { SubroutineKind::Function, {}, {}, {} };
 
   if (isKeyword(Keyword::Constructor))
-    m_isConstructor = true;
+    subroutine.kind = SubroutineKind::Constructor;
   else if (isKeyword(Keyword::Method))
-    m_isMethod = true;
+    subroutine.kind = SubroutineKind::Method;
   else if (!isKeyword(Keyword::Function))
     log<std::runtime_error>("Expected subroutine keyword");
 
   m_tokenizer.advance();
 
-  if (m_tokenizer.tokenType() == Token::Keyword &&
-      (m_tokenizer.keyWord() == Keyword::Void ||
-       m_tokenizer.keyWord() == Keyword::Int  ||
-       m_tokenizer.keyWord() == Keyword::Char ||
-       m_tokenizer.keyWord() == Keyword::Boolean)
-      )
+  if (isKeyword(Keyword::Void) || isPrimitiveType()) {
+    subroutine.returnType = std::string(m_tokenizer.getCurrentToken());
     m_tokenizer.advance();
-  else
-    expectIdentifier();
+  } else {
+    subroutine.returnType = expectIdentifier();
+  }
 
-  m_subroutineName = expectIdentifier();
+  subroutine.name = expectIdentifier();
+  m_subroutineName = subroutine.name;
 
   m_subroutineTable.reset();
-  if (m_isMethod)
+  if (subroutine.kind == SubroutineKind::Method)
     m_subroutineTable.define("this", m_className, IdentifierKind::Arg);
 
   expectSymbol('(');
-  compileParameterList();
+  compileParameterList(subroutine);
   expectSymbol(')');
 
-  compileSubroutineBody();
-}
+  expectSymbol('{');
+  while (isKeyword(Keyword::Var)) {
+    compileVarDec();
+  }
+  subroutine.nLocals = m_subroutineTable.varCount(IdentifierKind::Var);
 
-void CompilationEngine::compileParameterList() {
-  if (m_tokenizer.tokenType() != Token::Keyword &&
-      m_tokenizer.tokenType() != Token::Identifier)
-    return;
+  subroutine.body = compileStatements();
+  expectSymbol('}');
+
+  m_ast.subroutines.push_back(std::move(subroutine));
+}
 
-  if (!(m_tokenizer.tokenType() == Token::Keyword &&
-        (m_tokenizer.keyWord() == Keyword::Int ||
-         m_tokenizer.keyWord() == Keyword::Char ||
-         m_tokenizer.keyWord() == Keyword::Boolean)) &&
-      m_tokenizer.tokenType() != Token::Identifier)
+void CompilationEngine::compileParameterList(Subroutine& subroutine) {
+  if (!isPrimitiveType() && m_tokenizer.tokenType() != Token::Identifier)
     return;
 
   while (true) {
-    std::string type;
-    if (m_tokenizer.tokenType() == Token::Keyword &&
-        (m_tokenizer.keyWord() == Keyword::Int ||
-         m_tokenizer.keyWord() == Keyword::Char ||
-         m_tokenizer.keyWord() == Keyword::Boolean)) {
-      type = std::string(m_tokenizer.getCurrentToken());
-      m_tokenizer.advance();
-    } else {
-      type = expectIdentifier();
-    }
+    std::string_view type = expectType();
 
-    std::string name = expectIdentifier();
+    std::string_view name = expectIdentifier();
     m_subroutineTable.define(name, type, IdentifierKind::Arg);
+    subroutine.parameterTypes.emplace_back(type);
 
     if (!isSymbol(','))
       break;
@@ -186,46 +276,12 @@ void CompilationEngine::compileParameterList() {
   }
 }
 
-void CompilationEngine::compileSubroutineBody() {
-  expectSymbol('{');
-
-  while (isKeyword(Keyword::Var)) {
-    compileVarDec();
-  }
-
-  uint32_t nLocals = m_subroutineTable.varCount(IdentifierKind::Var);
-  std::string fullName = m_className + "." + m_subroutineName;
-  m_VmWriter.writeFunction(fullName, nLocals);
-
-  if (m_isConstructor) {
-    uint32_t nFields = m_classTable.varCount(IdentifierKind::Field);
-    m_VmWriter.writePush(Segment::Constant, nFields);
-    m_VmWriter.writeCall("Memory.alloc", 1);
-    m_VmWriter.writePop(Segment::Pointer, 0);
-  } else if (m_isMethod) {
-    m_VmWriter.writePush(Segment::Argument, 0);
-    m_VmWriter.writePop(Segment::Pointer, 0);
-  }
-
-  compileStatements();
-  expectSymbol('}');
-}
-
 void CompilationEngine::compileVarDec() {
   expectKeyword(Keyword::Var);
 
-  std::string type;
-  if (m_tokenizer.tokenType() == Token::Keyword &&
-      (m_tokenizer.keyWord() == Keyword::Int ||
-       m_tokenizer.keyWord() == Keyword::Char ||
-       m_tokenizer.keyWord() == Keyword::Boolean)) {
-    type = std::string(m_tokenizer.getCurrentToken());
-    m_tokenizer.advance();
-  } else {
-    type = expectIdentifier();
-  }
+  std::string_view type = expectType();
 
-  std::string name = expectIdentifier();
+  std::string_view name = expectIdentifier();
   m_subroutineTable.define(name, type, IdentifierKind::Var);
 
   while (isSymbol(',')) {
@@ -237,176 +293,246 @@ void CompilationEngine::compileVarDec() {
   expectSymbol(';');
 }
 
-void CompilationEngine::compileStatements() {
-  while (m_tokenizer.tokenType() == Token::Keyword) {
+NodeList CompilationEngine::compileStatements() {
+  const std::size_t first { m_scratch.size() };
+
+  while (m_tokenizer.tokenType() == Token::Keyword || isInlineBlock()) {
+    NodeId statement;
+    if (isInlineBlock()) {
+      statement = compileInline();
+      m_scratch.push_back(statement);
+      continue;
+    }
     switch (m_tokenizer.keyWord()) {
-      case Keyword::Let:    compileLet();    break;
-      case Keyword::If:     compileIf();     break;
-      case Keyword::While:  compileWhile();  break;
-      case Keyword::Do:     compileDo();     break;
-      case Keyword::Return: compileReturn(); break;
-      default: return;
+      case Keyword::Let:    statement = compileLet();    break;
+      case Keyword::If:     statement = compileIf();     break;
+      case Keyword::While:  statement = compileWhile();  break;
+      case Keyword::Do:     statement = compileDo();     break;
+      case Keyword::Return: statement = compileReturn(); break;
+      default: return m_ast.addList(m_scratch, first);
     }
+    m_scratch.push_back(statement);
   }
+  return m_ast.addList(m_scratch, first);
 }
 
-void CompilationEngine::compileLet() {
+NodeId CompilationEngine::compileLet() {
   expectKeyword(Keyword::Let);
 
-  std::string varName = expectIdentifier();
-  IdentifierKind kind = m_subroutineTable.kindOf(varName);
-  uint32_t idx;
-  if (kind != IdentifierKind::None) {
-    idx = m_subroutineTable.indexOf(varName);
-  } else {
-    kind = m_classTable.kindOf(varName);
-    idx = m_classTable.indexOf(varName);
-  }
-  Segment seg = kindToSegment(kind);
+  Stmt let { StmtKind::Let };
+  std::tie(let.segment, let.index) = resolveVariable(expectIdentifier());
 
-  bool isArray { false };
   if (isSymbol('[')) {
-    isArray = true;
     m_tokenizer.advance();
-
-    m_VmWriter.writePush(seg, idx);
-    compileExpression();
+    let.subscript = compileExpression();
     expectSymbol(']');
-    m_VmWriter.writeArithmetic(Command::Add);
   }
 
   expectSymbol('=');
-  compileExpression();
+  let.expr = compileExpression();
   expectSymbol(';');
 
-  if (isArray) {
-    m_VmWriter.writePop(Segment::Temp, 0);
-    m_VmWriter.writePop(Segment::Pointer, 1);
-    m_VmWriter.writePush(Segment::Temp, 0);
-    m_VmWriter.writePop(Segment::That, 0);
-  } else {
-    m_VmWriter.writePop(seg, idx);
-  }
+  return m_ast.addStmt(let);
 }
 
-void CompilationEngine::compileIf() {
-  uint32_t idx { m_ifLabelIdx++ };
-  std::string labelTrue  = makeLabel("IF_TRUE", idx);
-  std::string labelFalse = makeLabel("IF_FALSE", idx);
-  std::string labelEnd   = makeLabel("IF_END", idx);
+NodeId CompilationEngine::compileIf() {
+  Stmt branch { StmtKind::If };
 
   expectKeyword(Keyword::If);
   expectSymbol('(');
-  compileExpression();
+  branch.expr = compileExpression();
   expectSymbol(')');
 
-  m_VmWriter.writeIf(labelTrue);
-  m_VmWriter.writeGoto(labelFalse);
-  m_VmWriter.writeLabel(labelTrue);
-
   expectSymbol('{');
-  compileStatements();
+  branch.body = compileStatements();
   expectSymbol('}');
 
   if (isKeyword(Keyword::Else)) {
-    m_VmWriter.writeGoto(labelEnd);
-    m_VmWriter.writeLabel(labelFalse);
-
+    branch.hasElse = true;
     m_tokenizer.advance();
     expectSymbol('{');
-    compileStatements();
+    branch.orElse = compileStatements();
     expectSymbol('}');
-
-    m_VmWriter.writeLabel(labelEnd);
-  } else {
-    m_VmWriter.writeLabel(labelFalse);
   }
-}
 
-void CompilationEngine::compileWhile() {
-  uint32_t idx = m_whileLabelIdx++;
-  std::string labelExp = makeLabel("WHILE_EXP", idx);
-  std::string labelEnd = makeLabel("WHILE_END", idx);
+  return m_ast.addStmt(branch);
+}
 
-  m_VmWriter.writeLabel(labelExp);
+NodeId CompilationEngine::compileWhile() {
+  Stmt loop { StmtKind::While };
 
   expectKeyword(Keyword::While);
   expectSymbol('(');
-  compileExpression();
+  loop.expr = compileExpression();
   expectSymbol(')');
 
-  m_VmWriter.writeArithmetic(Command::Not);
-  m_VmWriter.writeIf(labelEnd);
-
   expectSymbol('{');
-  compileStatements();
+  loop.body = compileStatements();
   expectSymbol('}');
 
-  m_VmWriter.writeGoto(labelExp);
-  m_VmWriter.writeLabel(labelEnd);
+  return m_ast.addStmt(loop);
 }
 
-void CompilationEngine::compileDo() {
+NodeId CompilationEngine::compileDo() {
   expectKeyword(Keyword::Do);
 
-  std::string name = expectIdentifier();
+  Stmt call { StmtKind::Do };
+  call.expr = compileCall(expectIdentifier());
+  expectSymbol(';');
 
-  uint32_t nArgs = 0;
-  std::string callName;
+  return m_ast.addStmt(call);
+}
 
-  if (isSymbol('.')) {
-    m_tokenizer.advance();
-    std::string subName = expectIdentifier();
-
-    IdentifierKind kind = m_subroutineTable.kindOf(name);
-    if (kind == IdentifierKind::None)
-      kind = m_classTable.kindOf(name);
-
-    if (kind != IdentifierKind::None) {
-      Segment seg = kindToSegment(kind);
-      uint32_t idx = (m_subroutineTable.kindOf(name) != IdentifierKind::None)
-                       ? m_subroutineTable.indexOf(name)
-                       : m_classTable.indexOf(name);
-      m_VmWriter.writePush(seg, idx);
-      std::string type = (m_subroutineTable.kindOf(name) != IdentifierKind::None)
-                           ? m_subroutineTable.typeOf(name)
-                           : m_classTable.typeOf(name);
-      callName = type + "." + subName;
-      nArgs = 1;
-    } else {
-      callName = name + "." + subName;
-    }
-  } else {
-    callName = m_className + "." + name;
-    m_VmWriter.writePush(Segment::Pointer, 0);
-    nArgs = 1;
-  }
+NodeId CompilationEngine::compileReturn() {
+  expectKeyword(Keyword::Return);
 
-  expectSymbol('(');
-  nArgs += compileExpressionList();
-  expectSymbol(')');
+  Stmt ret { StmtKind::Return };
+  if (!isSymbol(';'))
+    ret.expr = compileExpression();
 
-  m_VmWriter.writeCall(callName, nArgs);
   expectSymbol(';');
+  return m_ast.addStmt(ret);
+}
 
-  m_VmWriter.writePop(Segment::Temp, 0);
+bool CompilationEngine::isInlineBlock() const {
+  if (m_tokenizer.tokenType() != Token::Identifier || !m_tokenizer.hasMoreTokens())
+    return false;
+  const std::string_view word { m_tokenizer.getCurrentToken() };
+  return (word == "vm" || word == "asm") && m_tokenizer.getNextToken() == "{";
 }
 
-void CompilationEngine::compileReturn() {
-  expectKeyword(Keyword::Return);
+NodeId CompilationEngine::compileInline() {
+  const bool isVm { m_tokenizer.getCurrentToken() == "vm" };
+  m_tokenizer.advance();
+  const std::string_view code { m_tokenizer.rawBlock() };
+  expectSymbol('}');
 
-  if (!isSymbol(';')) {
-    compileExpression();
-  } else {
-    m_VmWriter.writePush(Segment::Constant, 0);
+  const std::string scope { m_className + "." + m_subroutineName + (isVm ? "$VM" : "$ASM")
+                            + std::to_string(m_inlineBlockIdx++) + "." };
+  Stmt block { isVm ? StmtKind::Vm : StmtKind::Asm };
+  block.index = m_ast.addString(isVm ? resolveVmCode(code, scope) : resolveAsmCode(code, scope));
+  return m_ast.addStmt(block);
+}
+
+std::string CompilationEngine::resolveVmCode(std::string_view code, const std::string& scope) const {
+  const auto lines { splitLines(code) };
+  std::set<std::string_view> labels;
+  for (const auto& words : lines) {
+    if (words[0] != "label" || words.size() != 2)
+      continue;
+    if (!isSymbolName(words[1]))
+      log<std::runtime_error>("Invalid label name " + std::string(words[1]) + " in vm block");
+    if (!labels.insert(words[1]).second)
+      log<std::runtime_error>("Duplicate label " + std::string(words[1]) + " in vm block");
   }
 
-  expectSymbol(';');
-  m_VmWriter.writeReturn();
+  // Stack depth is tracked in program order: enough for the straight-line
+  // and loop shapes these blocks are meant for.
+  std::string resolved;
+  std::size_t depth {};
+  for (const auto& words : lines) {
+    const std::string_view op { words[0] };
+    const std::string line { joinWords(words, " ") };
+    std::size_t pops {};
+    std::size_t pushes {};
+    uint32_t count {};
+
+    if ((op == "push" || op == "pop") && (words.size() == 2 || words.size() == 3)) {
+      Segment segment {};
+      uint32_t idx {};
+      if (words.size() == 2) {
+        std::tie(segment, idx) = resolveVariable(words[1]);
+      } else {
+        const auto named { segmentNamed(words[1]) };
+        if (!named || !parseNumber(words[2], idx) || (op == "pop" && named == Segment::Constant))
+          log<std::runtime_error>("Invalid vm command " + line);
+        segment = *named;
+      }
+      resolved.append(op).append(" ").append(kSegmentNames[static_cast<std::size_t>(segment)])
+              .append(" " + std::to_string(idx) + "\n");
+      (op == "push" ? pushes : pops) = 1;
+    } else if (const auto command { commandNamed(op) }; command && words.size() == 1) {
+      resolved += line + "\n";
+      pops = (command == Command::Neg || command == Command::Not) ? 1 : 2;
+      pushes = 1;
+    } else if ((op == "label" || op == "goto" || op == "if-goto") && words.size() == 2) {
+      if (!labels.count(words[1]))
+        log<std::runtime_error>("Undefined label " + std::string(words[1]) + " in vm block");
+      resolved.append(op).append(" " + scope).append(words[1]).append("\n");
+      pops = (op == "if-goto");
+    } else if ((op == "call" || op == "call-void") && words.size() == 3
+               && isSymbolName(words[1]) && parseNumber(words[2], count)) {
+      resolved += line + "\n";
+      pops = count;
+      pushes = (op == "call");
+    } else if ((op == "return" || op == "return-void") && words.size() == 1) {
+      resolved += line + "\n";
+      pops = (op == "return");
+    } else {
+      log<std::runtime_error>("Invalid vm command " + line);
+    }
+
+    if (depth < pops)
+      log<std::runtime_error>("vm block pops more than it pushed at " + line);
+    depth += pushes - pops;
+  }
+  if (depth != 0)
+    log<std::runtime_error>("vm block in " + scope.substr(0, scope.find('$')) + " leaves values on the stack");
+  return resolved;
 }
 
-void CompilationEngine::compileExpression() {
-  compileTerm();
+std::string CompilationEngine::resolveAsmCode(std::string_view code, const std::string& scope) const {
+  // Hack assembly ignores spaces, so each line is one instruction once its words are joined.
+  std::vector<std::string> instructions;
+  for (const auto& words : splitLines(code))
+    instructions.push_back(joinWords(words, ""));
+
+  std::set<std::string_view> labels;
+  for (std::string_view text : instructions) {
+    if (text.front() != '(')
+      continue;
+    if (text.back() != ')' || !isSymbolName(text.substr(1, text.size() - 2)))
+      log<std::runtime_error>("Invalid label " + std::string(text) + " in asm block");
+    if (!labels.insert(text.substr(1, text.size() - 2)).second)
+      log<std::runtime_error>("Duplicate label " + std::string(text) + " in asm block");
+  }
+
+  std::string resolved;
+  for (const std::string& text : instructions) {
+    const std::string_view operand { std::string_view(text).substr(1) };
+    uint32_t value {};
+
+    if (text.front() == '(') {
+      resolved += "(" + scope + std::string(operand.substr(0, operand.size() - 1)) + ")\n";
+    } else if (text.front() == '@' && parseNumber(operand, value)) {
+      if (value > 0x7FFF)
+        log<std::runtime_error>("Constant out of range in asm block: " + text);
+      resolved += text + "\n";
+    } else if (text.front() == '@') {
+      if (!isSymbolName(operand))
+        log<std::runtime_error>("Invalid asm instruction " + text);
+      const Symbol* symbol { m_subroutineTable.resolve(operand) };
+      if (labels.count(operand)) {
+        resolved += "@" + scope + std::string(operand) + "\n";
+      } else if (symbol && symbol->kind != IdentifierKind::Static) {
+        log<std::runtime_error>("Only static variables have an address in an asm block; "
+                                "move " + std::string(operand) + " through a vm block");
+      } else if (symbol) {
+        resolved += "@" + m_className + "." + std::to_string(symbol->idx) + "\n";
+      } else {
+        resolved += text + "\n";
+      }
+    } else if (isComputeInstruction(text)) {
+      resolved += text + "\n";
+    } else {
+      log<std::runtime_error>("Invalid asm instruction " + text);
+    }
+  }
+  return resolved;
+}
+
+NodeId CompilationEngine::compileExpression() {
+  NodeId lhs = compileTerm();
 
   while (m_tokenizer.tokenType() == Token::Symbol) {
     char op = m_tokenizer.symbol();
@@ -416,162 +542,133 @@ void CompilationEngine::compileExpression() {
     }
     m_tokenizer.advance();
 
-    compileTerm();
-
-    switch (op) {
-      case '+': m_VmWriter.writeArithmetic(Command::Add); break;
-      case '-': m_VmWriter.writeArithmetic(Command::Sub); break;
-      case '&': m_VmWriter.writeArithmetic(Command::And); break;
-      case '|': m_VmWriter.writeArithmetic(Command::Or);  break;
-      case '<': m_VmWriter.writeArithmetic(Command::Lt);  break;
-      case '>': m_VmWriter.writeArithmetic(Command::Gt);  break;
-      case '=': m_VmWriter.writeArithmetic(Command::Eq);  break;
-      case '*':
-        m_VmWriter.writeCall("Math.multiply", 2);
-        break;
-      case '/':
-        m_VmWriter.writeCall("Math.divide", 2);
-        break;
-    }
+    Expr binary { ExprKind::Binary };
+    binary.op  = op;
+    binary.lhs = lhs;
+    binary.rhs = compileTerm();
+    lhs = m_ast.addExpr(binary);
   }
+  return lhs;
 }
 
-void CompilationEngine::compileTerm() {
+NodeId CompilationEngine::compileTerm() {
   Token tt = m_tokenizer.tokenType();
 
   if (tt == Token::IntConst) {
-    uint32_t val = m_tokenizer.intVal();
-    m_VmWriter.writePush(Segment::Constant, val);
+    Expr constant { ExprKind::IntConst };
+    constant.value = m_tokenizer.intVal();
     m_tokenizer.advance();
-  } else if (tt == Token::StringConst) {
-    std::string s = m_tokenizer.stringVal();
-    m_VmWriter.writePush(Segment::Constant, static_cast<uint32_t>(s.size()));
-    m_VmWriter.writeCall("String.new", 1);
-    for (char c : s) {
-      m_VmWriter.writePush(Segment::Constant, static_cast<uint32_t>(static_cast<unsigned char>(c)));
-      m_VmWriter.writeCall("String.appendChar", 2);
-    }
+    return m_ast.addExpr(constant);
+  }
+
+  if (tt == Token::StringConst) {
+    Expr constant { ExprKind::StringConst };
+    constant.value = m_ast.addString(m_tokenizer.getCurrentToken());
     m_tokenizer.advance();
-  } else if (tt == Token::Keyword) {
+    return m_ast.addExpr(constant);
+  }
+
+  if (tt == Token::Keyword) {
     Keyword kw = m_tokenizer.keyWord();
-    switch (kw) {
-      case Keyword::True:
-        m_VmWriter.writePush(Segment::Constant, 0);
-        m_VmWriter.writeArithmetic(Command::Not);
-        break;
-      case Keyword::False:
-      case Keyword::Null:
-        m_VmWriter.writePush(Segment::Constant, 0);
-        break;
-      case Keyword::This:
-        m_VmWriter.writePush(Segment::Pointer, 0);
-        break;
-      default:
-        log<std::runtime_error>("Invalid keyword term");
-    }
+    if (kw != Keyword::True && kw != Keyword::False && kw != Keyword::Null && kw != Keyword::This)
+      log<std::runtime_error>("Invalid keyword term");
+
+    Expr constant { ExprKind::KeywordConst };
+    constant.keyword = kw;
     m_tokenizer.advance();
-  } else if (tt == Token::Symbol && isSymbol('(')) {
+    return m_ast.addExpr(constant);
+  }
+
+  if (isSymbol('(')) {
     m_tokenizer.advance();
-    compileExpression();
+    NodeId inner = compileExpression();
     expectSymbol(')');
-  } else if (tt == Token::Symbol &&
-             (m_tokenizer.symbol() == '-' || m_tokenizer.symbol() == '~')) {
-    char op = m_tokenizer.symbol();
+    return inner;
+  }
+
+  if (isSymbol('-') || isSymbol('~')) {
+    Expr unary { ExprKind::Unary };
+    unary.op = m_tokenizer.symbol();
     m_tokenizer.advance();
-    compileTerm();
-    if (op == '-')      m_VmWriter.writeArithmetic(Command::Neg);
-    else                m_VmWriter.writeArithmetic(Command::Not);
-  } else if (tt == Token::Identifier) {
-    std::string name = m_tokenizer.identifier();
+    unary.lhs = compileTerm();
+    return m_ast.addExpr(unary);
+  }
+
+  if (tt != Token::Identifier)
+    log<std::runtime_error>("Invalid term");
+
+  std::string_view name = m_tokenizer.getCurrentToken();
+  m_tokenizer.advance();
+
+  if (isSymbol('[')) {
     m_tokenizer.advance();
 
-    if (isSymbol('[')) {
-      m_tokenizer.advance();
+    Expr element { ExprKind::ArrayElem };
+    std::tie(element.segment, element.index) = resolveVariable(name);
+    element.lhs = compileExpression();
+    expectSymbol(']');
+    return m_ast.addExpr(element);
+  }
 
-      IdentifierKind kind = m_subroutineTable.kindOf(name);
-      uint32_t idx;
-      if (kind != IdentifierKind::None) {
-        idx = m_subroutineTable.indexOf(name);
-      } else {
-        kind = m_classTable.kindOf(name);
-        idx = m_classTable.indexOf(name);
-      }
-      Segment seg = kindToSegment(kind);
-
-      m_VmWriter.writePush(seg, idx);
-      compileExpression();
-      expectSymbol(']');
-      m_VmWriter.writeArithmetic(Command::Add);
-      m_VmWriter.writePop(Segment::Pointer, 1);
-      m_VmWriter.writePush(Segment::That, 0);
-    } else if (isSymbol('(') || isSymbol('.')) {
-      uint32_t nArgs = 0;
-      std::string callName;
-
-      if (isSymbol('.')) {
-        m_tokenizer.advance();
-        std::string subName = expectIdentifier();
-
-        IdentifierKind kind = m_subroutineTable.kindOf(name);
-        if (kind == IdentifierKind::None)
-          kind = m_classTable.kindOf(name);
-
-        if (kind != IdentifierKind::None) {
-          Segment seg = kindToSegment(kind);
-          uint32_t idx = (m_subroutineTable.kindOf(name) != IdentifierKind::None)
-                           ? m_subroutineTable.indexOf(name)
-                           : m_classTable.indexOf(name);
-          m_VmWriter.writePush(seg, idx);
-          std::string type = (m_subroutineTable.kindOf(name) != IdentifierKind::None)
-                               ? m_subroutineTable.typeOf(name)
-                               : m_classTable.typeOf(name);
-          callName = type + "." + subName;
-          nArgs = 1;
-        } else {
-          callName = name + "." + subName;
-        }
-      } else {
-        callName = m_className + "." + name;
-        m_VmWriter.writePush(Segment::Pointer, 0);
-        nArgs = 1;
-      }
+  if (isSymbol('(') || isSymbol('.'))
+    return compileCall(name);
+
+  Expr variable { ExprKind::Var };
+  std::tie(variable.segment, variable.index) = resolveVariable(name);
+  return m_ast.addExpr(variable);
+}
+
+NodeId CompilationEngine::compileCall(std::string_view name) {
+  Expr call { ExprKind::Call };
+  std::string callName;
+
+  if (isSymbol('.')) {
+    m_tokenizer.advance();
+    std::string_view subName = expectIdentifier();
 
-      expectSymbol('(');
-      nArgs += compileExpressionList();
-      expectSymbol(')');
-      m_VmWriter.writeCall(callName, nArgs);
+    if (const Symbol* receiver = m_subroutineTable.resolve(name)) {
+      call.hasReceiver = true;
+      call.segment = kindToSegment(receiver->kind);
+      call.index = receiver->idx;
+      callName = receiver->type;
     } else {
-      IdentifierKind kind = m_subroutineTable.kindOf(name);
-      uint32_t idx;
-      if (kind != IdentifierKind::None) {
-        idx = m_subroutineTable.indexOf(name);
-      } else {
-        kind = m_classTable.kindOf(name);
-        idx = m_classTable.indexOf(name);
-      }
-      Segment seg = kindToSegment(kind);
-      m_VmWriter.writePush(seg, idx);
+      callName = name;
     }
+    callName += '.';
+    callName += subName;
   } else {
-    log<std::runtime_error>("Invalid term");
+    callName = m_className;
+    callName += '.';
+    callName += name;
+    call.hasReceiver = true;
+    call.segment = Segment::Pointer;
+    call.index = 0;
   }
+  call.value = m_ast.addString(callName);
+
+  expectSymbol('(');
+  call.args = compileExpressionList();
+  expectSymbol(')');
+
+  return m_ast.addExpr(call);
 }
 
-uint32_t CompilationEngine::compileExpressionList() {
-  uint32_t count{};
+NodeList CompilationEngine::compileExpressionList() {
+  const std::size_t first { m_scratch.size() };
 
-  if (m_tokenizer.tokenType() == Token::Symbol && m_tokenizer.symbol() == ')')
-    return 0;
+  if (isSymbol(')'))
+    return m_ast.addList(m_scratch, first);
 
-  compileExpression();
-  ++count;
+  // The scratch stack is shared with nested lists, so push each id only once
+  // the expression (and any lists inside it) has been fully parsed.
+  NodeId argument = compileExpression();
+  m_scratch.push_back(argument);
 
   while (isSymbol(',')) {
     m_tokenizer.advance();
-    compileExpression();
-    ++count;
+    argument = compileExpression();
+    m_scratch.push_back(argument);
   }
 
-  return count;
+  return m_ast.addList(m_scratch, first);
 }
-
@@ -5,27 +5,40 @@
 #pragma once
 
 #include <cstdint>
+#include <set>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../AST/ast.h"
 #include "../Tokenizer/tokenizer.h"
 #include "../VMWriter/vmWriter.h"
 #include "../SymbolTable/symbolTable.h"
+#include "../Utils/compilerOptions.h"
 
 /**
- * @brief Recursive-descent compiler that consumes tokens from a `Tokenizer`
- *        and emits the corresponding Nand2Tetris VM code via `VmWriter`.
+ * @brief Recursive-descent parser that consumes tokens from a `Tokenizer`,
+ *        builds the class `Ast` and hands it to a `CodeGenerator`, which
+ *        emits the corresponding Nand2Tetris VM code via `VmWriter`.
+ *
+ * Identifiers are resolved against the symbol tables while parsing, so the
+ * tree only holds segments, indices and full call names.
  */
 class CompilationEngine {
   private:
     Tokenizer& m_tokenizer;
     VmWriter& m_VmWriter;
+    CompilerOptions m_options;
     SymbolTable m_classTable;
     SymbolTable m_subroutineTable;
     std::string m_className;
     std::string m_subroutineName;
-    bool m_isMethod{false};
-    bool m_isConstructor{false};
-    uint32_t m_ifLabelIdx{0};
-    uint32_t m_whileLabelIdx{0};
+    /** @brief Inline blocks parsed in this class; numbers each block's label scope. */
+    uint32_t m_inlineBlockIdx{};
+    Ast m_ast;
+    /** @brief Shared stack of child ids for the blocks and argument lists being parsed. */
+    std::vector<NodeId> m_scratch;
+    std::vector<std::string> m_warnings;
 
     /** @brief Consume and validate that the current token is the given keyword. */
     void expectKeyword(Keyword kw);
@@ -33,8 +46,11 @@ class CompilationEngine {
     /** @brief Consume and validate that the current token is the given symbol. */
     void expectSymbol(char ch);
 
-    /** @brief Consume and return the current identifier token text. */
-    std::string expectIdentifier();
+    /** @brief Consume and return the current identifier token text (a view into the source). */
+    std::string_view expectIdentifier();
+
+    /** @brief Consume a type: `int`, `char`, `boolean` or a class name. */
+    std::string_view expectType();
 
     /** @brief Check whether the current token is the given symbol. */
     bool isSymbol(char ch) const;
@@ -42,63 +58,107 @@ class CompilationEngine {
     /** @brief Check whether the current token is the given keyword. */
     bool isKeyword(Keyword kw) const;
 
+    /** @brief Check whether the current token is `int`, `char` or `boolean`. */
+    bool isPrimitiveType() const;
+
     /** @brief Map a symbol-table kind to its corresponding VM memory segment. */
     Segment kindToSegment(IdentifierKind kind) const;
 
-    /** @brief Build a function-scoped label name of the form `Class.sub$baseN`. */
-    std::string makeLabel(const std::string& base, uint32_t index) const;
-    
-  public:
-    /** @brief Construct a compilation engine bound to a tokenizer and output stream. */
-    CompilationEngine(Tokenizer& tokenizer, VmWriter& vmWriter);
-    CompilationEngine operator=(CompilationEngine&) = delete;
-    CompilationEngine(CompilationEngine&) = delete;
-
-    /** @brief Compile an entire class starting at the `class` keyword. */
-    void compileClass();
+    /**
+     * @brief Look up a variable in the subroutine scope, then the class scope.
+     * @return Its segment and index.
+     */
+    std::pair<Segment, uint32_t> resolveVariable(std::string_view name) const;
 
-    /** @brief Compile a class-level variable declaration (`static` / `field`). */
+    /** @brief Parse a class-level variable declaration (`static` / `field`). */
     void compileClassVarDec();
 
-    /** @brief Compile a subroutine declaration (`constructor`, `function`, `method`). */
+    /** @brief Parse a subroutine declaration (`constructor`, `function`, `method`). */
     void compileSubroutine();
 
-    /** @brief Compile a (possibly empty) comma-separated parameter list. */
-    void compileParameterList();
+    /** @brief Parse a (possibly empty) comma-separated parameter list, recording the types in `subroutine`. */
+    void compileParameterList(Subroutine& subroutine);
 
-    /** @brief Compile the body of a subroutine, including local vars and statements. */
-    void compileSubroutineBody();
-
-    /** @brief Compile a local variable declaration (`var`). */
+    /** @brief Parse a local variable declaration (`var`). */
     void compileVarDec();
 
-    /** @brief Compile a sequence of statements until a closing delimiter is reached. */
-    void compileStatements();
+    /** @brief Parse a sequence of statements until a closing delimiter is reached. */
+    NodeList compileStatements();
+
+    /** @brief Parse a `let` assignment statement (with optional array indexing). */
+    NodeId compileLet();
 
-    /** @brief Compile a `let` assignment statement (with optional array indexing). */
-    void compileLet();
+    /** @brief Parse an `if` statement, including optional `else` branch. */
+    NodeId compileIf();
 
-    /** @brief Compile an `if` statement, including optional `else` branch. */
-    void compileIf();
+    /** @brief Parse a `while` loop statement. */
+    NodeId compileWhile();
 
-    /** @brief Compile a `while` loop statement. */
-    void compileWhile();
+    /** @brief Parse a `do` statement (a subroutine call as a statement). */
+    NodeId compileDo();
 
-    /** @brief Compile a `do` statement (a subroutine call as a statement). */
-    void compileDo();
+    /** @brief Parse a `return` statement, with or without an expression. */
+    NodeId compileReturn();
 
-    /** @brief Compile a `return` statement, with or without an expression. */
-    void compileReturn();
+    /** @brief Check whether the current token starts a `vm { ... }` or `asm { ... }` block. */
+    bool isInlineBlock() const;
+
+    /**
+     * @brief Parse a `vm` or `asm` block, whose code is passed through to the output.
+     *
+     * A `vm` block holds VM commands, one per line. `push name` and `pop name`
+     * access a Jack variable, and labels are local to the block. The block
+     * must leave the stack as it found it and may not declare functions.
+     *
+     * An `asm` block holds Hack instructions, one per line, each emitted as
+     * an `asm` VM command. Its labels are local to the block and `@name`
+     * addresses a static variable; other variables have no fixed address, so
+     * they are moved through the stack with a `vm` block. The code must fall
+     * through at its end and leave `SP` and the stack as it found them.
+     */
+    NodeId compileInline();
 
-    /** @brief Compile an expression, including binary operators. */
-    void compileExpression();
+    /** @brief Check and resolve the lines of a `vm` block; labels get the `scope` prefix. */
+    std::string resolveVmCode(std::string_view code, const std::string& scope) const;
 
-    /** @brief Compile a single term within an expression. */
-    void compileTerm();
+    /** @brief Check and resolve the lines of an `asm` block; labels get the `scope` prefix. */
+    std::string resolveAsmCode(std::string_view code, const std::string& scope) const;
+
+    /** @brief Parse an expression, including binary operators (left to right). */
+    NodeId compileExpression();
+
+    /** @brief Parse a single term within an expression. */
+    NodeId compileTerm();
+
+    /**
+     * @brief Parse a subroutine call whose first identifier has been consumed.
+     * @param name `sub`, `Class` or `var` of `sub(...)`, `Class.sub(...)`, `var.sub(...)`.
+     */
+    NodeId compileCall(std::string_view name);
+
+    /** @brief Parse a (possibly empty) comma-separated list of expressions. */
+    NodeList compileExpressionList();
+    
+  public:
+    /** @brief Construct a compilation engine bound to a tokenizer and output stream. */
+    CompilationEngine(Tokenizer& tokenizer, VmWriter& vmWriter, const CompilerOptions& options = {});
+    CompilationEngine operator=(CompilationEngine&) = delete;
+    CompilationEngine(CompilationEngine&) = delete;
+
+    /** @brief Parse an entire class, starting at the `class` keyword, into `ast()`. */
+    void parseClass();
+
+    /** @brief Tree built by the last `parseClass()`. */
+    Ast& ast() { return m_ast; }
+    const Ast& ast() const { return m_ast; }
 
     /**
-     * @brief Compile a (possibly empty) comma-separated list of expressions.
-     * @return Number of expressions compiled.
+     * @brief Parse an entire class, run the enabled `CompilerOptions` passes and emit its VM code.
+     * @param externalCalls Subroutines of this class that other classes call, when the whole
+     *        program is known; lets dead-code elimination drop the functions nobody calls.
      */
-    uint32_t compileExpressionList();
+    void compileClass(const std::set<std::string>* externalCalls = nullptr);
+
+    /** @brief Warnings of the last `compileClass()`, such as removed dead code. */
+    const std::vector<std::string>& warnings() const { return m_warnings; }
 };
@@ -1,25 +1,223 @@
 #include "../CompilerAnalyzer/compilerAnalyzer.h"
+#include "../BuildCache/buildCache.h"
 #include "../Utils/log.h"
+#include "../../../Common/mappedFile.h"
+#include "../../../Common/threadPool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
+#include <future>
+#include <map>
+#include <optional>
+#include <set>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
-CompilerAnalyzer::CompilerAnalyzer(const std::filesystem::path& filePath)
-  : m_jackFile(filePath)
-  , m_vmFile([&filePath]() {
-      std::filesystem::path vmPath { filePath };
-      vmPath.replace_extension(".vm");
-      return vmPath;
-    }())
-  , m_tokenizer(m_jackFile)
-  , m_vmWriter(m_vmFile)
-  , m_engine(m_tokenizer, m_vmWriter)
+namespace {
+std::filesystem::path outputPath(const std::filesystem::path& filePath, VmFormat format) {
+  std::filesystem::path vmPath { filePath };
+  vmPath.replace_extension(format == VmFormat::Binary ? ".vmb" : ".vm");
+  return vmPath;
+}
+
+/** @brief Settings that change the generated code; every `CompilerOptions` switch must appear. */
+std::string fingerprint(VmFormat format, const CompilerOptions& options) {
+  const auto flag = [](bool on) { return on ? "1" : "0"; };
+  return std::string(format == VmFormat::Binary ? "vmb" : "vm") +
+         " fold=" + flag(options.foldConstants) +
+         " strength=" + flag(options.strengthReduction) +
+         " branches=" + flag(options.compactBranches) +
+         " strings=" + flag(options.stringPool) +
+         " dce=" + flag(options.deadCodeElimination) +
+         " intrinsics=" + flag(options.intrinsics) +
+         " void=" + flag(options.voidCalls);
+}
+
+/** @brief Exception text without the "[ERROR] " prefix and trailing newline some modules add. */
+std::string errorMessage(const std::exception& e) {
+  std::string message { e.what() };
+  if (message.rfind("[ERROR] ", 0) == 0)
+    message.erase(0, 8);
+  while (!message.empty() && message.back() == '\n')
+    message.pop_back();
+  return message;
+}
+}
+
+CompilerAnalyzer::CompilerAnalyzer(const std::filesystem::path& filePath, VmFormat format,
+                                   const CompilerOptions& options)
+  : m_vmFile(outputPath(filePath, format),
+             format == VmFormat::Binary ? std::ios::out | std::ios::binary : std::ios::out)
+  , m_tokenizer(filePath)
+  , m_vmWriter(m_vmFile, format)
+  , m_engine(m_tokenizer, m_vmWriter, options)
 {
   if (filePath.extension() != ".jack")
     log<std::logic_error>("Input file is not a .jack file");
 }
 
-void CompilerAnalyzer::run() {
-  m_engine.compileClass();
-  m_vmFile.flush();
+void CompilerAnalyzer::run(const std::set<std::string>* externalCalls) {
+  m_engine.compileClass(externalCalls);
+  m_vmWriter.close();
 }
 
+std::vector<ClassResult> compileProject(const std::filesystem::path& directory, VmFormat format,
+                                        const CompilerOptions& options, std::size_t nThreads,
+                                        bool incremental) {
+  if (!std::filesystem::is_directory(directory))
+    log<std::runtime_error>("Not a directory: " + directory.string());
+
+  std::vector<ClassResult> results;
+  for (const auto& entry : std::filesystem::directory_iterator(directory))
+    if (entry.is_regular_file() && entry.path().extension() == ".jack")
+      results.push_back({ entry.path(), {}, {} });
+  if (results.empty())
+    log<std::runtime_error>("No .jack files in " + directory.string());
+
+  std::sort(results.begin(), results.end(),
+            [](const ClassResult& a, const ClassResult& b) { return a.source < b.source; });
+
+  if (nThreads == 0)
+    nThreads = std::thread::hardware_concurrency();
+  nThreads = std::max<std::size_t>(nThreads, 1);
+
+  BuildCache cache(fingerprint(format, options));
+  const std::filesystem::path cachePath { directory / BuildCache::kFileName };
+  if (incremental)
+    cache.load(cachePath);
+
+  // Subroutines of each class that the other classes call.
+  std::map<std::string, std::set<std::string>> calledFrom;
+  for (const ClassResult& result : results) {
+    const std::string self { result.source.stem().string() };
+    try {
+      const MappedFile source(result.source.string());
+      for (const std::string& name : qualifiedNames(source.view())) {
+        const std::size_t dot { name.find('.') };
+        if (name.compare(0, dot, self) != 0)
+          calledFrom[name.substr(0, dot)].insert(name.substr(dot + 1));
+      }
+    } catch (const std::runtime_error&) {
+      // Reported when the class itself is compiled.
+    }
+  }
+  // Uncalled functions are only removed from a whole program: one with a Main
+  // class, or a Sys class that does not hand over to a Main outside the
+  // directory. A library, or the OS on its own, keeps its whole API.
+  const auto hasClass = [&results](const std::string& name) {
+    return std::any_of(results.begin(), results.end(),
+                       [&name](const ClassResult& result) { return result.source.stem() == name; });
+  };
+  const bool wholeProgram { hasClass("Main") || (hasClass("Sys") && !calledFrom.count("Main")) };
+
+  std::vector<std::set<std::string>> externalCalls(results.size());
+  std::vector<uint64_t> callersHashes(results.size());
+  for (std::size_t i{}; i < results.size(); ++i) {
+    externalCalls[i] = std::move(calledFrom[results[i].source.stem().string()]);
+    std::string joined;
+    for (const std::string& name : externalCalls[i])
+      joined += name + ",";
+    callersHashes[i] = (options.deadCodeElimination && wholeProgram) ? hashBytes(joined) : 0;
+  }
+
+  std::vector<CacheEntry> fresh(results.size());
+  const auto compileAll = [&](const std::vector<std::size_t>& which) {
+    if (which.empty())
+      return;
+    ThreadPool pool(std::min(which.size(), nThreads));
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(which.size());
+    for (std::size_t i : which) {
+      pending.push_back(pool.submit([&results, &fresh, &externalCalls, i, format, &options, wholeProgram] {
+        logToStderr = false;
+        ClassResult& result = results[i];
+        result.compiled = true;
+        try {
+          CompilerAnalyzer analyzer(result.source, format, options);
+          analyzer.run(wholeProgram ? &externalCalls[i] : nullptr);
+          result.warnings = analyzer.warnings();
+          fresh[i].interface = extractInterface(analyzer.ast());
+          for (const std::string& used : referencedClasses(analyzer.ast()))
+            fresh[i].uses[used] = 0;
+        } catch (const std::exception& e) {
+          result.error = errorMessage(e);
+        }
+      }));
+    }
+
+    for (auto& done : pending) done.get();
+  };
+
+  // Phase 1: classes that are new, edited, called differently from the other
+  // classes, or whose output is gone or changed.
+  std::vector<const CacheEntry*> cached(results.size());
+  std::vector<std::optional<uint64_t>> sourceHashes(results.size());
+  std::vector<std::size_t> stale;
+  for (std::size_t i{}; i < results.size(); ++i) {
+    sourceHashes[i] = hashFile(results[i].source);
+    cached[i] = incremental ? cache.find(results[i].source.filename().string()) : nullptr;
+    if (!cached[i] || !sourceHashes[i] || *sourceHashes[i] != cached[i]->sourceHash ||
+        callersHashes[i] != cached[i]->callersHash ||
+        hashFile(outputPath(results[i].source, format)) != cached[i]->outputHash)
+      stale.push_back(i);
+  }
+  compileAll(stale);
+
+  std::map<std::string, uint64_t> interfaces;
+  for (std::size_t i{}; i < results.size(); ++i) {
+    const std::string name { results[i].source.stem().string() };
+    if (results[i].compiled && results[i].error.empty())
+      interfaces[name] = fresh[i].interface.hash();
+    else if (!results[i].compiled)
+      interfaces[name] = cached[i]->interface.hash();
+  }
+
+  // Phase 2: unchanged classes compiled against an interface that has changed
+  // since. Their own interfaces cannot have changed, so this does not cascade.
+  std::vector<std::size_t> dependents;
+  for (std::size_t i{}; i < results.size(); ++i) {
+    if (results[i].compiled)
+      continue;
+    for (const auto& [used, hash] : cached[i]->uses) {
+      const auto current = interfaces.find(used);
+      if ((current == interfaces.end() ? 0 : current->second) != hash) {
+        dependents.push_back(i);
+        break;
+      }
+    }
+  }
+  compileAll(dependents);
+
+  if (incremental) {
+    std::set<std::string> files;
+    for (std::size_t i{}; i < results.size(); ++i) {
+      const std::string file { results[i].source.filename().string() };
+      files.insert(file);
+      if (!results[i].compiled)
+        continue;
+      if (!results[i].error.empty() || !sourceHashes[i]) {
+        cache.erase(file);
+        continue;
+      }
+
+      CacheEntry& entry = fresh[i];
+      entry.sourceHash = *sourceHashes[i];
+      entry.outputHash = hashFile(outputPath(results[i].source, format)).value_or(0);
+      entry.callersHash = callersHashes[i];
+      for (auto& [used, hash] : entry.uses) {
+        const auto current = interfaces.find(used);
+        hash = current == interfaces.end() ? 0 : current->second;
+      }
+      cache.store(file, std::move(entry));
+    }
+    cache.retain(files);
+    cache.save(cachePath);
+  }
+
+  return results;
+}
@@ -6,8 +6,13 @@
 #include "../CompilationEngine/compileEngine.h"
 #include "../Tokenizer/tokenizer.h"
 #include "../VMWriter/vmWriter.h"
+#include "../Utils/compilerOptions.h"
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
+#include <set>
+#include <string>
+#include <vector>
 
 /**
  * @brief Validates input paths, owns I/O streams and modules, and invokes
@@ -15,9 +20,8 @@
  */
 class CompilerAnalyzer {
   private:
-    std::ifstream     m_jackFile;   /**< Open Jack source file stream. */
     std::ofstream     m_vmFile;     /**< VM output file stream. */
-    Tokenizer         m_tokenizer;  /**< Lexical analyzer over `m_jackFile`. */
+    Tokenizer         m_tokenizer;  /**< Lexical analyzer over the mapped Jack source. */
     VmWriter          m_vmWriter;   /**< VM writer bound to `m_vmFile`. */
     CompilationEngine m_engine;     /**< Core compilation engine. */
     
@@ -25,11 +29,55 @@ class CompilerAnalyzer {
     /**
      * @brief Construct a compiler analyzer for the given Jack source file path.
      * @param filePath Path to a `.jack` source file.
+     * @param format   Writes `<name>.vm` text, or `<name>.vmb` for `VmFormat::Binary`.
+     * @param options  Optimizations to run between parsing and VM emission.
      */
-    CompilerAnalyzer(const std::filesystem::path& filePath);
+    CompilerAnalyzer(const std::filesystem::path& filePath, VmFormat format = VmFormat::Text,
+                     const CompilerOptions& options = {});
     CompilerAnalyzer& operator=(CompilerAnalyzer&) = delete;
     CompilerAnalyzer(CompilerAnalyzer&) = delete;
 
-    /** @brief Run the compilation pipeline from Jack source to VM output. */
-    void run();
+    /**
+     * @brief Run the compilation pipeline from Jack source to VM output.
+     * @param externalCalls See `CompilationEngine::compileClass()`.
+     */
+    void run(const std::set<std::string>* externalCalls = nullptr);
+
+    /** @brief Warnings of the last `run()`. */
+    const std::vector<std::string>& warnings() const { return m_engine.warnings(); }
+
+    /** @brief Tree of the class compiled by `run()`. */
+    const Ast& ast() const { return m_engine.ast(); }
 };
+
+/** @brief Outcome of compiling one class of a project directory. */
+struct ClassResult {
+  std::filesystem::path source;      /**< The `.jack` file. */
+  std::string           error;       /**< Exception text, empty if the class compiled. */
+  std::vector<std::string> warnings; /**< Warnings of the compile, if it ran. */
+  bool                  compiled {}; /**< False when the cached output was up to date. */
+};
+
+/**
+ * @brief Compile every `.jack` file in `directory` concurrently, each class
+ *        with its own `CompilerAnalyzer` (tokenizer, symbol tables, writer).
+ *
+ * With `incremental`, a `BuildCache` in the directory (`.jackcache`) skips
+ * classes whose source and output are unchanged since the last successful
+ * compile, unless the interface of a class they call has changed since.
+ *
+ * Every source is scanned for `Class.sub` references first, so dead-code
+ * elimination knows which functions of a class other classes call; a class
+ * is compiled again when that set changes. Uncalled functions are only
+ * removed when the directory holds a whole program (a `Main` class, or a
+ * `Sys` class that calls no `Main` outside it), so a library keeps its API.
+ *
+ * @param nThreads    Worker count; 0 uses one per core, capped at the file count.
+ * @param incremental Read and update the build cache.
+ * @return One result per file, in sorted path order whatever the completion order.
+ */
+std::vector<ClassResult> compileProject(const std::filesystem::path& directory,
+                                        VmFormat format = VmFormat::Text,
+                                        const CompilerOptions& options = {},
+                                        std::size_t nThreads = 0,
+                                        bool incremental = false);
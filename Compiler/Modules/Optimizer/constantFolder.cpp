@@ -0,0 +1,157 @@
+#include "constantFolder.h"
+#include "../AST/ast.h"
+#include "../Utils/keyword.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace {
+/** @brief Value of a constant node as a 16-bit Jack integer, if it is one. */
+std::optional<int16_t> constantOf(const Expr& expr) {
+  if (expr.kind == ExprKind::IntConst)
+    return static_cast<int16_t>(static_cast<uint16_t>(expr.value));
+  if (expr.kind == ExprKind::KeywordConst && expr.keyword != Keyword::This)
+    return static_cast<int16_t>(expr.keyword == Keyword::True ? -1 : 0);
+  return std::nullopt;
+}
+
+Expr makeConstant(int32_t value) {
+  Expr constant { ExprKind::IntConst };
+  constant.value = static_cast<uint16_t>(value);
+  return constant;
+}
+
+int16_t wrap(int32_t value) {
+  return static_cast<int16_t>(static_cast<uint16_t>(value));
+}
+
+/** @brief Evaluate `lhs op rhs`, or nothing when it must stay a run-time operation. */
+std::optional<int32_t> evaluate(char op, int16_t lhs, int16_t rhs) {
+  switch (op) {
+    case '+': return lhs + rhs;
+    case '-': return lhs - rhs;
+    case '*': return lhs * rhs;
+    case '/':
+      if (rhs == 0)
+        return std::nullopt;
+      return lhs / rhs;
+    case '&': return lhs & rhs;
+    case '|': return lhs | rhs;
+    case '<': return wrap(lhs - rhs) < 0 ? -1 : 0;
+    case '>': return wrap(lhs - rhs) > 0 ? -1 : 0;
+    case '=': return lhs == rhs ? -1 : 0;
+  }
+  return std::nullopt;
+}
+}
+
+FoldStats foldConstants(Ast& ast) {
+  FoldStats stats;
+
+  // The parser creates children before their parents, so one sweep in id
+  // order folds bottom-up. `pure[id]`: evaluating the node has no effect
+  // beyond its value (no call, allocation or possible division error).
+  std::vector<bool> pure(ast.exprCount());
+
+  const auto negate = [&ast](NodeId operand) {
+    Expr unary { ExprKind::Unary };
+    unary.op  = '-';
+    unary.lhs = operand;
+    return unary;
+  };
+
+  for (NodeId id{}; id < ast.exprCount(); ++id) {
+    Expr& expr = ast.expr(id);
+
+    switch (expr.kind) {
+      case ExprKind::IntConst:
+      case ExprKind::KeywordConst:
+      case ExprKind::Var:
+        pure[id] = true;
+        break;
+
+      case ExprKind::StringConst:
+      case ExprKind::Call:
+        pure[id] = false;
+        break;
+
+      case ExprKind::ArrayElem:
+        pure[id] = pure[expr.lhs];
+        break;
+
+      case ExprKind::Unary: {
+        const Expr operand = ast.expr(expr.lhs);
+        pure[id] = pure[expr.lhs];
+        if (const auto value = constantOf(operand)) {
+          expr = makeConstant(expr.op == '-' ? -*value : ~*value);
+          ++stats.folded;
+        } else if (operand.kind == ExprKind::Unary && operand.op == expr.op) {
+          expr = ast.expr(operand.lhs);
+          ++stats.simplified;
+        }
+        break;
+      }
+
+      case ExprKind::Binary: {
+        const NodeId lhsId { expr.lhs };
+        const NodeId rhsId { expr.rhs };
+        const auto lhs = constantOf(ast.expr(lhsId));
+        const auto rhs = constantOf(ast.expr(rhsId));
+        pure[id] = pure[lhsId] && pure[rhsId] && (expr.op != '/' || (rhs && *rhs != 0));
+
+        if (lhs && rhs) {
+          if (const auto value = evaluate(expr.op, *lhs, *rhs)) {
+            expr = makeConstant(*value);
+            ++stats.folded;
+          }
+          break;
+        }
+
+        if (!lhs && !rhs)
+          break;
+
+        // Exactly one side is constant: try the identities. Dropping the
+        // other operand entirely is only allowed when it is pure.
+        const bool constRight { rhs.has_value() };
+        const int16_t k { constRight ? *rhs : *lhs };
+        const NodeId other { constRight ? lhsId : rhsId };
+
+        std::optional<Expr> replacement;
+        switch (expr.op) {
+          case '+':
+            if (k == 0) replacement = ast.expr(other);
+            break;
+          case '-':
+            if (k == 0) replacement = constRight ? ast.expr(other) : negate(other);
+            break;
+          case '*':
+            if (k == 1)                    replacement = ast.expr(other);
+            else if (k == -1)              replacement = negate(other);
+            else if (k == 0 && pure[other]) replacement = makeConstant(0);
+            break;
+          case '/':
+            if (constRight && k == 1)       replacement = ast.expr(other);
+            else if (constRight && k == -1) replacement = negate(other);
+            break;
+          case '&':
+            if (k == -1)                   replacement = ast.expr(other);
+            else if (k == 0 && pure[other]) replacement = makeConstant(0);
+            break;
+          case '|':
+            if (k == 0)                     replacement = ast.expr(other);
+            else if (k == -1 && pure[other]) replacement = makeConstant(-1);
+            break;
+        }
+        if (replacement) {
+          expr = *replacement;
+          ++stats.simplified;
+          if (expr.kind == ExprKind::IntConst)
+            pure[id] = true;
+        }
+        break;
+      }
+    }
+  }
+  return stats;
+}
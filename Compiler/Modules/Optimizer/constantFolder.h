@@ -0,0 +1,32 @@
+/** @file
+ *  @brief Compile-time evaluation of constant Jack expressions.
+ */
+#pragma once
+
+#include <cstdint>
+#include "../AST/ast.h"
+
+/** @brief What foldConstants() changed. */
+struct FoldStats {
+  uint32_t folded {};      /**< Operators on constant operands replaced by their value. */
+  uint32_t simplified {};  /**< Identities such as `x+0` or `~~x` reduced to their operand. */
+};
+
+/**
+ * @brief Folds constant sub-expressions of `ast` in place.
+ *
+ * Jack integers are 16-bit two's complement, so `+ - *` wrap, `/` truncates
+ * toward zero and comparisons yield `true` (-1) or `false` (0). `<` and `>`
+ * test the sign of the wrapped difference, as the VM translator's `lt`/`gt`
+ * do, so `32767 < -2` folds to `true` just as it evaluates at run time.
+ * Division by a constant zero is left for `Math.divide` to report at run time.
+ *
+ * Besides fully constant operators, it reduces `x+0`, `x-0`, `0+x`, `0-x`,
+ * `x*1`, `x*-1`, `x/1`, `x/-1`, `x&-1`, `x|0`, `--x` and `~~x` to `x` or
+ * `-x`, and `x*0`, `x&0`, `x|-1` to a constant when `x` has no side effects.
+ * Operands are never reordered, so calls still happen in source order.
+ *
+ * Folded values outside 0..32767 are stored as their 16-bit pattern; the
+ * code generator pushes those as `push constant ~v; not`.
+ */
+FoldStats foldConstants(Ast& ast);
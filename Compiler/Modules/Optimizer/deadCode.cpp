@@ -0,0 +1,231 @@
+#include "deadCode.h"
+#include "../AST/ast.h"
+#include "../CodeGenerator/codeGenerator.h"
+#include "../Utils/keyword.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+/** @brief Whether a constant condition is true (non-zero), if it is constant. */
+std::optional<bool> constantCondition(const Expr& expr) {
+  if (expr.kind == ExprKind::IntConst)
+    return (expr.value & 0xFFFFu) != 0;
+  if (expr.kind == ExprKind::KeywordConst && expr.keyword != Keyword::This)
+    return expr.keyword == Keyword::True;
+  return std::nullopt;
+}
+
+/**
+ * @brief Whether a constant `while` condition keeps looping, if it is constant.
+ *        The loop exits with `not; if-goto`, so only true (-1) loops; any
+ *        other value ends it before the first iteration.
+ */
+std::optional<bool> constantLoopCondition(const Expr& expr) {
+  const std::optional<bool> condition = constantCondition(expr);
+  if (condition && expr.kind == ExprKind::IntConst)
+    return (expr.value & 0xFFFFu) == 0xFFFFu;
+  return condition;
+}
+
+std::string plural(uint32_t count, const char* noun) {
+  return std::to_string(count) + " " + noun + (count == 1 ? "" : "s");
+}
+
+class DeadCodeEliminator {
+  private:
+    Ast& m_ast;
+    DeadCodeReport& m_report;
+    std::string m_where;  /**< `Class.sub` of the subroutine being pruned. */
+    std::vector<NodeId> m_scratch;
+
+    void warn(const std::string& message) {
+      m_report.warnings.push_back(m_where + ": " + message);
+    }
+
+    /** @brief `list` pruned into a new list. */
+    NodeList prune(NodeList list, bool& terminates) {
+      const std::size_t from { m_scratch.size() };
+      terminates = pruneInto(list);
+      return m_ast.addList(m_scratch, from);
+    }
+
+    /**
+     * @brief Push the live statements of `list` onto the scratch stack, with
+     *        constant `if`s replaced by their arm.
+     * @return Whether control never reaches the end of the list.
+     */
+    bool pruneInto(NodeList list) {
+      for (uint32_t i{}; i < list.count; ++i) {
+        if (pruneStatement(m_ast.child(list, i))) {
+          if (const uint32_t dropped { list.count - i - 1 }) {
+            m_report.statements += dropped;
+            warn("removed " + plural(dropped, "unreachable statement"));
+          }
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * @brief Push `id`, pruned, onto the scratch stack; returns whether it never completes.
+     *        Pruning adds lists and expressions but no statements, so `stmt` stays valid.
+     */
+    bool pruneStatement(NodeId id) {
+      Stmt& stmt = m_ast.stmt(id);
+
+      switch (stmt.kind) {
+        case StmtKind::If: {
+          if (const std::optional<bool> taken = constantCondition(m_ast.expr(stmt.expr))) {
+            const NodeList skipped { *taken ? stmt.orElse : stmt.body };
+            if (skipped.count) {
+              ++m_report.branches;
+              warn(std::string("if condition is always ") + (*taken ? "true; removed the else branch"
+                                                                    : "false; removed the then branch"));
+            }
+            return pruneInto(*taken ? stmt.body : stmt.orElse);
+          }
+
+          bool bodyReturns {}, elseReturns {};
+          stmt.body = prune(stmt.body, bodyReturns);
+          stmt.orElse = prune(stmt.orElse, elseReturns);
+          m_scratch.push_back(id);
+          return stmt.hasElse && bodyReturns && elseReturns;
+        }
+
+        case StmtKind::While: {
+          const std::optional<bool> loops = constantLoopCondition(m_ast.expr(stmt.expr));
+          if (loops == false) {
+            ++m_report.branches;
+            warn("while condition is always false; removed the loop");
+            return false;
+          }
+
+          bool bodyReturns {};
+          stmt.body = prune(stmt.body, bodyReturns);
+          if (loops) {
+            Expr always { ExprKind::KeywordConst };
+            always.keyword = Keyword::True;
+            stmt.expr = m_ast.addExpr(always);
+          }
+          m_scratch.push_back(id);
+          return loops.has_value();
+        }
+
+        case StmtKind::Return:
+          m_scratch.push_back(id);
+          return true;
+
+        default:
+          m_scratch.push_back(id);
+          return false;
+      }
+    }
+
+    /** @brief Add `name` to `called`, without its class prefix, if it is a function of this class. */
+    void collectCall(std::string_view name, std::set<std::string>& called) const {
+      if (name.size() > m_ast.className.size() && name.compare(0, m_ast.className.size(), m_ast.className) == 0 &&
+          name[m_ast.className.size()] == '.')
+        called.emplace(name.substr(m_ast.className.size() + 1));
+    }
+
+    /** @brief Add the functions of this class that `id` (or its operands) calls to `called`. */
+    void collectCalls(NodeId id, std::set<std::string>& called) const {
+      if (id == kNoNode)
+        return;
+      const Expr& expr = m_ast.expr(id);
+      if (expr.kind == ExprKind::Call) {
+        collectCall(m_ast.string(expr.value), called);
+        for (uint32_t i{}; i < expr.args.count; ++i)
+          collectCalls(m_ast.child(expr.args, i), called);
+        return;
+      }
+      collectCalls(expr.lhs, called);
+      collectCalls(expr.rhs, called);
+    }
+
+    void collectCalls(NodeList statements, std::set<std::string>& called) const {
+      for (uint32_t i{}; i < statements.count; ++i) {
+        const Stmt& stmt = m_ast.stmt(m_ast.child(statements, i));
+        collectCalls(stmt.subscript, called);
+        collectCalls(stmt.expr, called);
+        collectCalls(stmt.body, called);
+        collectCalls(stmt.orElse, called);
+        if (stmt.kind == StmtKind::Vm)
+          for (std::string_view name : inlineCalls(m_ast.string(stmt.index)))
+            collectCall(name, called);
+      }
+    }
+
+  public:
+    DeadCodeEliminator(Ast& ast, DeadCodeReport& report)
+      : m_ast(ast)
+      , m_report(report)
+    {}
+
+    void pruneBodies() {
+      for (Subroutine& subroutine : m_ast.subroutines) {
+        m_where = m_ast.className + "." + subroutine.name;
+        bool returns {};
+        subroutine.body = prune(subroutine.body, returns);
+      }
+    }
+
+    void removeUncalledFunctions(const std::set<std::string>& externalCalls) {
+      const auto isEntryPoint = [this](const Subroutine& subroutine) {
+        return (m_ast.className == "Main" && subroutine.name == "main") ||
+               (m_ast.className == "Sys" && subroutine.name == "init");
+      };
+      // Called by generated code, which no source scan sees.
+      const auto isImplicitCallee = [this](const Subroutine& subroutine) {
+        const std::string name { m_ast.className + "." + subroutine.name };
+        return std::find(std::begin(CodeGenerator::kImplicitCallees), std::end(CodeGenerator::kImplicitCallees),
+                         name) != std::end(CodeGenerator::kImplicitCallees);
+      };
+
+      std::set<std::string> live;
+      std::vector<const Subroutine*> pending;
+      for (const Subroutine& subroutine : m_ast.subroutines) {
+        if (subroutine.kind != SubroutineKind::Function || externalCalls.count(subroutine.name) ||
+            isEntryPoint(subroutine) || isImplicitCallee(subroutine)) {
+          live.insert(subroutine.name);
+          pending.push_back(&subroutine);
+        }
+      }
+
+      while (!pending.empty()) {
+        const Subroutine* subroutine { pending.back() };
+        pending.pop_back();
+
+        std::set<std::string> called;
+        collectCalls(subroutine->body, called);
+        for (const Subroutine& callee : m_ast.subroutines)
+          if (called.count(callee.name) && live.insert(callee.name).second)
+            pending.push_back(&callee);
+      }
+
+      for (Subroutine& subroutine : m_ast.subroutines) {
+        if (live.count(subroutine.name))
+          continue;
+        subroutine.removed = true;
+        ++m_report.subroutines;
+        m_report.warnings.push_back(m_ast.className + ": removed unused function " + subroutine.name);
+      }
+    }
+};
+}
+
+DeadCodeReport eliminateDeadCode(Ast& ast, const std::set<std::string>* externalCalls) {
+  DeadCodeReport report;
+  DeadCodeEliminator eliminator(ast, report);
+  eliminator.pruneBodies();
+  if (externalCalls)
+    eliminator.removeUncalledFunctions(*externalCalls);
+  return report;
+}
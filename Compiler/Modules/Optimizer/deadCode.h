@@ -0,0 +1,40 @@
+/** @file
+ *  @brief Removal of Jack statements and functions that can never run.
+ */
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include "../AST/ast.h"
+
+/** @brief What eliminateDeadCode() removed, with one warning per removal. */
+struct DeadCodeReport {
+  uint32_t statements {};   /**< Statements after a `return` or an endless loop. */
+  uint32_t branches {};     /**< `if` arms and `while` loops behind a constant condition. */
+  uint32_t subroutines {};  /**< Functions nothing calls. */
+  std::vector<std::string> warnings;  /**< `Class.sub: ...`, in source order. */
+};
+
+/**
+ * @brief Drops code of `ast` that cannot execute, in place.
+ *
+ * - Statements following a `return`, an `if` whose arms both return, or a
+ *   `while` with a constant true condition (Jack has no `break`) are removed.
+ * - An `if` on a constant condition is replaced by the arm that runs; any
+ *   non-zero value counts as true, as with `if-goto`. A `while` exits through
+ *   `not; if-goto`, so it only loops on true (-1): a `while` on any other
+ *   constant is removed, and one on true is given the condition `true`, which
+ *   the code generator turns into a plain `goto`.
+ * - With `externalCalls` (the class's subroutines that other classes call),
+ *   functions that are neither called from outside nor reachable from another
+ *   subroutine of the class are marked `Subroutine::removed`. Constructors,
+ *   methods, `Main.main`, `Sys.init` and the OS functions the code generator
+ *   calls on its own (`CodeGenerator::kImplicitCallees`) are always kept. Jack has no private
+ *   subroutines, so without the set nothing is removed.
+ *
+ * Run it after `foldConstants()`, which turns conditions such as `1 < 2` into
+ * constants.
+ */
+DeadCodeReport eliminateDeadCode(Ast& ast, const std::set<std::string>* externalCalls = nullptr);
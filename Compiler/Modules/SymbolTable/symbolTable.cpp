@@ -1,11 +1,22 @@
-
 #include "symbolTable.h"
 #include <cstdint>
 #include <stdexcept>
+#include <string>
 #include <string_view>
-#include <utility>
 #include "../Utils/identifier.h"
 
+SymbolTable::SymbolTable(const SymbolTable* enclosing)
+  : m_enclosing(enclosing)
+{}
+
+std::string_view SymbolTable::intern(std::string_view name) {
+  auto it { m_names.find(name) };
+  if (it != m_names.end())
+    return *it;
+
+  return *m_names.insert(m_nameStorage.emplace_back(name)).first;
+}
+
 void SymbolTable::reset() {
   m_table.clear();
 
@@ -16,28 +27,34 @@ void SymbolTable::reset() {
 }
 
 void SymbolTable::define(std::string_view name, std::string_view type, IdentifierKind identifier) {
+  uint32_t idx;
   switch (identifier) {
     case IdentifierKind::Static:
-      m_staticCnt++;
+      idx = m_staticCnt++;
       break;
     case IdentifierKind::Arg:
-      m_argCnt++;
+      idx = m_argCnt++;
       break;
     case IdentifierKind::Var:
-      m_varCnt++;
+      idx = m_varCnt++;
       break;
     case IdentifierKind::Field:
-      m_fieldCnt++;
+      idx = m_fieldCnt++;
       break;
     default:
       throw std::runtime_error("[ERROR] Invalid identifier kind in define()\n");
   }
 
-  std::string symbolName {  static_cast<std::string>(name) };
-  std::string symbolType {  static_cast<std::string>(type) };
-  Symbol symbol { symbolType, identifier, m_Idx++};
+  m_table.emplace(intern(name), Symbol { intern(type), identifier, idx });
+}
 
-  m_table.emplace(std::move(symbolName), std::move(symbol));
+const Symbol* SymbolTable::resolve(std::string_view name) const {
+  for (const SymbolTable* scope { this }; scope; scope = scope->m_enclosing) {
+    auto it { scope->m_table.find(name) };
+    if (it != scope->m_table.end())
+      return &it->second;
+  }
+  return nullptr;
 }
 
 uint32_t SymbolTable::varCount(IdentifierKind identifier) const {
@@ -51,7 +68,7 @@ uint32_t SymbolTable::varCount(IdentifierKind identifier) const {
 }
 
 IdentifierKind SymbolTable::kindOf(std::string_view name) const {
-  auto it { m_table.find(static_cast<std::string>(name)) };
+  auto it { m_table.find(name) };
   if (it != m_table.end())
     return it->second.kind;
 
@@ -59,15 +76,15 @@ IdentifierKind SymbolTable::kindOf(std::string_view name) const {
 }
 
 std::string SymbolTable::typeOf(std::string_view name) const {
-  auto it { m_table.find(static_cast<std::string>(name)) };
+  auto it { m_table.find(name) };
   if (it != m_table.end())
-    return it->second.type;
+    return std::string(it->second.type);
 
   throw std::runtime_error("[ERROR] Could not find the symbol type\n");
 }
 
 uint32_t SymbolTable::indexOf(std::string_view name) const {
-  auto it { m_table.find(static_cast<std::string>(name)) };
+  auto it { m_table.find(name) };
   if (it != m_table.end())
     return it->second.idx;
 
@@ -4,20 +4,27 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include "../Utils/identifier.h"
 
 /** @brief Metadata associated with a single Jack identifier. */
 struct Symbol {
-  std::string    type;  /**< Declared type (e.g., `int`, class name). */
-  IdentifierKind kind;  /**< Kind / scope of the identifier (static, field, arg, var). */
-  uint32_t       idx;   /**< Running index within its kind. */
+  std::string_view type;  /**< Declared type (e.g., `int`, class name), interned in the owning table. */
+  IdentifierKind   kind;  /**< Kind / scope of the identifier (static, field, arg, var). */
+  uint32_t         idx;   /**< Running index within its kind. */
 };
 
-/** @brief Convenience alias for the underlying symbol lookup table. */
-using Table = std::unordered_map<std::string, Symbol>;
+/**
+ * @brief Convenience alias for the underlying symbol lookup table.
+ *
+ * Keys are views of interned names, so lookups hash the caller's
+ * `std::string_view` directly instead of building a `std::string`.
+ */
+using Table = std::unordered_map<std::string_view, Symbol>;
 
 /**
  * @brief Maintains separate counts and mappings for static/field/arg/var symbols
@@ -25,21 +32,38 @@ using Table = std::unordered_map<std::string, Symbol>;
  */
 class SymbolTable {
   private:
+    const SymbolTable* m_enclosing {};  /**< Scope searched by `resolve()` after this one. */
     Table    m_table;      /**< Map from identifier name to symbol metadata. */
 
+    /** @brief Names and types seen so far; kept across `reset()` so later subroutines reuse them. */
+    std::deque<std::string>              m_nameStorage;
+    std::unordered_set<std::string_view> m_names;
+
     uint32_t m_staticCnt{};
     uint32_t m_fieldCnt{};
     uint32_t m_argCnt{};
     uint32_t m_varCnt{};
-    uint32_t m_Idx{};
+
+    /** @brief Stable view of `name`, stored on first use. */
+    std::string_view intern(std::string_view name);
 
   public:
     SymbolTable() = default;
     SymbolTable& operator=(const SymbolTable&) = delete;
 
+    /** @brief A scope nested in `enclosing` (a subroutine inside its class). */
+    explicit SymbolTable(const SymbolTable* enclosing);
+
     /** @brief Clear all symbols and reset kind counters to zero. */
     void reset();
 
+    /**
+     * @brief Find `name` in this scope, then in the enclosing ones.
+     * @return The symbol, or `nullptr` if no scope defines it. Valid until
+     *         the defining table is reset.
+     */
+    const Symbol* resolve(std::string_view name) const;
+
     /**
      * @brief Define a new identifier in the table.
      * @param name Identifier name.
@@ -1,47 +1,144 @@
 #include "../Utils/keyword.h"
 #include "../Utils/tokenType.h"
 #include "tokenizer.h"
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
-#include <cstring>
+#include <system_error>
+#include <utility>
+
+namespace {
+constexpr unsigned char kSpace  { 1 };
+constexpr unsigned char kSymbol { 2 };
+
+/** @brief Character classes indexed by byte: whitespace and single-character Jack symbols. */
+constexpr auto kCharClass = [] {
+  std::array<unsigned char, 256> classes {};
+  for (unsigned char c : std::string_view(" \t\n\v\f\r"))
+    classes[c] = kSpace;
+  for (unsigned char c : std::string_view("{}()[].,;+-*/&|<>=~"))
+    classes[c] = kSymbol;
+  return classes;
+}();
+
+inline bool isSpace(char c)      { return kCharClass[static_cast<unsigned char>(c)] == kSpace; }
+inline bool isSymbolChar(char c) { return kCharClass[static_cast<unsigned char>(c)] == kSymbol; }
+
+/** @brief Lookup table mapping keyword strings to `Keyword` enum values. */
+constexpr std::pair<std::string_view, Keyword> kKeywords[] = {
+  { "class",       Keyword::Class },
+  { "constructor", Keyword::Constructor },
+  { "function",    Keyword::Function },
+  { "method",      Keyword::Method },
+  { "field",       Keyword::Field },
+  { "static",      Keyword::Static },
+  { "var",         Keyword::Var },
+  { "int",         Keyword::Int },
+  { "char",        Keyword::Char },
+  { "boolean",     Keyword::Boolean },
+  { "void",        Keyword::Void },
+  { "true",        Keyword::True },
+  { "false",       Keyword::False },
+  { "null",        Keyword::Null },
+  { "this",        Keyword::This },
+  { "let",         Keyword::Let },
+  { "do",          Keyword::Do },
+  { "if",          Keyword::If },
+  { "else",        Keyword::Else },
+  { "while",       Keyword::While },
+  { "return",      Keyword::Return },
+};
+
+constexpr std::size_t kMinKeywordLength { 2 };
+constexpr std::size_t kMaxKeywordLength { 11 };
+constexpr std::size_t kKeywordSlotCount { 32 };
+
+/**
+ * @brief Perfect hash over the keywords: the first two characters and the length
+ *        give every keyword its own slot (checked below). Needs `word.size() >= 2`.
+ */
+constexpr std::size_t keywordHash(std::string_view word) {
+  return (2u * static_cast<unsigned char>(word[0]) + 14u * static_cast<unsigned char>(word[1]) + 5u * word.size())
+         % kKeywordSlotCount;
+}
+
+/** @brief Index into `kKeywords` of the keyword owning each hash slot, or -1. */
+constexpr auto kKeywordSlots = [] {
+  std::array<int8_t, kKeywordSlotCount> slots {};
+  for (auto& slot : slots)
+    slot = -1;
+  for (std::size_t i{}; i < std::size(kKeywords); ++i)
+    slots[keywordHash(kKeywords[i].first)] = static_cast<int8_t>(i);
+  return slots;
+}();
+
+constexpr bool keywordHashIsPerfect() {
+  for (std::size_t i{}; i < std::size(kKeywords); ++i) {
+    const int8_t slot { kKeywordSlots[keywordHash(kKeywords[i].first)] };
+    if (slot != static_cast<int8_t>(i) || kKeywords[i].first.size() < kMinKeywordLength
+        || kKeywords[i].first.size() > kMaxKeywordLength)
+      return false;
+  }
+  return true;
+}
+static_assert(keywordHashIsPerfect(), "keyword hash collides; pick new keywordHash() coefficients");
 
-static inline bool isSymbolChar(char c) {
-  static constexpr const char* kSyms = "{}()[].,;+-*/&|<>=~";
-  return std::strchr(kSyms, c) != nullptr;
+/** @brief Look up the `Keyword` for `word` with one hash and at most one comparison. */
+constexpr std::optional<Keyword> lookUpKeyWord(std::string_view word) {
+  if (word.size() < kMinKeywordLength || word.size() > kMaxKeywordLength)
+    return std::nullopt;
+
+  const int8_t slot { kKeywordSlots[keywordHash(word)] };
+  if (slot < 0 || kKeywords[slot].first != word)
+    return std::nullopt;
+  return kKeywords[slot].second;
+}
+static_assert(lookUpKeyWord("constructor") == Keyword::Constructor && !lookUpKeyWord("classy"));
+}
+
+Tokenizer::Tokenizer(const std::filesystem::path& path)
+{
+  m_mapped.emplace(path.string());
+  start(m_mapped->view());
 }
 
-Tokenizer::Tokenizer(std::ifstream& file): m_file { file }
+Tokenizer::Tokenizer(std::ifstream& file): m_file { &file }
 {
-  if (!m_file.is_open() || !m_file.good())
+  if (!file.is_open() || !file.good())
     throw std::runtime_error("[ERROR] Tokenizer: input file is not open or not readable");
-    
-  auto firstToken = nextTokenFromStream();
+
+  m_buffer.assign(std::istreambuf_iterator<char>(file), {});
+  start(m_buffer);
+}
+
+void Tokenizer::start(std::string_view source) {
+  m_cursor = source.data();
+  m_end    = source.data() + source.size();
+
+  auto firstToken = nextTokenFromSource();
   if (!firstToken.has_value())
     throw std::runtime_error("[ERROR] Tokenizer: no tokens found in input file");
     
-  m_currentToken = std::move(*firstToken);
-  if (auto secondToken = nextTokenFromStream())
-    m_lookaheadBuff = std::move(*secondToken);
+  m_currentToken  = *firstToken;
+  m_lookaheadBuff = nextTokenFromSource();
 }
 
-bool Tokenizer::hasMoreTokens() const { return m_lookaheadBuff.has_value(); }
-
 void Tokenizer::advance() {
   if (!hasMoreTokens())
     throw std::runtime_error("[ERROR] There are no more tokens\n");
 
-  m_currentToken = std::move(*m_lookaheadBuff);
-
-  if (auto nextToken = nextTokenFromStream())
-    m_lookaheadBuff = std::move(*nextToken);
-  else
-    m_lookaheadBuff.reset();
+  m_currentToken  = *m_lookaheadBuff;
+  m_lookaheadBuff = nextTokenFromSource();
 }
 
 bool Tokenizer::isValidInteger(std::string_view token) const {
@@ -72,149 +169,131 @@ bool Tokenizer::isValidIdentifier(const std::string_view token) const {
   return true;
 }
 
-Token Tokenizer::tokenType() const {
-  if (lookUpKeyWord(m_currentToken))
-    return Token::Keyword;
-
-  if (lookUpKeySymbols(m_currentToken))
-    return Token::Symbol;
-
-  if (isValidInteger(m_currentToken))
-    return Token::IntConst;
-
-  if (isValidIdentifier(m_currentToken))
-    return Token::Identifier;
-
-  return Token::StringConst;
-}
+Tokenizer::Lexeme Tokenizer::classifyWord(std::string_view word) const {
+  if (isValidInteger(word)) {
+    Lexeme token { word, Token::IntConst };
+    if (std::from_chars(word.data(), word.data() + word.size(), token.intValue).ec != std::errc{})
+      throw std::out_of_range("[ERROR] Integer constant out of range: " + std::string(word));
+    return token;
+  }
 
-Keyword Tokenizer::keyWord() const {
-  auto keyword { lookUpKeyWord(m_currentToken) };
+  if (auto keyword = lookUpKeyWord(word))
+    return { word, Token::Keyword, *keyword };
 
-  if (!keyword.has_value())
-    throw std::runtime_error("[ERROR] keyword() called on non-keyword token\n");
+  if (isValidIdentifier(word))
+    return { word, Token::Identifier };
 
-  return *keyword;
+  return { word, Token::StringConst };
 }
 
-char Tokenizer::symbol() const {
-  if (tokenType() != Token::Symbol)
-    throw std::runtime_error("[ERROR] symbol() should only be called on tokenType is Symbol\n");
-
-  return m_currentToken[0];
-}
+void Tokenizer::wrongTokenType(const char* message) { throw std::runtime_error(message); }
 
 std::string Tokenizer::identifier() const {
-  if (tokenType() != Token::Identifier)
+  if (m_currentToken.type != Token::Identifier)
     throw std::runtime_error("[ERROR] identifier() should only be called on tokenType is identifier\n");
 
-  return m_currentToken;
+  return std::string(m_currentToken.text);
 }
 
 
 uint32_t Tokenizer::intVal() const {
-  if (tokenType() != Token::IntConst)
+  if (m_currentToken.type != Token::IntConst)
     throw std::runtime_error("[ERROR] intVal() should only be called on tokenType is IntConst\n");
 
-  return std::stoi(m_currentToken);
+  return m_currentToken.intValue;
 }
 
 std::string Tokenizer::stringVal() const {
-  if (tokenType() != Token::StringConst)
+  if (m_currentToken.type != Token::StringConst)
     throw std::runtime_error("[ERROR] stringVal() should only be called on tokenType is stringConst\n");
 
-  return m_currentToken;
+  return std::string(m_currentToken.text);
 }
 
-std::string_view Tokenizer::getCurrentToken() const { return m_currentToken; }
-
 std::string_view Tokenizer::getNextToken() const { 
   if (!m_lookaheadBuff.has_value())
     throw std::runtime_error("[ERROR] There is no next token\n");
 
-  return *m_lookaheadBuff;
+  return m_lookaheadBuff->text;
+}
+
+std::string_view Tokenizer::rawBlock() {
+  if (m_currentToken.type != Token::Symbol || m_currentToken.symbol != '{')
+    throw std::runtime_error("[ERROR] rawBlock() should only be called on a '{' token\n");
+
+  // The lookahead token has already been scanned, so rescan from the brace itself.
+  const char* const first { m_currentToken.text.data() + 1 };
+  const char* p { first };
+  while (p != m_end && *p != '}') {
+    if (*p == '/' && m_end - p > 1 && p[1] == '/')
+      p = std::find(p + 2, m_end, '\n');
+    else
+      ++p;
+  }
+  if (p == m_end)
+    throw std::runtime_error("[ERROR] Block is missing its closing '}'\n");
+
+  m_cursor = p;
+  m_currentToken  = *nextTokenFromSource();
+  m_lookaheadBuff = nextTokenFromSource();
+  return std::string_view(first, static_cast<std::size_t>(p - first));
 }
 
-void Tokenizer::close() { m_file.close(); }
+void Tokenizer::close() {
+  if (m_file)
+    m_file->close();
+}
 
-std::optional<std::string> Tokenizer::nextTokenFromStream() {
-  char c;
+std::optional<Tokenizer::Lexeme> Tokenizer::nextTokenFromSource() {
+  const char* p { m_cursor };
+  const char* const end { m_end };
 
   while (true) {
     // Skip whitespace
-    while (m_file.get(c)) {
-      if (!std::isspace(static_cast<unsigned char>(c)))
-        break;
-    }
+    while (p != end && isSpace(*p))
+      ++p;
 
-    if (!m_file)
+    if (p == end) {
+      m_cursor = p;
       return std::nullopt;
+    }
 
-    // Handle comments or '/' symbol
-    if (c == '/') {
-      char d;
-      if (!m_file.get(d)) {
-        // Just '/' at EOF – treat as symbol
-        return std::string(1, c);
+    // Comments: skip and restart scanning for the next token
+    if (*p == '/' && end - p > 1) {
+      if (p[1] == '/') {
+        p = std::find(p + 2, end, '\n');
+        continue;
       }
-
-      if (d == '/') {
-        // Single-line comment: skip until end of line
-        while (m_file.get(c)) {
-          if (c == '\n')
-            break;
-        }
-        if (!m_file)
-          return std::nullopt;
-        continue; // restart scanning for next token
-      } else if (d == '*') {
-        // Block comment: skip until "*/"
-        char prev = 0;
-        while (m_file.get(c)) {
-          if (prev == '*' && c == '/')
-            break;
-          prev = c;
-        }
-        if (!m_file)
-          return std::nullopt;
-        continue; // restart scanning
-      } else {
-        // Not a comment: put back the second character and return '/' as symbol
-        m_file.unget();
-        return std::string(1, c);
+      if (p[1] == '*') {
+        static constexpr std::string_view kClose { "*/" };
+        p = std::search(p + 2, end, kClose.begin(), kClose.end());
+        p = (p == end) ? end : p + kClose.size();
+        continue;
       }
     }
 
-    // String constant: everything between double quotes (without quotes)
-    if (c == '"') {
-      std::string s;
-      while (m_file.get(c)) {
-        if (c == '"')
-          break;
-        s.push_back(c);
-      }
-      // If EOF is reached without closing quote, we still return what we have.
-      return s;
+    // String constant: everything between double quotes (without quotes).
+    // If EOF is reached without closing quote, we still return what we have.
+    if (*p == '"') {
+      const char* const first { ++p };
+      p = std::find(first, end, '"');
+      const std::string_view text(first, static_cast<std::size_t>(p - first));
+      m_cursor = (p == end) ? end : p + 1;
+      return Lexeme { text, Token::StringConst };
     }
 
     // Single-character symbol
-    if (isSymbolChar(c)) {
-      return std::string(1, c);
+    if (isSymbolChar(*p)) {
+      m_cursor = p + 1;
+      return Lexeme { std::string_view(p, 1), Token::Symbol, Keyword{}, *p };
     }
 
-    // Identifier or integer: accumulate until whitespace, symbol, quote, or '/'
-    std::string token;
-    token.push_back(c);
+    // Identifier or integer: runs until whitespace, symbol (including '/') or quote
+    const char* const first { p };
+    while (p != end && !isSpace(*p) && !isSymbolChar(*p) && *p != '"')
+      ++p;
 
-    while (m_file.get(c)) {
-      if (std::isspace(static_cast<unsigned char>(c)) || isSymbolChar(c) || c == '"' || c == '/') {
-        // Put back the delimiter so it will be processed on the next call
-        m_file.unget();
-        break;
-      }
-      token.push_back(c);
-    }
-
-    return token;
+    m_cursor = p;
+    return classifyWord(std::string_view(first, static_cast<std::size_t>(p - first)));
   }
 }
@@ -5,8 +5,10 @@
 #pragma once
 
 #include "../Utils/keyword.h"
+#include "../../../Common/mappedFile.h"
 #include "../Utils/tokenType.h"
 #include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <string_view>
 #include <optional>
@@ -15,79 +17,65 @@
 /**
  * @brief Lexical analyzer that reads a Jack source file and exposes tokens
  *        one at a time with simple lookahead support.
+ *
+ * The whole source is held in memory (memory-mapped when constructed from a
+ * path) and scanned with pointer arithmetic. Each token is a view into that
+ * text, classified once when it is scanned.
  */
 class Tokenizer {
   private:
-    std::ifstream& m_file;
-    std::string m_currentToken;
-    std::optional<std::string> m_lookaheadBuff;
-    
     /**
-     * @brief Low-level scanner: read the next raw token from the input stream.
+     * @brief A scanned token: its text (quotes stripped for strings), its category,
+     *        and the decoded value for keywords, symbols and integers.
+     */
+    struct Lexeme {
+      std::string_view text;
+      Token            type {};
+      Keyword          keyword {};   /**< Only meaningful when `type` is `Token::Keyword`. */
+      char             symbol {};    /**< Only meaningful when `type` is `Token::Symbol`. */
+      uint32_t         intValue {};  /**< Only meaningful when `type` is `Token::IntConst`. */
+    };
+
+    std::optional<MappedFile> m_mapped;    /**< Source mapping for the path constructor. */
+    std::string    m_buffer;               /**< Source copy for the stream constructor. */
+    std::ifstream* m_file {};              /**< Stream passed to the stream constructor, if any. */
+    const char*    m_cursor {};            /**< Next unscanned character. */
+    const char*    m_end {};               /**< One past the last source character. */
+    Lexeme         m_currentToken {};
+    std::optional<Lexeme> m_lookaheadBuff;
+
+    /** @brief Point the scanner at `source` and load the first two tokens. */
+    void start(std::string_view source);
+
+    /**
+     * @brief Low-level scanner: read the next raw token from the source text.
      *        Handles skipping whitespace and comments, and splits symbols
      *        from identifiers/integers according to the Jack specification.
      */
-    std::optional<std::string> nextTokenFromStream();
-    
+    std::optional<Lexeme> nextTokenFromSource();
+
+    /** @brief Classify an identifier-like word as keyword, integer or identifier. */
+    Lexeme classifyWord(std::string_view word) const;
+
+    /** @brief Throw the accessor error `message` (kept out of line, off the hot path). */
+    [[noreturn]] static void wrongTokenType(const char* message);
+
     /** @brief Return true if the given text is a valid Jack integer constant. */
     bool isValidInteger(std::string_view token) const;
 
     /** @brief Return true if the given text is a valid Jack identifier name. */
     bool isValidIdentifier(std::string_view token) const;
     
-    /** @brief Lookup table mapping keyword strings to `Keyword` enum values. */
-    inline static constexpr std::pair<std::string_view, Keyword> table[] = {
-      { "class",       Keyword::Class },
-      { "constructor", Keyword::Constructor },
-      { "function",    Keyword::Function },
-      { "method",      Keyword::Method },
-      { "field",       Keyword::Field },
-      { "static",      Keyword::Static },
-      { "var",         Keyword::Var },
-      { "int",         Keyword::Int },
-      { "char",        Keyword::Char },
-      { "boolean",     Keyword::Boolean },
-      { "void",        Keyword::Void },
-      { "true",        Keyword::True },
-      { "false",       Keyword::False },
-      { "null",        Keyword::Null },
-      { "this",        Keyword::This },
-      { "let",         Keyword::Let },
-      { "do",          Keyword::Do },
-      { "if",          Keyword::If },
-      { "else",        Keyword::Else },
-      { "while",       Keyword::While },
-      { "return",      Keyword::Return },
-    };
-  
-  /** @brief Set of all single-character Jack symbol tokens. */
-  inline static constexpr std::string_view kSymbols[] = {
-    "{","}","(",")","[","]",".",",",";",
-    "+","-","*","/","&","|","<",">","=","~"
-  };
-   
-  /** @brief Check whether the given string matches a Jack symbol. */
-  constexpr bool lookUpKeySymbols(std::string_view keySymbol) const {
-    for (auto symbol : kSymbols) {
-      if (symbol == keySymbol)
-        return true;
-    }
-    return false;
-  }
-  
-
-    /** @brief Look up the `Keyword` enum value for a given keyword string. */
-    constexpr std::optional<Keyword> lookUpKeyWord(std::string_view keyword) const {
-      for (const auto& [key, keywrd] : table) {
-        if (key == keyword)
-          return keywrd;
-      }
-      return std::nullopt;
-  }
-
   public:
+    /**
+     * @brief Construct a tokenizer over a memory-mapped Jack source file.
+     * @param path Path to a `.jack` file.
+     */
+    explicit Tokenizer(const std::filesystem::path& path);
+
     /**
      * @brief Construct a tokenizer for the given input stream.
+     *        The remaining stream contents are read into memory in one go.
      * @param file Open input stream positioned at the start of a Jack file.
      */
     Tokenizer(std::ifstream& file);
@@ -95,19 +83,27 @@ class Tokenizer {
     Tokenizer& operator=(const Tokenizer&) = delete;
 
     /** @brief Check whether more tokens are available in the input stream. */
-    bool hasMoreTokens() const;
+    bool hasMoreTokens() const { return m_lookaheadBuff.has_value(); }
 
     /** @brief Advance to the next token in the input stream. */
     void advance();
 
     /** @brief Get the type of the current token. */
-    Token tokenType() const;
+    Token tokenType() const { return m_currentToken.type; }
 
     /** @brief Interpret the current token as a keyword (only valid for keyword tokens). */
-    Keyword keyWord() const;
+    Keyword keyWord() const {
+      if (m_currentToken.type != Token::Keyword)
+        wrongTokenType("[ERROR] keyword() called on non-keyword token\n");
+      return m_currentToken.keyword;
+    }
 
     /** @brief Interpret the current token as a symbol character. */
-    char symbol() const;
+    char symbol() const {
+      if (m_currentToken.type != Token::Symbol)
+        wrongTokenType("[ERROR] symbol() should only be called on tokenType is Symbol\n");
+      return m_currentToken.symbol;
+    }
 
     /** @brief Interpret the current token as an identifier string. */
     std::string identifier() const;
@@ -119,11 +115,25 @@ class Tokenizer {
     std::string stringVal() const;
 
     /** @brief Get a view of the raw current token text. */
-    std::string_view getCurrentToken() const;
+    std::string_view getCurrentToken() const { return m_currentToken.text; }
 
     /** @brief Peek at the raw text of the next token without consuming it. */
     std::string_view getNextToken() const;
 
-    /** @brief Close the underlying file stream when tokenization is complete. */
+    /**
+     * @brief Consume the body of a `{ ... }` block as raw text instead of tokens.
+     *
+     * Used for code in another language, such as the VM commands of a `vm`
+     * block. The body runs up to the first `}` that is not inside a `//`
+     * comment; afterwards that `}` is the current token.
+     * @return A view of the text between the braces.
+     * @throws std::runtime_error if the current token is not `{` or the block is not closed.
+     */
+    std::string_view rawBlock();
+
+    /**
+     * @brief Close the underlying file stream when tokenization is complete.
+     *        A mapped file stays mapped until destruction, since tokens view into it.
+     */
     void close();
 };
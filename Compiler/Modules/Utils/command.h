@@ -3,6 +3,10 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
 enum class Command {
   Add,
   Sub,
@@ -14,3 +18,12 @@ enum class Command {
   Or,
   Not
 };
+
+/** @brief The arithmetic command written `name` in VM code, if there is one. */
+inline std::optional<Command> commandNamed(std::string_view name) {
+  constexpr std::string_view kNames[] { "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not" };
+  for (std::size_t i{}; i < std::size(kNames); ++i)
+    if (kNames[i] == name)
+      return static_cast<Command>(i);
+  return std::nullopt;
+}
@@ -0,0 +1,64 @@
+/** @file
+ *  @brief Switches for the optional optimizations between parsing and VM emission.
+ */
+#pragma once
+
+/**
+ * @brief Optimization settings shared by `CompilerAnalyzer`, `CompilationEngine` and `CodeGenerator`.
+ *
+ * New switches must also be added to the build-cache fingerprint in
+ * `compilerAnalyzer.cpp`, so cached outputs built with other settings are not reused.
+ */
+struct CompilerOptions {
+  /**
+   * @brief Evaluate operators on constant operands at compile time (with
+   *        16-bit wraparound) and simplify identities such as `x+0`, `x*1`
+   *        and `~~x`.
+   */
+  bool foldConstants { true };
+
+  /**
+   * @brief Replace `Math.multiply` / `Math.divide` calls that have a constant
+   *        operand with inline doubling or bit-extraction code when the cost
+   *        model rates it cheaper.
+   */
+  bool strengthReduction { true };
+
+  /**
+   * @brief Branch on the inverted condition of an `if` instead of jumping
+   *        over a `goto`, and rotate `while` loops to test at the bottom.
+   *        Applies to conditions known to be true (-1) or false (0).
+   */
+  bool compactBranches { true };
+
+  /**
+   * @brief Build each distinct string literal of a class once, on first use,
+   *        and push the same `String` object every time it is evaluated.
+   *        Pooled strings are shared, so they must not be changed or disposed.
+   */
+  bool stringPool { true };
+
+  /**
+   * @brief Drop statements that cannot run (after a `return`, behind a
+   *        constant `if`/`while` condition) and, in project builds, functions
+   *        that no class calls, warning about each removal.
+   */
+  bool deadCodeElimination { true };
+
+  /**
+   * @brief Emit `Memory.peek` / `Memory.poke` as `pointer 1` / `that 0`
+   *        accesses and `Math.abs` / `Math.min` / `Math.max` as branch-free
+   *        stack code instead of calls. `min`/`max` compare with `lt`/`gt`,
+   *        as the Jack OS does.
+   */
+  bool intrinsics { true };
+
+  /**
+   * @brief Emit `do` calls as `call-void` and `return;` as `return-void`
+   *        instead of `pop temp 0` and `push constant 0; return`. The
+   *        translator then passes no value between void functions and their
+   *        callers. Off by default: standard VM tools do not know these
+   *        commands.
+   */
+  bool voidCalls { false };
+};
@@ -9,6 +9,12 @@
 #include <string>
 #include <type_traits>
 
+/**
+ * @brief Whether `log()` echoes to stderr on this thread. Project builds turn
+ *        it off in worker threads and report the errors in file order instead.
+ */
+inline thread_local bool logToStderr { true };
+
 /**
  * @brief Log an error message to stderr and throw an exception of the given type.
  * @tparam Exception Exception type deriving from `std::exception`.
@@ -18,6 +24,7 @@ template <typename Exception>
 inline void log(std::string_view msg) {
   static_assert(std::is_base_of_v<std::exception, Exception>, "Must pass a Exception");
 
-  std::cerr << "[ERROR] " << msg << '\n';
+  if (logToStderr)
+    std::cerr << "[ERROR] " << msg << '\n';
   throw Exception(std::string(msg));
 }
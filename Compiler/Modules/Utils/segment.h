@@ -3,6 +3,10 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
 enum class Segment {
   Constant,
   Argument,
@@ -13,3 +17,14 @@ enum class Segment {
   Pointer,
   Temp,
 };
+
+/** @brief Names of the segments in VM code, in enum order. */
+inline constexpr std::string_view kSegmentNames[] { "constant", "argument", "local", "static", "this", "that", "pointer", "temp" };
+
+/** @brief The segment written `name` in VM code, if there is one. */
+inline std::optional<Segment> segmentNamed(std::string_view name) {
+  for (std::size_t i{}; i < std::size(kSegmentNames); ++i)
+    if (kSegmentNames[i] == name)
+      return static_cast<Segment>(i);
+  return std::nullopt;
+}
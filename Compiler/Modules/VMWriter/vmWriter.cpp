@@ -5,48 +5,123 @@
 #include <string_view>
 #include "../Utils/segment.h"
 #include "../Utils/command.h"
+#include "../../../Common/vmbFormat.h"
 
-VmWriter::VmWriter(std::ofstream& vmFile)
+VmWriter::VmWriter(std::ofstream& vmFile, VmFormat format)
  : m_vmFile(vmFile)
+ , m_format(format)
 {
   if (!m_vmFile.is_open())
     throw std::runtime_error("[ERROR] VM file is not open");
 }
 
+uint32_t VmWriter::internString(std::string_view name) {
+  const auto [it, inserted] = m_stringIds.try_emplace(std::string(name), static_cast<uint32_t>(m_strings.size()));
+  if (inserted)
+    m_strings.emplace_back(name);
+  return it->second;
+}
+
+void VmWriter::encode(uint8_t opcode) {
+  m_code.push_back(static_cast<char>(opcode));
+  ++m_commandCount;
+}
+
+void VmWriter::encode(uint8_t opcode, uint32_t operand) {
+  encode(opcode);
+  vmb::appendVarint(m_code, operand);
+}
+
+void VmWriter::encode(uint8_t opcode, uint32_t operand1, uint32_t operand2) {
+  encode(opcode, operand1);
+  vmb::appendVarint(m_code, operand2);
+}
+
 void VmWriter::writePush(Segment segment, uint32_t idx) {
+  if (m_format == VmFormat::Binary)
+    return encode(static_cast<uint8_t>(vmb::kOpPush + static_cast<uint8_t>(segment)), idx);
   m_vmFile << "push " << segmentToStr(segment) << " " << idx << "\n";
 }
 
 void VmWriter::writePop(Segment segment, uint32_t idx) {
+  if (m_format == VmFormat::Binary)
+    return encode(static_cast<uint8_t>(vmb::kOpPop + static_cast<uint8_t>(segment)), idx);
   m_vmFile << "pop " << segmentToStr(segment) << " " << idx << "\n";
 }
 
 void VmWriter::writeArithmetic(Command cmd) {
+  if (m_format == VmFormat::Binary)
+    return encode(static_cast<uint8_t>(vmb::kOpAdd + static_cast<uint8_t>(cmd)));
   m_vmFile << cmdToStr(cmd) << '\n';
 }
 
 void VmWriter::writeLabel(std::string_view label) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpLabel, internString(label));
   m_vmFile << "label " << label << '\n';
 }
 
 void VmWriter::writeGoto(std::string_view label) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpGoto, internString(label));
   m_vmFile << "goto " << label << '\n';
 }
 
 void VmWriter::writeIf(std::string_view label) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpIfGoto, internString(label));
   m_vmFile << "if-goto " << label << '\n';
 }
 
 void VmWriter::writeCall(std::string_view fnName, uint32_t nArgs) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpCall, internString(fnName), nArgs);
   m_vmFile << "call " << fnName << " " << nArgs << '\n';
 }
 
+void VmWriter::writeCallVoid(std::string_view fnName, uint32_t nArgs) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpCallVoid, internString(fnName), nArgs);
+  m_vmFile << "call-void " << fnName << " " << nArgs << '\n';
+}
+
 void VmWriter::writeFunction(std::string_view fnName, uint32_t nArgs) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpFunction, internString(fnName), nArgs);
   m_vmFile << "function " << fnName << " " << nArgs << '\n';
 }
 
 void VmWriter::writeReturn() {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpReturn);
   m_vmFile << "return" << '\n';
 }
 
-void VmWriter::close() { m_vmFile.close(); }
+void VmWriter::writeReturnVoid() {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpReturnVoid);
+  m_vmFile << "return-void" << '\n';
+}
+
+void VmWriter::writeAsm(std::string_view instruction) {
+  if (m_format == VmFormat::Binary)
+    return encode(vmb::kOpAsm, internString(instruction));
+  m_vmFile << "asm " << instruction << '\n';
+}
+
+void VmWriter::close() {
+  if (m_format == VmFormat::Binary && m_vmFile.is_open()) {
+    std::string header(vmb::kMagic, sizeof(vmb::kMagic));
+    header.push_back(static_cast<char>(vmb::kVersion));
+    vmb::appendVarint(header, static_cast<uint32_t>(m_strings.size()));
+    for (const std::string& name : m_strings) {
+      vmb::appendVarint(header, static_cast<uint32_t>(name.size()));
+      header += name;
+    }
+    vmb::appendVarint(header, m_commandCount);
+
+    m_vmFile.write(header.data(), static_cast<std::streamsize>(header.size()));
+    m_vmFile.write(m_code.data(), static_cast<std::streamsize>(m_code.size()));
+  }
+  m_vmFile.close();
+}
@@ -5,10 +5,19 @@
 
 #include <cstdint>
 #include <fstream>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "../Utils/segment.h"
 #include "../Utils/command.h"
 
+/** @brief Output format of a `VmWriter`. */
+enum class VmFormat {
+  Text,   /**< One command per line (`.vm`). */
+  Binary, /**< Opcode bytes, varints and a string table (`.vmb`, see `vmbFormat.h`). */
+};
+
 /**
  * @brief Convenience wrapper that emits well-formed Nand2Tetris VM commands
  *        to a backing output stream.
@@ -16,6 +25,23 @@
 class VmWriter {
   private:
     std::ofstream& m_vmFile;
+    VmFormat m_format;
+
+    /** @brief Binary mode: encoded commands, written after the string table on close(). */
+    std::string m_code;
+    /** @brief Binary mode: number of commands in `m_code`. */
+    uint32_t m_commandCount{};
+    /** @brief Binary mode: string table in order of first use. */
+    std::vector<std::string> m_strings;
+    std::unordered_map<std::string, uint32_t> m_stringIds;
+
+    /** @brief Binary mode: id of `name` in the string table, adding it on first use. */
+    uint32_t internString(std::string_view name);
+
+    /** @brief Binary mode: appends one command with up to two varint operands. */
+    void encode(uint8_t opcode);
+    void encode(uint8_t opcode, uint32_t operand);
+    void encode(uint8_t opcode, uint32_t operand1, uint32_t operand2);
 
     /** @brief Convert a VM segment enum to its textual name. */
     std::string segmentToStr(Segment segment) {
@@ -51,9 +77,10 @@ class VmWriter {
   public:
     /**
      * @brief Construct a VM writer bound to the given output file stream.
-     * @param vmFile Open output stream for writing VM commands.
+     * @param vmFile Open output stream for writing VM commands (opened in binary mode for `VmFormat::Binary`).
+     * @param format Text `.vm` lines, or the binary `.vmb` format, which is only complete after close().
      */
-    VmWriter(std::ofstream& vmFile);
+    VmWriter(std::ofstream& vmFile, VmFormat format = VmFormat::Text);
     VmWriter& operator=(VmWriter&) = delete;
     VmWriter(VmWriter&) = delete;
 
@@ -77,6 +104,9 @@ class VmWriter {
 
     /** @brief Emit a `call name nArgs` command. */
     void writeCall(std::string_view name, uint32_t nArgs);
+
+    /** @brief Emit a `call-void name nArgs` command: a call whose result is discarded. */
+    void writeCallVoid(std::string_view name, uint32_t nArgs);
     
     /** @brief Emit a `function name nLocals` declaration. */
     void writeFunction(std::string_view name, uint32_t nArgs);
@@ -84,6 +114,12 @@ class VmWriter {
     /** @brief Emit a `return` command. */
     void writeReturn();
 
-    /** @brief Close the underlying VM output stream. */
+    /** @brief Emit a `return-void` command: a return that hands 0 to callers that want a value. */
+    void writeReturnVoid();
+
+    /** @brief Emit an `asm instruction` command, which the translator copies into its output. */
+    void writeAsm(std::string_view instruction);
+
+    /** @brief Close the underlying VM output stream; in binary mode, write the file first. */
     void close();
 };
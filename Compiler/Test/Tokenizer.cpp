@@ -280,3 +280,88 @@ TEST_F(TokenizerTestObject, Tokenizer_StringVal_ThrowsWhenNotString) {
   // NOTE: add a positive stringVal test later when your tokenizer lexes quoted strings as one token.
 }
 
+
+/** @test
+ *  @brief The memory-mapped tokenizer yields the same tokens as the stream one,
+ *         and classifies quoted text as a string even when it looks like a name.
+ */
+TEST_F(TokenizerTestObject, Tokenizer_MappedFile_MatchesStream) {
+  ASSERT_TRUE(tokenizer);
+
+  Tokenizer mapped(filepath);
+  std::size_t tokens = 0;
+  while (true) {
+    ++tokens;
+    EXPECT_EQ(mapped.getCurrentToken(), tokenizer->getCurrentToken());
+    EXPECT_EQ(mapped.tokenType(), tokenizer->tokenType());
+    if (!tokenizer->hasMoreTokens())
+      break;
+    ASSERT_TRUE(mapped.hasMoreTokens());
+    mapped.advance();
+    tokenizer->advance();
+  }
+  EXPECT_FALSE(mapped.hasMoreTokens());
+  EXPECT_GT(tokens, 100u);
+
+  const auto source = std::filesystem::temp_directory_path() / "tmp_strings.jack";
+  std::ofstream(source) << "do Output.printString(\"hello\"); /* unterminated";
+  Tokenizer strings(source);
+  while (strings.getCurrentToken() != "(")
+    strings.advance();
+  strings.advance();
+  EXPECT_EQ(strings.tokenType(), Token::StringConst);
+  EXPECT_EQ(strings.stringVal(), "hello");
+  strings.advance();
+  EXPECT_EQ(strings.symbol(), ')');
+  strings.advance();
+  EXPECT_EQ(strings.symbol(), ';');
+  EXPECT_FALSE(strings.hasMoreTokens());
+  std::filesystem::remove(source);
+}
+
+/** @test
+ *  @brief Every keyword is recognized by the hashed lookup, while words that
+ *         share a keyword's hash inputs (prefix and length) stay identifiers.
+ */
+TEST_F(TokenizerTestObject, Tokenizer_KeywordLookup_RejectsNearMisses) {
+  const auto source = std::filesystem::temp_directory_path() / "tmp_keywords.jack";
+  std::ofstream(source) << "class constructor function method field static var int char boolean void "
+                           "true false null this let do if else while return "
+                           "clasp vat int0 done iff whale _class Class 12 x";
+  Tokenizer words(source);
+
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(words.tokenType(), Token::Keyword) << words.getCurrentToken();
+    words.advance();
+  }
+  EXPECT_EQ(words.keyWord(), Keyword::Return);
+  while (words.hasMoreTokens()) {
+    words.advance();
+    if (words.getCurrentToken() == "12")
+      EXPECT_EQ(words.intVal(), 12u);
+    else
+      EXPECT_EQ(words.tokenType(), Token::Identifier) << words.getCurrentToken();
+  }
+  std::filesystem::remove(source);
+}
+
+/** @test
+ *  @brief `rawBlock()` returns a block's text up to the first `}` outside a
+ *         comment and resumes tokenizing at that brace.
+ */
+TEST_F(TokenizerTestObject, Tokenizer_RawBlock_StopsAtClosingBrace) {
+  const auto source = std::filesystem::temp_directory_path() / "tmp_raw.jack";
+  std::ofstream(source) << "vm { push x // }\n pop y } return";
+  Tokenizer raw(source);
+
+  raw.advance();
+  EXPECT_EQ(raw.rawBlock(), " push x // }\n pop y ");
+  EXPECT_EQ(raw.symbol(), '}');
+  raw.advance();
+  EXPECT_EQ(raw.keyWord(), Keyword::Return);
+
+  std::ofstream(source) << "{ push x";
+  Tokenizer open(source);
+  EXPECT_THROW(open.rawBlock(), std::runtime_error);
+  std::filesystem::remove(source);
+}
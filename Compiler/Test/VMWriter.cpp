@@ -122,3 +122,58 @@ TEST_F(VmWriter_F, can_write_return) {
 
   ASSERT_EQ(res, expected);
 }
+
+TEST_F(VmWriter_F, can_write_void_call_and_return) {
+  vmWriter->writeCallVoid("Output.println", 0);
+  vmWriter->writeReturnVoid();
+
+  vmWriter->close();
+  std::string res { fetchFileContent() };
+  std::string expected { "call-void Output.println 0\nreturn-void\n" };
+
+  ASSERT_EQ(res, expected);
+}
+
+TEST_F(VmWriter_F, can_write_asm) {
+  vmWriter->writeAsm("@SCREEN");
+  vmWriter->writeAsm("M=-1");
+
+  vmWriter->close();
+  std::string res { fetchFileContent() };
+  std::string expected { "asm @SCREEN\nasm M=-1\n" };
+
+  ASSERT_EQ(res, expected);
+}
+
+TEST_F(VmWriter_F, can_write_binary_format) {
+  std::filesystem::path binPath = std::filesystem::temp_directory_path() / "test.vmb";
+  {
+    std::ofstream binFile(binPath, std::ios::out | std::ios::binary);
+    VmWriter binWriter(binFile, VmFormat::Binary);
+    binWriter.writeFunction("Main.main", 1);
+    binWriter.writePush(Segment::Constant, 300);
+    binWriter.writePop(Segment::Local, 0);
+    binWriter.writeLabel("Main.main$L");
+    binWriter.writeArithmetic(Command::Not);
+    binWriter.writeGoto("Main.main$L");
+    binWriter.writeCall("Main.main", 0);
+    binWriter.writeCallVoid("Main.main", 0);
+    binWriter.writeReturn();
+    binWriter.writeReturnVoid();
+    binWriter.writeAsm("D=M");
+    binWriter.close();
+  }
+
+  std::ifstream input(binPath, std::ios::binary);
+  std::stringstream buff;
+  buff << input.rdbuf();
+  std::filesystem::remove(binPath);
+
+  // Names are stored once; 300 takes two varint bytes.
+  const std::string expected =
+    std::string("VMB\x03", 4) + "\x03" + "\x09Main.main" + "\x0bMain.main$L" + "\x03" "D=M" + "\x0b" +
+    std::string("\x23\x00\x01", 3) + "\x10\xac\x02" + std::string("\x1a\x00", 2) + "\x20\x01" +
+    "\x08" + "\x21\x01" + std::string("\x24\x00\x00", 3) + std::string("\x26\x00\x00", 3) + "\x25" + "\x27" + "\x28\x02";
+
+  ASSERT_EQ(buff.str(), expected);
+}
@@ -0,0 +1,212 @@
+/** @file
+ *  @brief GoogleTest harness for the control-flow shapes emitted by `CodeGenerator`.
+ */
+
+#include "gtest/gtest.h"
+#include <string>
+#include "../Modules/Utils/compilerOptions.h"
+#include "compileFixture.h"
+
+using namespace testing;
+
+class CodeGeneratorTestObject : public CompileTestObject {};
+
+/** @test
+ *  @brief Boolean `if` conditions branch straight to the false label; `=`
+ *         is tested with `sub` and `~` flips the branch sense.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_IfBranchesOnInvertedCondition) {
+  EXPECT_EQ(compileBody("if (x = 1) { return 1; } return 0;"),
+            "push argument 0\npush constant 1\nsub\n"
+            "if-goto Main.f$IF_FALSE0\n"
+            "push constant 1\nreturn\n"
+            "label Main.f$IF_FALSE0\n"
+            "push constant 0\nreturn\n");
+
+  EXPECT_EQ(compileBody("if (~(x < 1)) { return 1; } return 0;"),
+            "push argument 0\npush constant 1\nlt\n"
+            "if-goto Main.f$IF_FALSE0\n"
+            "push constant 1\nreturn\n"
+            "label Main.f$IF_FALSE0\n"
+            "push constant 0\nreturn\n");
+
+  EXPECT_EQ(compileBody("if ((x > 1) & (x < 9)) { return 1; } else { return 2; }"),
+            "push argument 0\npush constant 1\ngt\npush argument 0\npush constant 9\nlt\nand\nnot\n"
+            "if-goto Main.f$IF_FALSE0\n"
+            "push constant 1\nreturn\n"
+            "goto Main.f$IF_END0\n"
+            "label Main.f$IF_FALSE0\n"
+            "push constant 2\nreturn\n"
+            "label Main.f$IF_END0\n");
+}
+
+/** @test
+ *  @brief Conditions that may be any non-zero value keep the `if-goto IF_TRUE`
+ *         form, which treats every non-zero value as true.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_IfKeepsTruthinessOfIntegers) {
+  EXPECT_EQ(compileBody("if (x) { return 1; } return 0;"),
+            "push argument 0\n"
+            "if-goto Main.f$IF_TRUE0\n"
+            "goto Main.f$IF_FALSE0\n"
+            "label Main.f$IF_TRUE0\n"
+            "push constant 1\nreturn\n"
+            "label Main.f$IF_FALSE0\n"
+            "push constant 0\nreturn\n");
+}
+
+/** @test
+ *  @brief Loops are entered with one jump to the test at the bottom, which
+ *         branches back to the body.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_WhileTestsAtBottom) {
+  EXPECT_EQ(compileBody("while (x < 10) { let x = x + 1; } return x;"),
+            "goto Main.f$WHILE_EXP0\n"
+            "label Main.f$WHILE_BODY0\n"
+            "push argument 0\npush constant 1\nadd\npop argument 0\n"
+            "label Main.f$WHILE_EXP0\n"
+            "push argument 0\npush constant 10\nlt\n"
+            "if-goto Main.f$WHILE_BODY0\n"
+            "push argument 0\nreturn\n");
+
+  CompilerOptions options;
+  options.compactBranches = false;
+  EXPECT_EQ(compileBody("while (x < 10) { let x = x + 1; } return x;", options),
+            "label Main.f$WHILE_EXP0\n"
+            "push argument 0\npush constant 10\nlt\nnot\n"
+            "if-goto Main.f$WHILE_END0\n"
+            "push argument 0\npush constant 1\nadd\npop argument 0\n"
+            "goto Main.f$WHILE_EXP0\n"
+            "label Main.f$WHILE_END0\n"
+            "push argument 0\nreturn\n");
+}
+
+/** @test
+ *  @brief Each distinct literal is built once by `Main.$strings` and stored
+ *         in the static after the declared ones; uses push the shared object.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_StringLiteralsArePooled) {
+  const std::string readyCheck = "push static 0\n"
+                                 "if-goto Main.f$STRINGS_READY";
+  const std::string buildPool  = "call Main.$strings 0\npop temp 0\n";
+
+  EXPECT_EQ(compileBody("do Output.printString(\"ab\"); do Output.printString(\"c\");"
+                        " do Output.printString(\"ab\"); return 0;"),
+            readyCheck + "0\n" + buildPool + "label Main.f$STRINGS_READY0\n"
+            "push static 0\npop pointer 1\npush that 0\n"
+            "call Output.printString 1\npop temp 0\n" +
+            readyCheck + "1\n" + buildPool + "label Main.f$STRINGS_READY1\n"
+            "push static 0\npush constant 1\nadd\npop pointer 1\npush that 0\n"
+            "call Output.printString 1\npop temp 0\n" +
+            readyCheck + "2\n" + buildPool + "label Main.f$STRINGS_READY2\n"
+            "push static 0\npop pointer 1\npush that 0\n"
+            "call Output.printString 1\npop temp 0\n"
+            "push constant 0\nreturn\n"
+            "function Main.$strings 0\n"
+            "push constant 2\ncall Array.new 1\npop static 0\n"
+            "push static 0\n"
+            "push constant 2\ncall String.new 1\n"
+            "push constant 97\ncall String.appendChar 2\npush constant 98\ncall String.appendChar 2\n"
+            "pop temp 0\npop pointer 1\npush temp 0\npop that 0\n"
+            "push static 0\npush constant 1\nadd\n"
+            "push constant 1\ncall String.new 1\npush constant 99\ncall String.appendChar 2\n"
+            "pop temp 0\npop pointer 1\npush temp 0\npop that 0\n"
+            "push constant 0\nreturn\n");
+
+  CompilerOptions options;
+  options.stringPool = false;
+  EXPECT_EQ(compileBody("do Output.printString(\"c\"); return 0;", options),
+            "push constant 1\ncall String.new 1\npush constant 99\ncall String.appendChar 2\n"
+            "call Output.printString 1\npop temp 0\n"
+            "push constant 0\nreturn\n");
+}
+
+/** @test
+ *  @brief `Memory.peek/poke` become `that 0` accesses and `Math.abs/min/max`
+ *         branch-free stack code; operands other than variables and
+ *         constants are evaluated once, in order, and spilled to temps.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_InlinesIntrinsics) {
+  EXPECT_EQ(compileBody("do Memory.poke(x + 1, Memory.peek(x)); return 0;"),
+            "push argument 0\npush constant 1\nadd\n"
+            "push argument 0\npop pointer 1\npush that 0\n"
+            "pop temp 0\npop pointer 1\npush temp 0\npop that 0\n"
+            "push constant 0\nreturn\n");
+
+  EXPECT_EQ(compileBody("do Memory.poke(16384, x); return Math.abs(x);"),
+            "push constant 16384\npop pointer 1\npush argument 0\npop that 0\n"
+            "push argument 0\npush argument 0\npush constant 0\nlt\n"
+            "push argument 0\npush argument 0\nadd\nneg\n"
+            "and\nadd\nreturn\n");
+
+  EXPECT_EQ(compileBody("return Math.min(x, 7);"),
+            "push constant 7\npush argument 0\npush constant 7\nsub\n"
+            "push argument 0\npush constant 7\nlt\n"
+            "and\nadd\nreturn\n");
+
+  // The call could change `x`, so `x` is read before it, as written.
+  EXPECT_EQ(compileBody("return Math.min(x, Main.f(x));"),
+            "push argument 0\npush argument 0\ncall Main.f 1\npop temp 2\npop temp 1\n"
+            "push temp 2\npush temp 1\npush temp 2\nsub\n"
+            "push temp 1\npush temp 2\nlt\n"
+            "and\nadd\nreturn\n");
+
+  EXPECT_EQ(compileBody("return Math.max(Main.f(x), 3);"),
+            "push argument 0\ncall Main.f 1\npop temp 1\n"
+            "push constant 3\npush temp 1\npush constant 3\nsub\n"
+            "push temp 1\npush constant 3\ngt\n"
+            "and\nadd\nreturn\n");
+
+  CompilerOptions options;
+  options.intrinsics = false;
+  EXPECT_EQ(compileBody("return Math.abs(x);", options),
+            "push argument 0\ncall Math.abs 1\nreturn\n");
+}
+
+/** @test
+ *  @brief With `voidCalls` on, `do` discards the result with `call-void` and
+ *         `return;` becomes `return-void`; by default both keep the standard form.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_EmitsVoidCallsAndReturns) {
+  EXPECT_EQ(compileBody("do Main.f(x); return;"),
+            "push argument 0\ncall Main.f 1\npop temp 0\npush constant 0\nreturn\n");
+
+  CompilerOptions options;
+  options.voidCalls = true;
+  EXPECT_EQ(compileBody("do Main.f(x); return;", options),
+            "push argument 0\ncall-void Main.f 1\nreturn-void\n");
+}
+
+/** @test
+ *  @brief `vm` blocks resolve variable names and keep their labels to the
+ *         block; `asm` blocks become `asm` commands addressing statics by name.
+ */
+TEST_F(CodeGeneratorTestObject, CodeGenerator_EmitsInlineBlocks) {
+  CompilerOptions voidCalls;
+  voidCalls.voidCalls = true;
+  EXPECT_EQ(compileBody("var int n; vm {\n"
+                        "  push x            // count down\n"
+                        "  label LOOP\n"
+                        "  push constant 1\n  sub\n  pop n\n"
+                        "  push n\n  push n\n  if-goto LOOP\n"
+                        "  call-void Main.f 1\n"
+                        "} vm { label LOOP } return n;", voidCalls),
+            "push argument 0\n"
+            "label Main.f$VM0.LOOP\n"
+            "push constant 1\nsub\npop local 0\n"
+            "push local 0\npush local 0\nif-goto Main.f$VM0.LOOP\n"
+            "call-void Main.f 1\n"
+            "label Main.f$VM1.LOOP\n"
+            "push local 0\nreturn\n");
+
+  EXPECT_EQ(compileBody("vm { push x\n call-void Main.f 1 } return 0;"),
+            "push argument 0\ncall Main.f 1\npop temp 0\n"
+            "push constant 0\nreturn\n");
+
+  EXPECT_EQ(compileClass("class Main { static int s; function void f() {\n"
+                         "  asm { (LOOP)\n @ s\n M = M+1 ; JMP\n @LOOP\n @SCREEN }\n return; } }\n"),
+            "function Main.f 0\n"
+            "asm (Main.f$ASM0.LOOP)\nasm @Main.0\nasm M=M+1;JMP\n"
+            "asm @Main.f$ASM0.LOOP\nasm @SCREEN\n"
+            "push constant 0\nreturn\n");
+}
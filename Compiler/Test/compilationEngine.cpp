@@ -219,3 +219,81 @@ TEST_F(CompilationEngineTestObject, CompilationEngine_ReportsErrorOnMissingSemic
   EXPECT_THROW(engine->compileClass(), std::runtime_error);
 }
 
+
+/** @test
+ *  @brief Rejects `vm` and `asm` blocks that name unknown variables or labels,
+ *         unbalance the stack, declare functions, or address a non-static
+ *         variable from assembly.
+ */
+TEST_F(CompilationEngineTestObject, CompilationEngine_ReportsErrorsInInlineBlocks) {
+  for (std::string_view block : { "vm { push y }", "vm { push x }", "vm { pop x }",
+                                  "vm { goto LOOP }", "vm { function Main.g 0 }",
+                                  "asm { @x }", "asm { D=Q }", "asm { DM=1 }", "asm { 0;JUMP }", "asm { @32768 }" }) {
+    rebuildWithSource({
+      "class Main {",
+      "  static int s;",
+      "  function void main ( ) {",
+      "    var int x ;",
+      block,
+      "    return ;",
+      "  }",
+      "}"
+    });
+
+    EXPECT_THROW(engine->compileClass(), std::runtime_error) << block;
+  }
+}
+
+/** @test
+ *  @brief Checks the tree `parseClass()` builds: variables resolved to
+ *         segments, left-to-right binary operators, and calls with receivers.
+ */
+TEST_F(CompilationEngineTestObject, CompilationEngine_BuildsResolvedAst) {
+  rebuildWithSource({
+    "class Main {",
+    "  field int a ;",
+    "  method int f ( int x ) {",
+    "    var Array arr ;",
+    "    let arr [ x ] = a + x * 2 ;",
+    "    if ( x ) { } else { }",
+    "    return f ( x - 1 ) ;",
+    "  }",
+    "}"
+  });
+
+  ASSERT_TRUE(engine);
+  ASSERT_NO_THROW(engine->parseClass());
+  const Ast& ast = engine->ast();
+
+  EXPECT_EQ(ast.className, "Main");
+  EXPECT_EQ(ast.fieldCount, 1u);
+  ASSERT_EQ(ast.subroutines.size(), 1u);
+  const Subroutine& f = ast.subroutines[0];
+  EXPECT_EQ(f.kind, SubroutineKind::Method);
+  EXPECT_EQ(f.returnType, "int");
+  EXPECT_EQ(f.nLocals, 1u);
+  ASSERT_EQ(f.body.count, 3u);
+
+  const Stmt& let = ast.stmt(ast.child(f.body, 0));
+  EXPECT_EQ(let.kind, StmtKind::Let);
+  EXPECT_EQ(let.segment, Segment::Local);
+  EXPECT_EQ(ast.expr(let.subscript).segment, Segment::Argument);
+  EXPECT_EQ(ast.expr(let.subscript).index, 1u);
+  const Expr& product = ast.expr(let.expr);
+  ASSERT_EQ(product.kind, ExprKind::Binary);
+  EXPECT_EQ(product.op, '*');
+  EXPECT_EQ(ast.expr(product.lhs).op, '+');
+  EXPECT_EQ(ast.expr(ast.expr(product.lhs).lhs).segment, Segment::This);
+
+  const Stmt& branch = ast.stmt(ast.child(f.body, 1));
+  EXPECT_EQ(branch.kind, StmtKind::If);
+  EXPECT_TRUE(branch.hasElse);
+  EXPECT_EQ(branch.body.count + branch.orElse.count, 0u);
+
+  const Expr& call = ast.expr(ast.stmt(ast.child(f.body, 2)).expr);
+  ASSERT_EQ(call.kind, ExprKind::Call);
+  EXPECT_EQ(ast.string(call.value), "Main.f");
+  EXPECT_TRUE(call.hasReceiver);
+  EXPECT_EQ(call.segment, Segment::Pointer);
+  EXPECT_EQ(call.args.count, 1u);
+}
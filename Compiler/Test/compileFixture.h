@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * @file compileFixture.h
+ * @brief Test fixture that compiles Jack source through a temporary file.
+ */
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#include "../Modules/CompilationEngine/compileEngine.h"
+#include "../Modules/Tokenizer/tokenizer.h"
+#include "../Modules/Utils/compilerOptions.h"
+#include "../Modules/VMWriter/vmWriter.h"
+
+/**
+ * @class CompileTestObject
+ * @brief Base fixture for tests that check the VM code of small Jack classes.
+ *
+ * The temporary files are named after the test, so tests run in parallel do
+ * not share them.
+ */
+class CompileTestObject : public ::testing::Test {
+  protected:
+    std::filesystem::path jackPath;
+    std::filesystem::path vmPath;
+    /** @brief Warnings of the last compilation. */
+    std::vector<std::string> warnings;
+
+    void SetUp() override {
+      const ::testing::TestInfo* test { ::testing::UnitTest::GetInstance()->current_test_info() };
+      const std::string stem { std::string(test->test_suite_name()) + "_" + test->name() };
+      jackPath = std::filesystem::temp_directory_path() / (stem + "_tmp.jack");
+      vmPath   = std::filesystem::temp_directory_path() / (stem + "_tmp.vm");
+    }
+
+    void TearDown() override {
+      std::filesystem::remove(jackPath);
+      std::filesystem::remove(vmPath);
+    }
+
+    /** @brief VM code of the class in `source`. */
+    std::string compileClass(const std::string& source, const std::set<std::string>* externalCalls = nullptr,
+                             const CompilerOptions& options = {}) {
+      std::ofstream(jackPath) << source;
+      {
+        std::ofstream output(vmPath);
+        Tokenizer tokenizer(jackPath);
+        VmWriter vmWriter(output);
+        CompilationEngine engine(tokenizer, vmWriter, options);
+        engine.compileClass(externalCalls);
+        warnings = engine.warnings();
+      }
+
+      std::ifstream vm(vmPath);
+      return std::string((std::istreambuf_iterator<char>(vm)), std::istreambuf_iterator<char>());
+    }
+
+    /** @brief VM code of `function int f(int x) { <body> }` in class Main, without the `function` line. */
+    std::string compileBody(const std::string& body, const CompilerOptions& options = {}) {
+      const std::string code = compileClass("class Main { function int f(int x) { " + body + " } }\n",
+                                            nullptr, options);
+      return code.substr(code.find('\n') + 1);
+    }
+};
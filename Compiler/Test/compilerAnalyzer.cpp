@@ -0,0 +1,229 @@
+/** @file
+ *  @brief GoogleTest harness for single-file and project-directory compilation.
+ */
+
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../Modules/BuildCache/buildCache.h"
+#include "../Modules/CompilerAnalyzer/compilerAnalyzer.h"
+
+using namespace testing;
+
+/**
+ * @brief Test fixture with a temporary project directory.
+ */
+class CompilerAnalyzerTestObject : public ::testing::Test {
+  protected:
+    std::filesystem::path dir;
+
+    void SetUp() override {
+      dir = std::filesystem::temp_directory_path() / "analyzer_tmp";
+      std::filesystem::remove_all(dir);
+      std::filesystem::create_directory(dir);
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(dir);
+    }
+
+    void write(const std::string& name, const std::string& content) const {
+      std::ofstream(dir / name) << content;
+    }
+
+    std::string read(const std::filesystem::path& path) const {
+      std::ifstream in(path);
+      return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    /** @brief A small class whose body depends on `n`, so outputs differ per class. */
+    static std::string jackClass(const std::string& name, int n) {
+      return "class " + name + " {\n"
+             "  field int x;\n"
+             "  constructor " + name + " new() { let x = " + std::to_string(n) + "; return this; }\n"
+             "  method int get(int y) { if (y < x) { return y * 16; } return x / 2; }\n"
+             "}\n";
+    }
+};
+
+/** @test
+ *  @brief Every class is compiled, each to the code a single-file run
+ *         produces, and results come back in sorted file order.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_ProjectMatchesSingleFileRuns) {
+  const std::vector<std::string> names { "Zeta", "Alpha", "Main", "Beta", "Gamma", "Delta" };
+  for (std::size_t i{}; i < names.size(); ++i)
+    write(names[i] + ".jack", jackClass(names[i], static_cast<int>(i)));
+  write("notes.txt", "not a class");
+
+  const std::vector<ClassResult> results = compileProject(dir, VmFormat::Text, {}, 4);
+
+  ASSERT_EQ(results.size(), names.size());
+  for (std::size_t i{}; i < results.size(); ++i) {
+    EXPECT_TRUE(results[i].error.empty()) << results[i].error;
+    if (i > 0) {
+      EXPECT_LT(results[i - 1].source, results[i].source);
+    }
+  }
+
+  for (const std::string& name : names) {
+    const std::filesystem::path vm = dir / (name + ".vm");
+    const std::string parallel = read(vm);
+    ASSERT_FALSE(parallel.empty()) << name;
+
+    CompilerAnalyzer analyzer(dir / (name + ".jack"));
+    analyzer.run();
+    EXPECT_EQ(read(vm), parallel) << name;
+  }
+}
+
+/** @test
+ *  @brief A failing class does not stop the others; its error is reported
+ *         against its file, in file order.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_ProjectCollectsErrorsInOrder) {
+  write("A.jack", jackClass("A", 1));
+  write("B.jack", "class B { function void f() { let = 1; } }\n");
+  write("C.jack", jackClass("C", 3));
+  write("D.jack", "class D { function void f() { return }\n");
+
+  const std::vector<ClassResult> results = compileProject(dir);
+
+  ASSERT_EQ(results.size(), 4u);
+  EXPECT_EQ(results[0].source.filename(), "A.jack");
+  EXPECT_TRUE(results[0].error.empty());
+  EXPECT_FALSE(results[1].error.empty());
+  EXPECT_TRUE(results[2].error.empty());
+  EXPECT_FALSE(results[3].error.empty());
+  EXPECT_TRUE(std::filesystem::exists(dir / "C.vm"));
+
+  EXPECT_THROW(compileProject(dir / "missing"), std::runtime_error);
+  std::filesystem::create_directory(dir / "empty");
+  EXPECT_THROW(compileProject(dir / "empty"), std::runtime_error);
+}
+
+/** @test
+ *  @brief Content hashes are 64-bit FNV-1a, byte by byte, so they match the
+ *         published test vectors on any host.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_HashesWithFnv1a) {
+  EXPECT_EQ(hashBytes(""), 0xcbf29ce484222325ull);
+  EXPECT_EQ(hashBytes("a"), 0xaf63dc4c8601ec8cull);
+  EXPECT_EQ(hashBytes("foobar"), 0x85944171f73967e8ull);
+}
+
+/** @test
+ *  @brief With the build cache only edited classes, classes whose output is
+ *         gone, and callers of a changed interface are compiled again.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_IncrementalRebuildsOnlyWhatChanged) {
+  const auto compiledNames = [this](const CompilerOptions& options = {}) {
+    std::vector<std::string> names;
+    for (const ClassResult& result : compileProject(dir, VmFormat::Text, options, 2, true)) {
+      EXPECT_TRUE(result.error.empty()) << result.error;
+      if (result.compiled)
+        names.push_back(result.source.stem().string());
+    }
+    return names;
+  };
+  using Names = std::vector<std::string>;
+
+  write("A.jack", jackClass("A", 1));
+  write("B.jack", jackClass("B", 2));
+  write("Main.jack", "class Main { function void main() { var A a; let a = A.new(); do a.get(3); return; } }\n");
+
+  EXPECT_EQ(compiledNames(), (Names{ "A", "B", "Main" }));
+  EXPECT_EQ(compiledNames(), Names{});
+
+  // A body edit keeps the interface: only that class is compiled.
+  write("B.jack", jackClass("B", 7));
+  EXPECT_EQ(compiledNames(), Names{ "B" });
+
+  // An interface change also recompiles the classes that call into it.
+  write("A.jack", jackClass("A", 1) + "\n");
+  EXPECT_EQ(compiledNames(), Names{ "A" });
+  write("A.jack", "class A { field int x, y; constructor A new() { return this; }"
+                  " method int get(int y, int z) { return y; } }\n");
+  EXPECT_EQ(compiledNames(), (Names{ "A", "Main" }));
+  EXPECT_NE(read(dir / BuildCache::kFileName).find("sub method int get(int,int)"), std::string::npos);
+
+  // Missing outputs and other compiler settings invalidate entries.
+  std::filesystem::remove(dir / "B.vm");
+  EXPECT_EQ(compiledNames(), Names{ "B" });
+  CompilerOptions options;
+  options.foldConstants = false;
+  EXPECT_EQ(compiledNames(options), (Names{ "A", "B", "Main" }));
+}
+
+/** @test
+ *  @brief Project builds drop functions no class calls, and compile a class
+ *         again once another class starts calling one of them.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_ProjectDropsUncalledFunctions) {
+  EXPECT_EQ(qualifiedNames("do Util . twice(1); let p = Point.new(); // Point.x\n let y = 3.5;"),
+            (std::set<std::string>{ "Point.new", "Point.x", "Util.twice" }));
+
+  write("Util.jack", "class Util { function int twice(int x) { return x + x; } function int spare() { return 0; } }\n");
+  write("Main.jack", "class Main { function void main() { do Util.twice(1); return; } }\n");
+
+  std::vector<ClassResult> results = compileProject(dir, VmFormat::Text, {}, 2, true);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[1].source.filename(), "Util.jack");
+  EXPECT_EQ(results[1].warnings, std::vector<std::string>{ "Util: removed unused function spare" });
+  EXPECT_EQ(read(dir / "Util.vm").find("function Util.spare"), std::string::npos);
+
+  write("Main.jack", "class Main { function void main() { do Util.twice(Util.spare()); return; } }\n");
+  results = compileProject(dir, VmFormat::Text, {}, 2, true);
+  EXPECT_TRUE(results[1].compiled);
+  EXPECT_TRUE(results[1].warnings.empty());
+  EXPECT_NE(read(dir / "Util.vm").find("function Util.spare"), std::string::npos);
+}
+
+/** @test
+ *  @brief OS functions that generated code calls for `*`, `/` and
+ *         constructors are kept even though no source names them.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_ProjectKeepsImplicitOsCalls) {
+  write("Math.jack", "class Math {\n"
+                     "  function int multiply(int x, int y) { return 0; }\n"
+                     "  function int divide(int x, int y) { return 0; }\n"
+                     "  function int sqrt(int x) { return 0; }\n"
+                     "}\n");
+  write("Memory.jack", "class Memory { function int alloc(int size) { return 0; } }\n");
+  write("Main.jack", "class Main { field int x;\n"
+                     "  constructor Main new() { return this; }\n"
+                     "  function void main() { var int a; let a = Main.new(); let a = a * a / a; return; } }\n");
+
+  const std::vector<ClassResult> results = compileProject(dir, VmFormat::Text, {}, 2, true);
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_EQ(results[1].warnings, std::vector<std::string>{ "Math: removed unused function sqrt" });
+  EXPECT_NE(read(dir / "Math.vm").find("function Math.multiply"), std::string::npos);
+  EXPECT_NE(read(dir / "Math.vm").find("function Math.divide"), std::string::npos);
+  EXPECT_TRUE(results[2].warnings.empty());
+}
+
+/** @test
+ *  @brief A directory without an entry point is a library: nothing in it is
+ *         removed, including an OS whose `Sys.init` calls a `Main` elsewhere.
+ */
+TEST_F(CompilerAnalyzerTestObject, CompilerAnalyzer_LibraryKeepsUncalledFunctions) {
+  write("Lib.jack", "class Lib { function int twice(int x) { return x + x; }"
+                    " function int thrice(int x) { return x + x + x; } }\n");
+
+  std::vector<ClassResult> results = compileProject(dir, VmFormat::Text, {}, 2, true);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_TRUE(results[0].warnings.empty());
+  EXPECT_NE(read(dir / "Lib.vm").find("function Lib.twice"), std::string::npos);
+  EXPECT_NE(read(dir / "Lib.vm").find("function Lib.thrice"), std::string::npos);
+
+  write("Sys.jack", "class Sys { function void init() { do Main.main(); return; } }\n");
+  results = compileProject(dir, VmFormat::Text, {}, 2, true);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_TRUE(results[0].warnings.empty());
+  EXPECT_NE(read(dir / "Lib.vm").find("function Lib.thrice"), std::string::npos);
+}
@@ -0,0 +1,68 @@
+/** @file
+ *  @brief GoogleTest harness for compile-time constant folding.
+ */
+
+#include "gtest/gtest.h"
+#include <string>
+#include "../Modules/Optimizer/constantFolder.h"
+#include "../Modules/Utils/compilerOptions.h"
+#include "compileFixture.h"
+
+using namespace testing;
+
+/**
+ * @brief Compiles `f(int x)` next to a second function `g` and returns the
+ *        VM code of `f`'s body.
+ */
+class ConstantFolderTestObject : public CompileTestObject {
+  protected:
+    std::string compileBody(const std::string& body, const CompilerOptions& options = {}) {
+      const std::string code = compileClass("class Main {\n"
+                                            "  function int f(int x) { " + body + " }\n"
+                                            "  function int g() { return 1; }\n"
+                                            "}\n", nullptr, options);
+      const std::size_t start = code.find('\n') + 1;
+      return code.substr(start, code.find("function Main.g") - start);
+    }
+};
+
+/** @test
+ *  @brief Constant operators are evaluated with 16-bit wraparound, and
+ *         results outside 0..32767 are pushed complemented.
+ */
+TEST_F(ConstantFolderTestObject, ConstantFolder_EvaluatesOperatorsWithWraparound) {
+  EXPECT_EQ(compileBody("return 3 * 4;"), "push constant 12\nreturn\n");
+  EXPECT_EQ(compileBody("return (7 - 9) / 2;"), "push constant 0\nnot\nreturn\n");
+  EXPECT_EQ(compileBody("return 32767 + 1;"), "push constant 32767\nnot\nreturn\n");
+  EXPECT_EQ(compileBody("return ~(1 = 1) | (2 > 1);"), "push constant 0\nnot\nreturn\n");
+  // `<` tests the sign of the wrapped difference, like the VM's `lt`.
+  EXPECT_EQ(compileBody("return 32767 < (-2);"), "push constant 0\nnot\nreturn\n");
+}
+
+/** @test
+ *  @brief Identities reduce to their operand; operands with side effects are
+ *         never dropped, and division by a constant zero is left alone.
+ */
+TEST_F(ConstantFolderTestObject, ConstantFolder_SimplifiesIdentitiesButKeepsEffects) {
+  EXPECT_EQ(compileBody("return ((x + 0) * 1) & (-1);"), "push argument 0\nreturn\n");
+  EXPECT_EQ(compileBody("return ~~x;"), "push argument 0\nreturn\n");
+  EXPECT_EQ(compileBody("return 0 - x;"), "push argument 0\nneg\nreturn\n");
+  EXPECT_EQ(compileBody("return x * 0;"), "push constant 0\nreturn\n");
+  // The call stays; strength reduction then turns `* 0` into `and 0`.
+  EXPECT_EQ(compileBody("return Main.g() * 0;"),
+            "call Main.g 0\npush constant 0\nand\nreturn\n");
+  EXPECT_EQ(compileBody("return 1 / 0;"),
+            "push constant 1\npush constant 0\ncall Math.divide 2\nreturn\n");
+}
+
+/** @test
+ *  @brief With folding (and strength reduction) disabled the code matches
+ *         the plain translation.
+ */
+TEST_F(ConstantFolderTestObject, ConstantFolder_CanBeDisabled) {
+  CompilerOptions options;
+  options.foldConstants = false;
+  options.strengthReduction = false;
+  EXPECT_EQ(compileBody("return 3 * 4;", options),
+            "push constant 3\npush constant 4\ncall Math.multiply 2\nreturn\n");
+}
@@ -0,0 +1,116 @@
+/** @file
+ *  @brief GoogleTest harness for dead-code elimination.
+ */
+
+#include "gtest/gtest.h"
+#include <set>
+#include <string>
+#include <vector>
+#include "../Modules/Utils/compilerOptions.h"
+#include "compileFixture.h"
+
+using namespace testing;
+
+class DeadCodeTestObject : public CompileTestObject {};
+
+/** @test
+ *  @brief Statements after a `return`, after an `if` whose arms both
+ *         return, and after an endless loop are dropped with a warning.
+ */
+TEST_F(DeadCodeTestObject, DeadCode_DropsUnreachableStatements) {
+  EXPECT_EQ(compileBody("return x; let x = 1; return 2;"),
+            "push argument 0\nreturn\n");
+  EXPECT_EQ(warnings, std::vector<std::string>{ "Main.f: removed 2 unreachable statements" });
+
+  EXPECT_EQ(compileBody("if (x) { return 1; } else { return 2; } return 3;"),
+            "push argument 0\n"
+            "if-goto Main.f$IF_TRUE0\ngoto Main.f$IF_FALSE0\nlabel Main.f$IF_TRUE0\n"
+            "push constant 1\nreturn\n"
+            "goto Main.f$IF_END0\nlabel Main.f$IF_FALSE0\n"
+            "push constant 2\nreturn\n"
+            "label Main.f$IF_END0\n");
+  EXPECT_EQ(warnings.size(), 1u);
+
+  // Jack has no `break`, so only a `return` leaves `while (true)`.
+  EXPECT_EQ(compileBody("while (true) { if (x > 9) { return x; } let x = x + 1; } return 0;"),
+            "goto Main.f$WHILE_EXP0\n"
+            "label Main.f$WHILE_BODY0\n"
+            "push argument 0\npush constant 9\ngt\nnot\nif-goto Main.f$IF_FALSE0\n"
+            "push argument 0\nreturn\n"
+            "label Main.f$IF_FALSE0\n"
+            "push argument 0\npush constant 1\nadd\npop argument 0\n"
+            "label Main.f$WHILE_EXP0\n"
+            "goto Main.f$WHILE_BODY0\n");
+  EXPECT_EQ(warnings, std::vector<std::string>{ "Main.f: removed 1 unreachable statement" });
+
+  EXPECT_EQ(compileBody("if (x) { return 1; } return 3;"),
+            "push argument 0\n"
+            "if-goto Main.f$IF_TRUE0\ngoto Main.f$IF_FALSE0\nlabel Main.f$IF_TRUE0\n"
+            "push constant 1\nreturn\n"
+            "label Main.f$IF_FALSE0\n"
+            "push constant 3\nreturn\n");
+  EXPECT_TRUE(warnings.empty());
+}
+
+/** @test
+ *  @brief Constant `if` conditions keep only the arm that runs, folded ones
+ *         included; a constant false `while` disappears.
+ */
+TEST_F(DeadCodeTestObject, DeadCode_FoldsConstantConditions) {
+  EXPECT_EQ(compileBody("if (true) { let x = 1; } else { let x = 2; } return x;"),
+            "push constant 1\npop argument 0\npush argument 0\nreturn\n");
+  EXPECT_EQ(warnings, std::vector<std::string>{ "Main.f: if condition is always true; removed the else branch" });
+
+  EXPECT_EQ(compileBody("if (3 < 2) { let x = 1; } while (false) { let x = x + 1; } return x;"),
+            "push argument 0\nreturn\n");
+  EXPECT_EQ(warnings, (std::vector<std::string>{ "Main.f: if condition is always false; removed the then branch",
+                                                 "Main.f: while condition is always false; removed the loop" }));
+
+  // Any non-zero value is true, and a returning arm ends the block.
+  EXPECT_EQ(compileBody("if (5) { return 1; } return 2;"), "push constant 1\nreturn\n");
+  EXPECT_EQ(warnings, (std::vector<std::string>{ "Main.f: removed 1 unreachable statement" }));
+
+  // `while` exits on `not c`, so only -1 loops: `while (1)` never runs and
+  // `while (~1)` (-2) neither, while `while (-1)` never ends.
+  EXPECT_EQ(compileBody("while (1) { let x = x + 1; } return x;"), "push argument 0\nreturn\n");
+  EXPECT_EQ(warnings, std::vector<std::string>{ "Main.f: while condition is always false; removed the loop" });
+  EXPECT_EQ(compileBody("while (~1) { let x = x + 1; } return x;"), "push argument 0\nreturn\n");
+  EXPECT_EQ(warnings, std::vector<std::string>{ "Main.f: while condition is always false; removed the loop" });
+  EXPECT_EQ(compileBody("while (-1) { let x = x + 1; } return x;"),
+            "goto Main.f$WHILE_EXP0\nlabel Main.f$WHILE_BODY0\n"
+            "push argument 0\npush constant 1\nadd\npop argument 0\n"
+            "label Main.f$WHILE_EXP0\ngoto Main.f$WHILE_BODY0\n");
+  EXPECT_EQ(warnings, std::vector<std::string>{ "Main.f: removed 1 unreachable statement" });
+
+  CompilerOptions options;
+  options.deadCodeElimination = false;
+  EXPECT_EQ(compileBody("return x; return 2;", options), "push argument 0\nreturn\npush constant 2\nreturn\n");
+  EXPECT_TRUE(warnings.empty());
+}
+
+/** @test
+ *  @brief Given the calls other classes make, functions that nothing can
+ *         reach are not emitted; without that knowledge all are kept.
+ */
+TEST_F(DeadCodeTestObject, DeadCode_RemovesUncalledFunctions) {
+  const std::string source =
+    "class Main {\n"
+    "  function void main() { do Main.a(); return; }\n"
+    "  function void a() { return; do Main.b(); }\n"
+    "  function void b() { return; }\n"
+    "  function void c() { do Main.d(); return; }\n"
+    "  function void d() { do Main.c(); return; }\n"
+    "  function void e() { return; }\n"
+    "  method void m() { do Main.b(); return; }\n"
+    "}\n";
+
+  const std::set<std::string> externalCalls { "e" };
+  const std::string code = compileClass(source, &externalCalls);
+  for (const char* kept : { "Main.main", "Main.a", "Main.b", "Main.e", "Main.m" })
+    EXPECT_NE(code.find(std::string("function ") + kept + " "), std::string::npos) << kept;
+  EXPECT_EQ(code.find("function Main.c "), std::string::npos);
+  EXPECT_EQ(code.find("function Main.d "), std::string::npos);
+  EXPECT_EQ(warnings.back(), "Main: removed unused function d");
+
+  EXPECT_NE(compileClass(source).find("function Main.d "), std::string::npos);
+}
@@ -0,0 +1,148 @@
+/** @file
+ *  @brief GoogleTest harness for the inline multiply / divide sequences.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../Modules/CodeGenerator/strengthReduction.h"
+#include "../Modules/Utils/compilerOptions.h"
+#include "compileFixture.h"
+
+using namespace testing;
+
+namespace {
+/** @brief Run `ops` on a stack holding `x`, with `local 0` = `x`, and return the top. */
+int16_t run(const VmSequence& ops, int16_t x) {
+  std::vector<int16_t> stack { x };
+  int16_t temp[8] {};
+  const auto pop = [&stack] { const int16_t v = stack.back(); stack.pop_back(); return v; };
+
+  for (const VmOp& op : ops) {
+    switch (op.kind) {
+      case VmOp::Kind::Push:
+        if (op.segment == Segment::Constant)     stack.push_back(static_cast<int16_t>(op.index));
+        else if (op.segment == Segment::Temp)    stack.push_back(temp[op.index]);
+        else                                     stack.push_back(x);
+        break;
+      case VmOp::Kind::Pop:
+        temp[op.index] = pop();
+        break;
+      case VmOp::Kind::Arithmetic: {
+        const int16_t b = op.command == Command::Neg || op.command == Command::Not ? 0 : pop();
+        const int16_t a = pop();
+        const int16_t difference = static_cast<int16_t>(a - b);
+        switch (op.command) {
+          case Command::Add: stack.push_back(static_cast<int16_t>(a + b)); break;
+          case Command::Sub: stack.push_back(difference); break;
+          case Command::Neg: stack.push_back(static_cast<int16_t>(-a)); break;
+          case Command::Not: stack.push_back(static_cast<int16_t>(~a)); break;
+          case Command::And: stack.push_back(static_cast<int16_t>(a & b)); break;
+          case Command::Or:  stack.push_back(static_cast<int16_t>(a | b)); break;
+          case Command::Eq:  stack.push_back(a == b ? -1 : 0); break;
+          case Command::Gt:  stack.push_back(difference > 0 ? -1 : 0); break;
+          case Command::Lt:  stack.push_back(difference < 0 ? -1 : 0); break;
+        }
+        break;
+      }
+    }
+  }
+  EXPECT_EQ(stack.size(), 1u);
+  return stack.back();
+}
+}
+
+/** @test
+ *  @brief Multiplication sequences match 16-bit wrapping multiplication for
+ *         every `x`, whether `x` is spilled or pushed again.
+ */
+TEST(StrengthReduction, MultiplyMatchesWrappingProduct) {
+  const VmOp reload { VmOp::Kind::Push, Segment::Local, 0 };
+  for (int32_t factor : { 0, 1, 2, 3, 10, 16, 32, 100, 255, 21845, 32767, -1, -16, -100, -32768 }) {
+    const VmSequence spilled  = lowerMultiply(static_cast<uint16_t>(factor), std::nullopt);
+    const VmSequence reloaded = lowerMultiply(static_cast<uint16_t>(factor), reload);
+    for (int32_t x { -32768 }; x <= 32767; ++x) {
+      const int16_t expected = static_cast<int16_t>(x * factor);
+      ASSERT_EQ(run(spilled, static_cast<int16_t>(x)), expected)  << x << " * " << factor;
+      ASSERT_EQ(run(reloaded, static_cast<int16_t>(x)), expected) << x << " * " << factor;
+    }
+  }
+}
+
+/** @test
+ *  @brief Division by a power of two truncates toward zero for every `x`;
+ *         other divisors have no inline form.
+ */
+TEST(StrengthReduction, DivideTruncatesTowardZero) {
+  for (int32_t divisor : { 1, -1 }) {
+    const std::optional<VmSequence> ops = lowerDivide(static_cast<uint16_t>(divisor));
+    ASSERT_TRUE(ops.has_value()) << divisor;
+    for (int32_t x { -32768 }; x <= 32767; ++x)
+      ASSERT_EQ(run(*ops, static_cast<int16_t>(x)), static_cast<int16_t>(x / divisor)) << x << " / " << divisor;
+  }
+
+  EXPECT_FALSE(lowerDivide(0).has_value());
+  EXPECT_FALSE(lowerDivide(2).has_value());
+  EXPECT_FALSE(lowerDivide(3).has_value());
+  EXPECT_FALSE(lowerDivide(0x8000).has_value());
+}
+
+/** @test
+ *  @brief The cost model never picks code estimated dearer than the call.
+ */
+TEST(StrengthReduction, CostModelComparesAgainstCall) {
+  EXPECT_LT(estimateCost(lowerMultiply(16, std::nullopt)).cycles, callCost('*', 16).cycles);
+  EXPECT_TRUE(reduceStrength('*', 32, std::nullopt).has_value());
+  EXPECT_TRUE(reduceStrength('/', 1, std::nullopt).has_value());
+  EXPECT_FALSE(reduceStrength('/', 2, std::nullopt).has_value());
+  EXPECT_FALSE(reduceStrength('/', 10, std::nullopt).has_value());
+  EXPECT_FALSE(reduceStrength('+', 2, std::nullopt).has_value());
+}
+
+/** @test
+ *  @brief Faster code is still rejected when it takes too much ROM.
+ */
+TEST(StrengthReduction, CostModelBoundsRomSize) {
+  for (uint32_t factor { 0 }; factor <= 0xFFFF; ++factor) {
+    const std::optional<VmSequence> ops = reduceStrength('*', static_cast<uint16_t>(factor), std::nullopt);
+    if (ops) {
+      ASSERT_LE(estimateCost(*ops).words, kMaxInlineWords) << factor;
+    }
+  }
+
+  const VmSequence longest { lowerMultiply(0x5555, std::nullopt) };
+  EXPECT_LT(estimateCost(longest).cycles, callCost('*', 0x5555).cycles);
+  EXPECT_GT(estimateCost(longest).words, kMaxInlineWords);
+  EXPECT_FALSE(reduceStrength('*', 0x5555, std::nullopt).has_value());
+}
+
+class StrengthReductionTestObject : public CompileTestObject {};
+
+/** @test
+ *  @brief `x * 4` and `4 * x` become doubling chains; non-constant operands
+ *         and disabled reduction keep the OS call.
+ */
+TEST_F(StrengthReductionTestObject, LowersConstantOperandsOnly) {
+  const std::string doubled {
+    "push argument 0\n"
+    "pop temp 2\npush temp 2\npush temp 2\nadd\n"
+    "pop temp 2\npush temp 2\npush temp 2\nadd\n"
+    "return\n"
+  };
+  EXPECT_EQ(compileBody("return x * 4;"), doubled);
+  EXPECT_EQ(compileBody("return 4 * x;"), doubled);
+
+  EXPECT_EQ(compileBody("return x * x;"),
+            "push argument 0\npush argument 0\ncall Math.multiply 2\nreturn\n");
+  EXPECT_EQ(compileBody("return x / 10;"),
+            "push argument 0\npush constant 10\ncall Math.divide 2\nreturn\n");
+  EXPECT_EQ(compileBody("return 64 / x;"),
+            "push constant 64\npush argument 0\ncall Math.divide 2\nreturn\n");
+
+  CompilerOptions options;
+  options.strengthReduction = false;
+  EXPECT_EQ(compileBody("return x * 4;", options),
+            "push argument 0\npush constant 4\ncall Math.multiply 2\nreturn\n");
+}
@@ -89,3 +89,49 @@ TEST_F(SymbolTable_F, check_table_count_is_correct) {
   ASSERT_EQ(fieldCnt, 1);
   EXPECT_THROW(m_table.varCount(IdentifierKind::None), std::runtime_error);
 }
+
+TEST_F(SymbolTable_F, indices_restart_for_each_kind) {
+  m_table.define("count", "int", IdentifierKind::Static);
+  m_table.define("x", "int", IdentifierKind::Field);
+  m_table.define("y", "int", IdentifierKind::Field);
+  m_table.define("a", "int", IdentifierKind::Arg);
+  m_table.define("i", "int", IdentifierKind::Var);
+
+  ASSERT_EQ(m_table.indexOf("count"), 0);
+  ASSERT_EQ(m_table.indexOf("x"), 0);
+  ASSERT_EQ(m_table.indexOf("y"), 1);
+  ASSERT_EQ(m_table.indexOf("a"), 0);
+  ASSERT_EQ(m_table.indexOf("i"), 0);
+
+  // Counting starts over after a reset
+  m_table.reset();
+  m_table.define("j", "int", IdentifierKind::Var);
+  ASSERT_EQ(m_table.indexOf("j"), 0);
+}
+
+TEST_F(SymbolTable_F, resolve_searches_enclosing_scope) {
+  m_table.define("x", "int", IdentifierKind::Field);
+  m_table.define("p", "Point", IdentifierKind::Static);
+
+  SymbolTable inner(&m_table);
+  inner.define("x", "Array", IdentifierKind::Var);
+  inner.define("n", "int", IdentifierKind::Arg);
+
+  // Inner definitions shadow the class scope
+  const Symbol* x { inner.resolve("x") };
+  ASSERT_NE(x, nullptr);
+  ASSERT_EQ(x->kind, IdentifierKind::Var);
+  ASSERT_EQ(x->type, "Array");
+
+  const Symbol* p { inner.resolve(std::string("p")) };
+  ASSERT_NE(p, nullptr);
+  ASSERT_EQ(p->kind, IdentifierKind::Static);
+  ASSERT_EQ(p->type, "Point");
+  ASSERT_EQ(p->idx, 0);
+
+  ASSERT_EQ(inner.resolve("missing"), nullptr);
+  ASSERT_EQ(m_table.resolve("n"), nullptr);
+
+  inner.reset();
+  ASSERT_EQ(inner.resolve("x")->kind, IdentifierKind::Field);
+}
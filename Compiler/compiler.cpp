@@ -1,15 +1,76 @@
 #include "Modules/CompilerAnalyzer/compilerAnalyzer.h"
+#include "Modules/Utils/compilerOptions.h"
+#include <cstddef>
 #include <filesystem>
+#include <iostream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 int main(int argc, char* argv[]) {
-  if (argc != 2)
-    throw std::runtime_error("[ERROR] Usage: Compiler <input.jack>");
+  const std::string usage {
+    "[ERROR] Usage: Compiler [--binary] [--no-fold-constants] [--no-strength-reduction]\n"
+    "                        [--no-compact-branches] [--no-string-pool]\n"
+    "                        [--no-dead-code-elimination] [--no-intrinsics] [--void-calls]\n"
+    "                        [--jobs <n>] [--rebuild]\n"
+    "                        <input.jack | project-dir>"
+  };
 
-  std::filesystem::path filePath { argv[1] };
+  VmFormat format { VmFormat::Text };
+  CompilerOptions options;
+  std::size_t jobs {};
+  bool rebuild {};
+  std::vector<std::string> inputs;
 
-  CompilerAnalyzer analyzer(filePath);
+  for (int i{1}; i < argc; ++i) {
+    const std::string arg { argv[i] };
+    if (arg == "--binary")
+      format = VmFormat::Binary;
+    else if (arg == "--no-fold-constants")
+      options.foldConstants = false;
+    else if (arg == "--no-strength-reduction")
+      options.strengthReduction = false;
+    else if (arg == "--no-compact-branches")
+      options.compactBranches = false;
+    else if (arg == "--no-string-pool")
+      options.stringPool = false;
+    else if (arg == "--no-dead-code-elimination")
+      options.deadCodeElimination = false;
+    else if (arg == "--no-intrinsics")
+      options.intrinsics = false;
+    else if (arg == "--void-calls")
+      options.voidCalls = true;
+    else if (arg == "--jobs" && i + 1 < argc)
+      jobs = std::stoul(argv[++i]);
+    else if (arg == "--rebuild")
+      rebuild = true;
+    else if (arg.rfind("--", 0) == 0)
+      throw std::runtime_error(usage);
+    else
+      inputs.push_back(arg);
+  }
+  if (inputs.size() != 1)
+    throw std::runtime_error(usage);
+
+  std::filesystem::path filePath { inputs.front() };
+
+  if (std::filesystem::is_directory(filePath)) {
+    std::size_t failed {};
+    for (const ClassResult& result : compileProject(filePath, format, options, jobs, !rebuild)) {
+      const std::string file { result.source.filename().string() };
+      for (const std::string& warning : result.warnings)
+        std::cerr << "[WARNING] " << file << ": " << warning << '\n';
+      if (result.error.empty()) continue;
+      std::cerr << "[ERROR] " << file << ": " << result.error << '\n';
+      ++failed;
+    }
+    return failed == 0 ? 0 : 1;
+  }
+
+  CompilerAnalyzer analyzer(filePath, format, options);
   analyzer.run();
+  for (const std::string& warning : analyzer.warnings())
+    std::cerr << "[WARNING] " << warning << '\n';
 
   return 0;
 }
@@ -0,0 +1,86 @@
+/**
+ * @file constantPush.cpp
+ * @brief Counts the Hack instructions emitted for a corpus of compiled Jack
+ *        code with and without ALU-constant pushes.
+ *
+ * Usage: bench_constantPush [corpus-dir]
+ */
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../Modules/VMTranslator/vmtranslator.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/** @brief Translates one file to machine code and returns the ROM size in words. */
+std::size_t countInstructions(const fs::path& vmFile, const TranslatorOptions& options) {
+  const fs::path rom = fs::temp_directory_path() / (vmFile.stem().string() + ".bench.hack");
+
+  VMTranslator translator(options);
+  translator.translate(vmFile.string(), rom.string());
+
+  std::ifstream in(rom);
+  std::size_t words {};
+  for (std::string line; std::getline(in, line);)
+    ++words;
+
+  fs::remove(rom);
+  return words;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const fs::path corpus { argc > 1 ? argv[1] : CORPUS_DIR };
+
+  std::vector<fs::path> files;
+  for (const auto& entry : fs::directory_iterator(corpus)) {
+    if (entry.path().extension() == ".vm")
+      files.push_back(entry.path());
+  }
+  std::sort(files.begin(), files.end());
+
+  TranslatorOptions before;
+  before.aluConstants = false;
+  TranslatorOptions after;
+
+  std::size_t totalBefore {};
+  std::size_t totalAfter {};
+
+  std::cout << std::left << std::setw(20) << "file"
+            << std::right << std::setw(10) << "before"
+            << std::setw(10) << "after"
+            << std::setw(10) << "saved" << '\n';
+
+  for (const fs::path& file : files) {
+    const std::size_t nBefore { countInstructions(file, before) };
+    const std::size_t nAfter  { countInstructions(file, after) };
+    totalBefore += nBefore;
+    totalAfter  += nAfter;
+
+    std::cout << std::left << std::setw(20) << file.filename().string()
+              << std::right << std::setw(10) << nBefore
+              << std::setw(10) << nAfter
+              << std::setw(10) << (nBefore - nAfter) << '\n';
+  }
+
+  std::cout << std::left << std::setw(20) << "total"
+            << std::right << std::setw(10) << totalBefore
+            << std::setw(10) << totalAfter
+            << std::setw(10) << (totalBefore - totalAfter) << '\n';
+
+  if (totalBefore > 0) {
+    std::cout << std::fixed << std::setprecision(2)
+              << "reduction: " << 100.0 * static_cast<double>(totalBefore - totalAfter) / static_cast<double>(totalBefore)
+              << "%\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,270 @@
+#include "functionAnalysis.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include "../Utils/CommandType.h"
+
+namespace {
+/** @brief Words a call pushes between the arguments and the callee's locals. */
+constexpr uint32_t kFrameWords = 5;
+
+/** @brief Operand-stack words a command needs on entry. */
+int stackInputs(const VmCommand& cmd) {
+  switch (cmd.type) {
+    case CommandType::C_ARITHMETIC:
+      return (cmd.arg1 == "neg" || cmd.arg1 == "not" || cmd.arg1 == "drop") ? 1 : 2;
+    case CommandType::C_POP:
+    case CommandType::C_IF:
+      return 1;
+    case CommandType::C_RETURN:
+      return cmd.isVoid ? 0 : 1;
+    case CommandType::C_CALL:
+      return cmd.arg2;
+    default:
+      return 0;
+  }
+}
+
+/** @brief Net change of the operand-stack depth across a command. */
+int stackEffect(const VmCommand& cmd) {
+  switch (cmd.type) {
+    case CommandType::C_PUSH:
+      return 1;
+    case CommandType::C_CALL:
+      return (cmd.isVoid ? 0 : 1) - cmd.arg2;
+    case CommandType::C_ARITHMETIC:
+      return (cmd.arg1 == "neg" || cmd.arg1 == "not") ? 0 : -1;
+    default:
+      return -stackInputs(cmd);
+  }
+}
+
+bool endsBlock(const VmCommand& cmd) {
+  return cmd.type == CommandType::C_GOTO || cmd.type == CommandType::C_IF || cmd.type == CommandType::C_RETURN;
+}
+}
+
+FunctionAnalysis::FunctionAnalysis(std::string name, uint32_t nLocals, std::vector<VmCommand> body,
+                                   bool privateTemps)
+  : m_name(std::move(name))
+  , m_nLocals(nLocals)
+  , m_body(std::move(body))
+  , m_privateTemps(privateTemps)
+{
+  buildBlocks();
+  computeDepths();
+  computeLiveness();
+}
+
+void FunctionAnalysis::buildBlocks() {
+  std::unordered_map<std::string, std::size_t> labelBlock;
+  m_blockOf.resize(m_body.size());
+
+  for (std::size_t i{}; i < m_body.size(); ++i) {
+    const bool leader = (i == 0) || m_body[i].type == CommandType::C_LABEL || endsBlock(m_body[i - 1]);
+    if (leader) {
+      if (!m_blocks.empty())
+        m_blocks.back().last = i;
+      m_blocks.push_back(BasicBlock{ i, i, {}, {} });
+    }
+    m_blockOf[i] = m_blocks.size() - 1;
+
+    if (m_body[i].type == CommandType::C_LABEL &&
+        !labelBlock.emplace(m_body[i].arg1, m_blocks.size() - 1).second)
+      throw std::runtime_error("[ERROR] Duplicate label " + m_body[i].arg1 + " in " + m_name);
+  }
+  if (!m_blocks.empty())
+    m_blocks.back().last = m_body.size();
+
+  const auto target = [&](const std::string& label) {
+    const auto block = labelBlock.find(label);
+    if (block == labelBlock.end())
+      throw std::runtime_error("[ERROR] Unknown label " + label + " in " + m_name);
+    return block->second;
+  };
+
+  for (std::size_t b{}; b < m_blocks.size(); ++b) {
+    const VmCommand& exit = m_body[m_blocks[b].last - 1];
+    std::vector<std::size_t>& successors = m_blocks[b].successors;
+
+    if (exit.type == CommandType::C_GOTO || exit.type == CommandType::C_IF)
+      successors.push_back(target(exit.arg1));
+    if (exit.type != CommandType::C_GOTO && exit.type != CommandType::C_RETURN && b + 1 < m_blocks.size() &&
+        std::find(successors.begin(), successors.end(), b + 1) == successors.end())
+      successors.push_back(b + 1);
+  }
+}
+
+void FunctionAnalysis::computeDepths() {
+  m_depthBefore.assign(m_body.size(), std::nullopt);
+  if (m_blocks.empty())
+    return;
+
+  std::deque<std::size_t> pending { 0 };
+  m_blocks[0].entryDepth = 0;
+
+  while (!pending.empty()) {
+    const std::size_t b = pending.front();
+    pending.pop_front();
+
+    int depth = *m_blocks[b].entryDepth;
+    for (std::size_t i = m_blocks[b].first; i < m_blocks[b].last; ++i) {
+      if (depth < stackInputs(m_body[i]))
+        throw std::runtime_error("[ERROR] Stack underflow in " + m_name + " at command " + std::to_string(i));
+      m_depthBefore[i] = depth;
+      depth += stackEffect(m_body[i]);
+      m_maxDepth = std::max(m_maxDepth, depth);
+    }
+
+    for (std::size_t next : m_blocks[b].successors) {
+      std::optional<int>& entry = m_blocks[next].entryDepth;
+      if (!entry) {
+        entry = depth;
+        pending.push_back(next);
+      } else if (*entry != depth) {
+        const VmCommand& head = m_body[m_blocks[next].first];
+        throw std::runtime_error("[ERROR] Inconsistent stack depth at " +
+                                 (head.type == CommandType::C_LABEL ? head.arg1 : std::to_string(m_blocks[next].first)) +
+                                 " in " + m_name);
+      }
+    }
+  }
+}
+
+std::optional<std::size_t> FunctionAnalysis::slotOf(const std::string& segment, int32_t index) const {
+  if (segment == "temp" && index >= 0 && static_cast<std::size_t>(index) < kTempSlots)
+    return static_cast<std::size_t>(index);
+  if (segment == "local" && index >= 0 && static_cast<uint32_t>(index) < m_nLocals)
+    return kTempSlots + static_cast<std::size_t>(index);
+  return std::nullopt;
+}
+
+void FunctionAnalysis::transfer(const VmCommand& cmd, SlotSet& live) const {
+  if (cmd.type == CommandType::C_ASM) {
+    std::fill(live.begin(), live.end(), true);
+  } else if (cmd.type == CommandType::C_CALL && !m_privateTemps) {
+    std::fill(live.begin(), live.begin() + kTempSlots, true);
+  } else if (cmd.type == CommandType::C_PUSH || cmd.type == CommandType::C_POP) {
+    if (const auto slot = slotOf(cmd.arg1, cmd.arg2))
+      live[*slot] = (cmd.type == CommandType::C_PUSH);
+  }
+}
+
+void FunctionAnalysis::computeLiveness() {
+  const std::size_t slots = kTempSlots + m_nLocals;
+  SlotSet afterReturn(slots, false);
+  if (!m_privateTemps)
+    std::fill(afterReturn.begin(), afterReturn.begin() + kTempSlots, true);
+
+  m_liveOut.assign(m_body.size(), SlotSet(slots, false));
+  std::vector<SlotSet> liveIn(m_blocks.size(), SlotSet(slots, false));
+
+  // Iterate to a fixed point, visiting blocks backwards so most facts settle in one pass.
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (std::size_t b = m_blocks.size(); b-- > 0;) {
+      const BasicBlock& block = m_blocks[b];
+
+      SlotSet live = (m_body[block.last - 1].type == CommandType::C_RETURN) ? afterReturn : SlotSet(slots, false);
+      for (std::size_t next : block.successors)
+        for (std::size_t s{}; s < slots; ++s)
+          if (liveIn[next][s]) live[s] = true;
+
+      for (std::size_t i = block.last; i-- > block.first;) {
+        m_liveOut[i] = live;
+        transfer(m_body[i], live);
+      }
+
+      if (live != liveIn[b]) {
+        liveIn[b] = std::move(live);
+        changed = true;
+      }
+    }
+  }
+}
+
+uint32_t FunctionAnalysis::maxStackUsage() const {
+  return kFrameWords + m_nLocals + static_cast<uint32_t>(m_maxDepth);
+}
+
+std::vector<std::size_t> FunctionAnalysis::deadStores() const {
+  std::vector<std::size_t> dead;
+  for (std::size_t i{}; i < m_body.size(); ++i) {
+    if (m_body[i].type != CommandType::C_POP || !m_depthBefore[i])
+      continue;
+    const auto slot = slotOf(m_body[i].arg1, m_body[i].arg2);
+    if (slot && !m_liveOut[i][*slot])
+      dead.push_back(i);
+  }
+  return dead;
+}
+
+std::vector<std::string> FunctionAnalysis::callees() const {
+  std::vector<std::string> names;
+  for (const VmCommand& cmd : m_body)
+    if (cmd.type == CommandType::C_CALL && std::find(names.begin(), names.end(), cmd.arg1) == names.end())
+      names.push_back(cmd.arg1);
+  return names;
+}
+
+std::vector<FunctionAnalysis> analyzeFunctions(const std::vector<VmCommand>& commands, bool privateTemps) {
+  std::vector<FunctionAnalysis> functions;
+
+  auto next = std::find_if(commands.begin(), commands.end(),
+                           [](const VmCommand& cmd) { return cmd.type == CommandType::C_FUNCTION; });
+  while (next != commands.end()) {
+    const auto bodyEnd = std::find_if(next + 1, commands.end(),
+                                      [](const VmCommand& cmd) { return cmd.type == CommandType::C_FUNCTION; });
+    functions.emplace_back(next->arg1, static_cast<uint32_t>(next->arg2), std::vector<VmCommand>(next + 1, bodyEnd),
+                           privateTemps);
+    next = bodyEnd;
+  }
+  return functions;
+}
+
+std::optional<uint32_t> stackHighWater(const std::vector<FunctionAnalysis>& functions, const std::string& entry) {
+  std::unordered_map<std::string, const FunctionAnalysis*> byName;
+  for (const FunctionAnalysis& function : functions)
+    byName.emplace(function.name(), &function);
+
+  std::unordered_map<std::string, uint32_t> usage;
+  std::unordered_map<std::string, bool> onPath;
+
+  std::function<std::optional<uint32_t>(const std::string&)> visit =
+    [&](const std::string& name) -> std::optional<uint32_t> {
+      const auto known = usage.find(name);
+      if (known != usage.end())
+        return known->second;
+
+      const auto found = byName.find(name);
+      if (found == byName.end())
+        return kFrameWords;
+      if (onPath[name])
+        return std::nullopt;
+
+      onPath[name] = true;
+      const FunctionAnalysis& function = *found->second;
+
+      // Deepest point: either the operand stack itself or a call on top of it.
+      uint32_t deepest = static_cast<uint32_t>(function.maxDepth());
+      for (std::size_t i{}; i < function.body().size(); ++i) {
+        const VmCommand& cmd = function.body()[i];
+        if (cmd.type != CommandType::C_CALL || !function.depthBefore(i))
+          continue;
+        const auto callee = visit(cmd.arg1);
+        if (!callee)
+          return std::nullopt;
+        deepest = std::max(deepest, static_cast<uint32_t>(*function.depthBefore(i)) + *callee);
+      }
+
+      onPath[name] = false;
+      const uint32_t total = kFrameWords + function.localCount() + deepest;
+      usage.emplace(name, total);
+      return total;
+    };
+
+  return visit(entry);
+}
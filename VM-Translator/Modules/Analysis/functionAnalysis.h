@@ -0,0 +1,124 @@
+#pragma once
+
+/**
+ * @file functionAnalysis.h
+ * @brief Control-flow graph, stack depth and slot liveness for VM functions.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../Utils/VmCommand.h"
+
+/**
+ * @brief Set of tracked slots, indexed by FunctionAnalysis::slotOf().
+ */
+using SlotSet = std::vector<bool>;
+
+/**
+ * @brief Straight-line run of commands with a single entry and exit.
+ */
+struct BasicBlock {
+  std::size_t first{};                  /**< Index of the first command in the function body. */
+  std::size_t last{};                   /**< One past the index of the last command. */
+  std::vector<std::size_t> successors;  /**< Indices of the blocks control may continue to. */
+  std::optional<int> entryDepth;        /**< Operand-stack depth on entry; empty when unreachable. */
+};
+
+/**
+ * @brief Analyses the body of one VM function.
+ *
+ * Blocks start at the function entry, at every `label` and after every
+ * `goto`, `if-goto` and `return`; `call` does not end a block. Stack depths
+ * count operand-stack words above the function's locals. Liveness covers
+ * `temp 0-7` and the function's declared locals: temps are global, so a
+ * `call` may read all of them and all of them are live after `return`,
+ * unless the caller promises they are private to each function (as in code
+ * produced by the Jack compiler, which only uses temps within a statement).
+ * An `asm` command may read any slot, so every slot is live before it.
+ */
+class FunctionAnalysis {
+  private:
+    std::string m_name;
+    uint32_t m_nLocals{};
+    std::vector<VmCommand> m_body;
+    std::vector<BasicBlock> m_blocks;
+    /** @brief Block containing each command. */
+    std::vector<std::size_t> m_blockOf;
+    /** @brief Operand-stack depth before each command; empty when unreachable. */
+    std::vector<std::optional<int>> m_depthBefore;
+    /** @brief Slots live right after each command. */
+    std::vector<SlotSet> m_liveOut;
+    int m_maxDepth{};
+    /** @brief Temps are assumed not to carry values across calls and returns. */
+    bool m_privateTemps{};
+
+    void buildBlocks();
+    void computeDepths();
+    void computeLiveness();
+    /** @brief Live-in of a command given its live-out. */
+    void transfer(const VmCommand& cmd, SlotSet& live) const;
+
+  public:
+    /** @brief Number of `temp` slots, which come first in a SlotSet. */
+    static constexpr std::size_t kTempSlots = 8;
+
+    /**
+     * @brief Analyses one function.
+     * @param name    Function name from its `function` command.
+     * @param nLocals Declared local count.
+     * @param body    Commands after the `function` command, up to the next function.
+     * @param privateTemps Assume no temp value flows across a call or return.
+     * @throws std::runtime_error on unknown or duplicate labels, stack underflow,
+     *         or paths that reach a label with different stack depths.
+     */
+    FunctionAnalysis(std::string name, uint32_t nLocals, std::vector<VmCommand> body, bool privateTemps = false);
+
+    const std::string& name() const { return m_name; }
+    uint32_t localCount() const { return m_nLocals; }
+    const std::vector<VmCommand>& body() const { return m_body; }
+    const std::vector<BasicBlock>& blocks() const { return m_blocks; }
+
+    /** @brief Block containing body command `i`. */
+    std::size_t blockOf(std::size_t i) const { return m_blockOf[i]; }
+
+    /** @brief Operand-stack depth before body command `i`; empty when it is unreachable. */
+    std::optional<int> depthBefore(std::size_t i) const { return m_depthBefore[i]; }
+
+    /** @brief Highest operand-stack depth reached anywhere in the body. */
+    int maxDepth() const { return m_maxDepth; }
+
+    /** @brief Stack words one activation occupies, callees excluded: frame, locals and operands. */
+    uint32_t maxStackUsage() const;
+
+    /** @brief Slot index of `segment index`, if it is a tracked temp or declared local. */
+    std::optional<std::size_t> slotOf(const std::string& segment, int32_t index) const;
+
+    /** @brief Slots live right after body command `i`. */
+    const SlotSet& liveAfter(std::size_t i) const { return m_liveOut[i]; }
+
+    /** @brief Body indices of pops into tracked slots that are never read afterwards. */
+    std::vector<std::size_t> deadStores() const;
+
+    /** @brief Functions called from the body, in order of first call. */
+    std::vector<std::string> callees() const;
+};
+
+/**
+ * @brief Splits a loaded `.vm` file into functions and analyses each one.
+ *
+ * Commands before the first `function` (e.g. bootstrap code) are ignored.
+ * @param privateTemps Passed on to every FunctionAnalysis.
+ */
+std::vector<FunctionAnalysis> analyzeFunctions(const std::vector<VmCommand>& commands, bool privateTemps = false);
+
+/**
+ * @brief Worst-case stack words used by a call to `entry`, including everything it calls.
+ *
+ * Each activation counts its saved frame, locals and operand stack at the
+ * deepest call site. Functions missing from `functions` are assumed to use
+ * only their saved frame.
+ * @return Empty when a recursive cycle is reachable from `entry`.
+ */
+std::optional<uint32_t> stackHighWater(const std::vector<FunctionAnalysis>& functions, const std::string& entry);
@@ -0,0 +1,29 @@
+#include "asmSink.h"
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+AsmSink::AsmSink(std::ostream& out)
+  : m_out(out)
+{}
+
+void AsmSink::comment(std::string_view text) { m_out << "// " << text << '\n'; }
+
+void AsmSink::label(std::string_view name) { m_out << '(' << name << ")\n"; }
+
+void AsmSink::address(std::string_view symbol) { m_out << '@' << symbol << '\n'; }
+
+void AsmSink::address(uint32_t value) { m_out << '@' << value << '\n'; }
+
+void AsmSink::compute(std::string_view dest, std::string_view comp, std::string_view jump) {
+  if (!dest.empty())
+    m_out << dest << '=';
+  m_out << comp;
+  if (!jump.empty())
+    m_out << ';' << jump;
+  m_out << '\n';
+}
+
+void AsmSink::append(std::string_view assembly) { m_out << assembly; }
+
+void AsmSink::flush() { m_out.flush(); }
@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * @file asmSink.h
+ * @brief InstructionSink that prints human-readable Hack assembly.
+ */
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include "instructionSink.h"
+
+/**
+ * @brief Writes each instruction as one line of `.asm` text.
+ */
+class AsmSink : public InstructionSink {
+  private:
+    /** @brief Stream receiving the assembly text. */
+    std::ostream& m_out;
+
+  public:
+    /**
+     * @brief Constructs a sink printing to the given stream.
+     * @param out Stream that outlives the sink.
+     */
+    explicit AsmSink(std::ostream& out);
+    AsmSink(const AsmSink&) = delete;
+
+    void comment(std::string_view text) override;
+    void label(std::string_view name) override;
+    void address(std::string_view symbol) override;
+    void address(uint32_t value) override;
+    void compute(std::string_view dest, std::string_view comp, std::string_view jump) override;
+
+    /** @brief Appends already formatted assembly text verbatim. */
+    void append(std::string_view assembly);
+
+    /** @brief Flushes the underlying stream. */
+    void flush();
+};
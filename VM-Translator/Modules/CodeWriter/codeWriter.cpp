@@ -1,12 +1,33 @@
 #include "codeWriter.h"
+#include "../../../Assembler/Modules/Code/code.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>
+#include <memory>
 #include <stdexcept>
-
-CodeWriter::CodeWriter(const std::string& fileName) {
+#include <string>
+#include <string_view>
+#include <system_error>
+
+CodeWriter::CodeWriter(const std::string& fileName)
+  : m_asm(std::make_unique<AsmSink>(m_output_file))
+  , m_sink(*m_asm)
+{
   setFileName(fileName);
 }
 
+CodeWriter::CodeWriter(std::ostream& out)
+  : m_asm(std::make_unique<AsmSink>(out))
+  , m_sink(*m_asm)
+{}
+
+CodeWriter::CodeWriter(InstructionSink& sink)
+  : m_sink(sink)
+{}
+
 
 void CodeWriter::setFileName(const std::string& fileName) {
   if (std::filesystem::path(fileName).extension() != ".asm")
@@ -17,68 +38,171 @@ void CodeWriter::setFileName(const std::string& fileName) {
     throw std::runtime_error("[ERROR] Failed to open output: " + m_file_name);
 }
 
+void CodeWriter::emitA(std::string_view symbol) {
+  m_sink.address(symbol);
+  ++m_emitted;
+  ++m_pathLength;
+}
+
+void CodeWriter::emitA(uint32_t value) {
+  m_sink.address(value);
+  ++m_emitted;
+  ++m_pathLength;
+}
+
+void CodeWriter::emitC(std::string_view dest, std::string_view comp, std::string_view jump) {
+  m_sink.compute(dest, comp, jump);
+  ++m_emitted;
+  ++m_pathLength;
+}
+
+void CodeWriter::emitLabel(std::string_view label) { m_sink.label(label); }
+
+void CodeWriter::pushD() {
+  if (m_options.spBatching) {
+    addressStack(0);
+    emitC("M", "D");
+    ++m_spOffset;
+    return;
+  }
+
+  emitA("SP");
+  emitC("A", "M");
+  emitC("M", "D");
+  emitA("SP");
+  emitC("M", "M+1");
+}
+
+void CodeWriter::popD() {
+  if (m_options.spBatching) {
+    --m_spOffset;
+    addressStack(0);
+    emitC("D", "M");
+    return;
+  }
+
+  emitA("SP");
+  emitC("AM", "M-1");
+  emitC("D", "M");
+}
+
+void CodeWriter::addressStack(int fromTop) {
+  // Each step away from RAM[SP] costs an A=A+-1, so keep the pending offset small.
+  if (std::abs(m_spOffset + fromTop) > 2)
+    flushStackPointer();
+
+  const int slot = m_spOffset + fromTop;
+  emitA("SP");
+  if (slot == 0) {
+    emitC("A", "M");
+    return;
+  }
+  emitC("A", slot > 0 ? "M+1" : "M-1");
+  for (int step{1}; step < std::abs(slot); ++step)
+    emitC("A", slot > 0 ? "A+1" : "A-1");
+}
+
+void CodeWriter::popDCommitted() {
+  if (!m_options.spBatching) {
+    popD();
+    return;
+  }
+
+  // The pop's own decrement is folded into the pending adjustment.
+  const int adjust = m_spOffset - 1;
+  m_spOffset = 0;
+
+  emitA("SP");
+  if (adjust == 0) {
+    emitC("A", "M");
+  } else {
+    for (int step{1}; step < std::abs(adjust); ++step)
+      emitC("M", adjust > 0 ? "M+1" : "M-1");
+    emitC("AM", adjust > 0 ? "M+1" : "M-1");
+  }
+  emitC("D", "M");
+}
+
+void CodeWriter::flushStackPointer() {
+  if (m_spOffset == 0)
+    return;
+
+  // Step SP one word at a time so D survives the flush.
+  emitA("SP");
+  for (int step{}; step < std::abs(m_spOffset); ++step)
+    emitC("M", m_spOffset > 0 ? "M+1" : "M-1");
+  m_spOffset = 0;
+}
+
 void CodeWriter::writeArithmetic(const std::string& command) {
-    m_output_file << "// " << command << "\n";
+    m_sink.comment(command);
 
     if (command == "add" || command == "sub" || command == "and" || command == "or") {
-        m_output_file <<
-            "@SP\n"
-            "AM=M-1\n"
-            "D=M\n"
-            "A=A-1\n";
+        popD();
+        emitC("A", "A-1");
 
         if (command == "add")
-         m_output_file << "M=M+D\n";
+         emitC("M", "M+D");
         else if (command == "sub")
-         m_output_file << "M=M-D\n";
+         emitC("M", "M-D");
         else if (command == "and")
-         m_output_file << "M=M&D\n";
-        else 
-         m_output_file << "M=M|D\n";
+         emitC("M", "M&D");
+        else
+         emitC("M", "M|D");
     }
 
     else if (command == "neg" || command == "not") {
-        m_output_file <<
-            "@SP\n"
-            "A=M-1\n";
+        addressStack(-1);
 
         if (command == "neg")
-         m_output_file << "M=-M\n";
+         emitC("M", "-M");
         else
-         m_output_file << "M=!M\n";
+         emitC("M", "!M");
     }
 
     else if (command == "eq" || command == "gt" || command == "lt") {
-        std::string trueLabel = "TRUE" + std::to_string(m_labelCounter);
-        std::string endLabel  = "END"  + std::to_string(m_labelCounter);
-        ++m_labelCounter;
-
-        m_output_file <<
-            "@SP\n"
-            "AM=M-1\n"
-            "D=M\n"
-            "A=A-1\n"
-            "D=M-D\n"
-            "@" << trueLabel << "\n";
-
-        if (command == "eq")      
-          m_output_file << "D;JEQ\n";
-        else if (command == "gt") 
-          m_output_file << "D;JGT\n";
-        else 
-          m_output_file << "D;JLT\n";
-
-        m_output_file <<
-            "@SP\n"
-            "A=M-1\n"
-            "M=0\n"
-            "@" << endLabel << "\n"
-            "0;JMP\n"
-            "(" << trueLabel << ")\n"
-            "@SP\n"
-            "A=M-1\n"
-            "M=-1\n"
-            "(" << endLabel << ")\n";
+        const std::string id = std::to_string(m_labelCounter++);
+        const std::string trueLabel = m_static_base + "$TRUE" + id;
+        const std::string endLabel  = m_static_base + "$END"  + id;
+
+        // Both branches write the result slot, so any flush must happen before the jump.
+        if (std::abs(m_spOffset - 2) > 2)
+          flushStackPointer();
+
+        popD();
+        emitC("A", "A-1");
+        emitC("D", "M-D");
+        emitA(trueLabel);
+
+        if (command == "eq")
+          emitC("", "D", "JEQ");
+        else if (command == "gt")
+          emitC("", "D", "JGT");
+        else
+          emitC("", "D", "JLT");
+
+        const std::size_t falseStart = m_emitted;
+        addressStack(-1);
+        emitC("M", "0");
+        emitA(endLabel);
+        emitC("", "0", "JMP");
+        emitLabel(trueLabel);
+        const std::size_t trueStart = m_emitted;
+        addressStack(-1);
+        emitC("M", "-1");
+        emitLabel(endLabel);
+
+        // Only one of the two result writes runs.
+        m_pathLength -= std::min(trueStart - falseStart, m_emitted - trueStart);
+    }
+
+    else if (command == "drop") {
+        if (m_options.spBatching) {
+          --m_spOffset;
+        } else {
+          emitA("SP");
+          emitC("M", "M-1");
+        }
     }
 
     else
@@ -86,63 +210,34 @@ void CodeWriter::writeArithmetic(const std::string& command) {
 }
 
 void CodeWriter::writePushPop(CommandType cmdType, const std::string& segment, uint32_t idx) {
-    const std::string i = std::to_string(idx);
-
     if (cmdType == C_PUSH) {
         if (segment == "constant") {
-            m_output_file <<
-                "@" << i << "\n"
-                "D=A\n"
-                "@SP\n"
-                "A=M\n"
-                "M=D\n"
-                "@SP\n"
-                "M=M+1\n";
+            writePushConstant(static_cast<uint16_t>(idx));
         }
         else if (segment == "local" || segment == "argument" || segment == "this" || segment == "that") {
             const std::string base = (segment == "local") ? "LCL" : (segment == "argument") ? "ARG" : (segment == "this") ? "THIS" : "THAT";
-            m_output_file <<
-                "@" << base << "\n"
-                "D=M\n"
-                "@" << i << "\n"
-                "A=D+A\n"
-                "D=M\n"
-                "@SP\n"
-                "A=M\n"
-                "M=D\n"
-                "@SP\n"
-                "M=M+1\n";
+            emitA(base);
+            emitC("D", "M");
+            emitA(idx);
+            emitC("A", "D+A");
+            emitC("D", "M");
+            pushD();
         }
         else if (segment == "temp") {
-            m_output_file <<
-                "@R" << (5 + idx) << "\n"
-                "D=M\n"
-                "@SP\n"
-                "A=M\n"
-                "M=D\n"
-                "@SP\n"
-                "M=M+1\n";
+            emitA("R" + std::to_string(5 + idx));
+            emitC("D", "M");
+            pushD();
         }
         else if (segment == "pointer") {
             const std::string ptr = (idx == 0) ? "THIS" : "THAT";
-            m_output_file <<
-                "@" << ptr << "\n"
-                "D=M\n"
-                "@SP\n"
-                "A=M\n"
-                "M=D\n"
-                "@SP\n"
-                "M=M+1\n";
+            emitA(ptr);
+            emitC("D", "M");
+            pushD();
         }
         else if (segment == "static") {
-            m_output_file <<
-                "@" << m_static_base << "." << idx << "\n"
-                "D=M\n"
-                "@SP\n"
-                "A=M\n"
-                "M=D\n"
-                "@SP\n"
-                "M=M+1\n";
+            emitA(m_static_base + "." + std::to_string(idx));
+            emitC("D", "M");
+            pushD();
         }
         else {
             throw std::runtime_error("Unknown segment in push: " + segment);
@@ -151,44 +246,32 @@ void CodeWriter::writePushPop(CommandType cmdType, const std::string& segment, u
     else if (cmdType == C_POP) {
         if (segment == "local" || segment == "argument" || segment == "this" || segment == "that") {
             const std::string base = (segment == "local") ? "LCL" : (segment == "argument") ? "ARG" : (segment == "this") ? "THIS" : "THAT";
-            m_output_file <<
-                "@" << base << "\n"
-                "D=M\n"
-                "@" << i << "\n"
-                "D=D+A\n"
-                "@R13\n"
-                "M=D\n"
-                "@SP\n"
-                "AM=M-1\n"
-                "D=M\n"
-                "@R13\n"
-                "A=M\n"
-                "M=D\n";
+            emitA(base);
+            emitC("D", "M");
+            emitA(idx);
+            emitC("D", "D+A");
+            emitA("R13");
+            emitC("M", "D");
+            popD();
+            emitA("R13");
+            emitC("A", "M");
+            emitC("M", "D");
         }
         else if (segment == "temp") {
-            m_output_file <<
-                "@SP\n"
-                "AM=M-1\n"
-                "D=M\n"
-                "@R" << (5 + idx) << "\n"
-                "M=D\n";
+            popD();
+            emitA("R" + std::to_string(5 + idx));
+            emitC("M", "D");
         }
         else if (segment == "pointer") {
             const std::string ptr = (idx == 0) ? "THIS" : "THAT";
-            m_output_file <<
-                "@SP\n"
-                "AM=M-1\n"
-                "D=M\n"
-                "@" << ptr << "\n"
-                "M=D\n";
+            popD();
+            emitA(ptr);
+            emitC("M", "D");
         }
         else if (segment == "static") {
-            m_output_file <<
-                "@SP\n"
-                "AM=M-1\n"
-                "D=M\n"
-                "@" << m_static_base << "." << idx << "\n"
-                "M=D\n";
+            popD();
+            emitA(m_static_base + "." + std::to_string(idx));
+            emitC("M", "D");
         }
         else {
             throw std::runtime_error("Unknown segment in pop: " + segment);
@@ -199,182 +282,292 @@ void CodeWriter::writePushPop(CommandType cmdType, const std::string& segment, u
     }
 }
 
+void CodeWriter::writePushConstant(uint16_t word) {
+  if (m_options.aluConstants && (word == 0 || word == 1 || word == 0xFFFF)) {
+    if (m_options.spBatching) {
+      addressStack(0);
+      ++m_spOffset;
+    } else {
+      emitA("SP");
+      emitC("M", "M+1");
+      emitC("A", "M-1");
+    }
+    emitC("M", word == 0 ? "0" : word == 1 ? "1" : "-1");
+    return;
+  }
+
+  if (word <= 0x7FFF) {
+    emitA(static_cast<uint32_t>(word));
+    emitC("D", "A");
+  } else if (word != 0x8000) {
+    emitA(static_cast<uint32_t>(0x10000 - word));
+    emitC("D", "-A");
+  } else {
+    emitA(0x7FFFu);
+    emitC("D", "!A");
+  }
+  pushD();
+}
+
 std::string CodeWriter::qualifyLabel(const std::string& label) const {
   return m_current_func.empty() ? label : (m_current_func + "$" + label);
 }
 
 void CodeWriter::writeLabel(const std::string& label) {
-  m_output_file << "(" << qualifyLabel(label) << ")" << '\n';
+  flushStackPointer();
+  emitLabel(qualifyLabel(label));
 }
 
 void CodeWriter::writeGoto(const std::string& label) {
-  m_output_file << "@" << qualifyLabel(label) << '\n'
-                << "0;JMP" << '\n';
+  flushStackPointer();
+  emitA(qualifyLabel(label));
+  emitC("", "0", "JMP");
 }
 
 void CodeWriter::writeIf(const std::string& label) {
-  m_output_file 
-    << "@SP" <<                      '\n'
-    << "AM=M-1" <<                   '\n'
-    << "D=M" <<                      '\n'
-    << "@" << qualifyLabel(label) << '\n'
-    << "D;JNE" <<                    '\n';
+  popDCommitted();
+  emitA(qualifyLabel(label));
+  emitC("", "D", "JNE");
 }
 
-void CodeWriter::writeCall(const std::string& functionName, uint32_t nArgs) {
+void CodeWriter::writeCall(const std::string& functionName, uint32_t nArgs, const FrameLayout& callee) {
   const std::string ret =
-      (m_current_func.empty() ? "" : m_current_func + "$")
-      + "ret." + std::to_string(m_labelCounter++);
-
-  m_output_file
-    << "@" << ret << "\n"
-    << "D=A\n"
-    << "@SP\n"
-    << "A=M\n"
-    << "M=D\n"
-    << "@SP\n"
-    << "M=M+1\n";
-
-  m_output_file
-    << "@LCL\n"
-    << "D=M\n"
-    << "@SP\n"
-    << "A=M\n"
-    << "M=D\n"
-    << "@SP\n"
-    << "M=M+1\n";
-
-  m_output_file
-    << "@ARG\n"
-    << "D=M\n"
-    << "@SP\n"
-    << "A=M\n"
-    << "M=D\n"
-    << "@SP\n"
-    << "M=M+1\n";
-
-  m_output_file
-    << "@THIS\n"
-    << "D=M\n"
-    << "@SP\n"
-    << "A=M\n"
-    << "M=D\n"
-    << "@SP\n"
-    << "M=M+1\n";
-
-  m_output_file
-    << "@THAT\n"
-    << "D=M\n"
-    << "@SP\n"
-    << "A=M\n"
-    << "M=D\n"
-    << "@SP\n"
-    << "M=M+1\n";
-
-  m_output_file
-    << "@SP\n"
-    << "D=M\n"
-    << "@5\n"
-    << "D=D-A\n"
-    << "@" << nArgs << "\n"
-    << "D=D-A\n"
-    << "@ARG\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@SP\n"
-    << "D=M\n"
-    << "@LCL\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@" << functionName << "\n"
-    << "0;JMP\n";
-
-  m_output_file
-    << "(" << ret << ")\n";
+      (m_current_func.empty() ? m_static_base : m_current_func)
+      + "$ret." + std::to_string(m_labelCounter++);
+
+  flushStackPointer();
+  emitA(ret);
+  emitC("D", "A");
+  pushD();
+
+  for (std::string_view saved : { "LCL", "ARG", "THIS", "THAT" }) {
+    if ((saved == "THIS" && !callee.saveThis) || (saved == "THAT" && !callee.saveThat))
+      continue;
+    emitA(saved);
+    emitC("D", "M");
+    pushD();
+  }
+  flushStackPointer();
+
+  // ARG = SP - frame - nArgs
+  emitA("SP");
+  emitC("D", "M");
+  emitA(callee.size());
+  emitC("D", "D-A");
+  emitA(nArgs);
+  emitC("D", "D-A");
+  emitA("ARG");
+  emitC("M", "D");
+
+  // LCL = SP
+  emitA("SP");
+  emitC("D", "M");
+  emitA("LCL");
+  emitC("M", "D");
+
+  emitA(functionName);
+  emitC("", "0", "JMP");
+
+  emitLabel(ret);
+}
+
+void CodeWriter::writeTailCall(const std::string& functionName, uint32_t nArgs, uint32_t callerArgs,
+                               const FrameLayout& callee) {
+  if (nArgs > callerArgs)
+    throw std::logic_error("[ERROR] Tail call to " + functionName + " passes more arguments than the caller received");
+  if (callee != m_frame)
+    throw std::logic_error("[ERROR] Tail call to " + functionName + " needs a different frame layout");
+
+  m_sink.comment("tail call " + functionName);
+  flushStackPointer();
+
+  // Slide the saved frame (LCL-frame .. LCL-1) down to ARG+nArgs; the target lies below the source, so copy upwards.
+  if (nArgs < callerArgs) {
+    emitA("LCL");
+    emitC("D", "M");
+    emitA(m_frame.size() + 1);
+    emitC("D", "D-A");
+    emitA("R13");
+    emitC("M", "D");
+
+    emitA("ARG");
+    if (nArgs == 0) {
+      emitC("D", "M-1");
+    } else {
+      emitC("D", "M");
+      if (nArgs > 1) {
+        emitA(nArgs - 1);
+        emitC("D", "D+A");
+      }
+    }
+    emitA("R14");
+    emitC("M", "D");
+
+    for (uint32_t word{}; word < m_frame.size(); ++word) {
+      emitA("R13");
+      emitC("AM", "M+1");
+      emitC("D", "M");
+      emitA("R14");
+      emitC("AM", "M+1");
+      emitC("M", "D");
+    }
+  }
+
+  // ARG[nArgs-1 .. 0] = pop()
+  if (nArgs == 1) {
+    popD();
+    emitA("ARG");
+    emitC("A", "M");
+    emitC("M", "D");
+  } else if (nArgs > 1) {
+    emitA("ARG");
+    emitC("D", "M");
+    emitA(nArgs);
+    emitC("D", "D+A");
+    emitA("R13");
+    emitC("M", "D");
+
+    for (uint32_t i{}; i < nArgs; ++i) {
+      popD();
+      emitA("R13");
+      emitC("AM", "M-1");
+      emitC("M", "D");
+    }
+  }
+
+  // LCL = SP = ARG + nArgs + frame
+  emitA("ARG");
+  emitC("D", "M");
+  emitA(nArgs + m_frame.size());
+  emitC("D", "D+A");
+  emitA("LCL");
+  emitC("M", "D");
+  emitA("SP");
+  emitC("M", "D");
+  m_spOffset = 0;
+
+  emitA(functionName);
+  emitC("", "0", "JMP");
 }
 
 void CodeWriter::setCurrentFile(std::string base) {
   m_static_base = std::move(base);
 }
 
-void CodeWriter::writeFunction(const std::string& functionName, uint32_t nLocals) {
+void CodeWriter::setOptions(const TranslatorOptions& options) { m_options = options; }
+
+void CodeWriter::writeFunction(const std::string& functionName, uint32_t nLocals, const FrameLayout& frame) {
   m_current_func = functionName;
+  m_frame = frame;
 
-  m_output_file << "(" << functionName << ")\n";
+  flushStackPointer();
+  emitLabel(functionName);
 
   for (uint32_t i{}; i < nLocals; ++i) {
-    m_output_file
-      << "@0\n"
-      << "D=A\n"
-      << "@SP\n"
-      << "A=M\n"
-      << "M=D\n"
-      << "@SP\n"
-      << "M=M+1\n";
+    emitA(0u);
+    emitC("D", "A");
+    pushD();
   }
 }
 
 void CodeWriter::writeReturn() {
-  m_output_file
-    << "@LCL\n"
-    << "D=M\n"
-    << "@R13\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@5\n"
-    << "A=D-A\n"
-    << "D=M\n"
-    << "@R14\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@SP\n"
-    << "AM=M-1\n"
-    << "D=M\n"
-    << "@ARG\n"
-    << "A=M\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@ARG\n"
-    << "D=M+1\n"
-    << "@SP\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@R13\n"
-    << "AM=M-1\n"
-    << "D=M\n"
-    << "@THAT\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@R13\n"
-    << "AM=M-1\n"
-    << "D=M\n"
-    << "@THIS\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@R13\n"
-    << "AM=M-1\n"
-    << "D=M\n"
-    << "@ARG\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@R13\n"
-    << "AM=M-1\n"
-    << "D=M\n"
-    << "@LCL\n"
-    << "M=D\n";
-
-  m_output_file
-    << "@R14\n"
-    << "A=M\n"
-    << "0;JMP\n";
+  // FRAME = LCL
+  emitA("LCL");
+  emitC("D", "M");
+  emitA("R13");
+  emitC("M", "D");
+
+  // RET = *(FRAME - frame)
+  emitA(m_frame.size());
+  emitC("A", "D-A");
+  emitC("D", "M");
+  emitA("R14");
+  emitC("M", "D");
+
+  // *ARG = pop(), unless no caller wants the value
+  if (m_frame.returnsValue) {
+    popD();
+    emitA("ARG");
+    emitC("A", "M");
+    emitC("M", "D");
+  }
+  m_spOffset = 0;
+
+  // SP = ARG + 1, or ARG without a value
+  emitA("ARG");
+  emitC("D", m_frame.returnsValue ? "M+1" : "M");
+  emitA("SP");
+  emitC("M", "D");
+
+  // THAT, THIS, ARG, LCL = *(--FRAME)
+  for (std::string_view restored : { "THAT", "THIS", "ARG", "LCL" }) {
+    if ((restored == "THIS" && !m_frame.saveThis) || (restored == "THAT" && !m_frame.saveThat))
+      continue;
+    emitA("R13");
+    emitC("AM", "M-1");
+    emitC("D", "M");
+    emitA(restored);
+    emitC("M", "D");
+  }
+
+  emitA("R14");
+  emitC("A", "M");
+  emitC("", "0", "JMP");
+}
+
+void CodeWriter::writeAsm(const std::string& instruction) {
+  flushStackPointer();
+  const auto malformed = [&instruction] {
+    return std::runtime_error("[ERROR] Invalid asm instruction: " + instruction);
+  };
+
+  if (instruction.size() > 2 && instruction.front() == '(' && instruction.back() == ')') {
+    emitLabel(std::string_view(instruction).substr(1, instruction.size() - 2));
+    return;
+  }
+
+  if (instruction.size() > 1 && instruction.front() == '@') {
+    const std::string_view operand = std::string_view(instruction).substr(1);
+    if (std::isdigit(static_cast<unsigned char>(operand.front()))) {
+      uint32_t value{};
+      const auto [end, error] = std::from_chars(operand.data(), operand.data() + operand.size(), value);
+      if (error != std::errc{} || end != operand.data() + operand.size() || value > 0x7FFF)
+        throw malformed();
+      emitA(value);
+    } else {
+      emitA(operand);
+    }
+    return;
+  }
+
+  // dest=comp;jump, where dest and jump are optional
+  const std::size_t equals = instruction.find('=');
+  const std::size_t semicolon = instruction.find(';');
+  const std::size_t compFirst = (equals == std::string::npos) ? 0 : equals + 1;
+  const std::size_t compLast = (semicolon == std::string::npos) ? instruction.size() : semicolon;
+  if (compFirst >= compLast || (semicolon != std::string::npos && semicolon + 1 == instruction.size()))
+    throw malformed();
+
+  const std::string_view text(instruction);
+  const std::string_view dest = (equals == std::string::npos) ? std::string_view{} : text.substr(0, equals);
+  const std::string_view comp = text.substr(compFirst, compLast - compFirst);
+  const std::string_view jump = (semicolon == std::string::npos) ? std::string_view{} : text.substr(semicolon + 1);
+  // The encoder maps unknown mnemonics to 0, so check them here.
+  if (!Code::isDest(dest) || !Code::isComp(comp) || !Code::isJump(jump))
+    throw malformed();
+  emitC(dest, comp, jump);
+}
+
+void CodeWriter::append(const std::string& assembly) {
+  if (!m_asm)
+    throw std::logic_error("[ERROR] append() requires an assembly text output");
+  m_asm->append(assembly);
+}
+
+void CodeWriter::close() {
+  flushStackPointer();
+  if (m_output_file.is_open())
+    m_output_file.close();
+  else if (m_asm)
+    m_asm->flush();
 }
-void CodeWriter::close() { m_output_file.close(); }
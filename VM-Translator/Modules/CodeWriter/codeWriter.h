@@ -4,29 +4,77 @@
  * @file codeWriter.h
  * @brief Interface for translating VM commands into Hack assembly.
  */
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <memory>
+#include <ostream>
+#include <string_view>
 #include "../Utils/CommandType.h"
+#include "../Utils/FrameLayout.h"
+#include "../Utils/TranslatorOptions.h"
+#include "asmSink.h"
+#include "instructionSink.h"
 
 
 /**
- * @brief Emits Hack assembly for a stream of VM commands.
+ * @brief Emits Hack instructions for a stream of VM commands.
+ *
+ * Instructions go to an InstructionSink: an owned AsmSink when writing
+ * assembly text, or a caller-provided sink such as HackWriter.
  */
 class CodeWriter {
   private:
-    /** @brief Output stream for emitted assembly. */
+    /** @brief Backing file when the writer owns its output. */
     std::ofstream m_output_file;
+    /** @brief Owned text sink; null when emitting into an external sink. */
+    std::unique_ptr<AsmSink> m_asm;
+    /** @brief Sink every instruction is emitted to. */
+    InstructionSink& m_sink;
     /** @brief Target output filename. */
     std::string m_file_name;
-    /** @brief Monotonic counter used to generate unique labels. */
+    /** @brief Per-writer counter; labels are further namespaced by the current file. */
     int m_labelCounter{};
 
     std::string m_current_func;
 
+    /** @brief Frame layout of the current function, used by its return and tail calls. */
+    FrameLayout m_frame;
+
     std::string qualifyLabel(const std::string& label) const;
 
     std::string m_static_base {"Static"};
-  
+
+    /** @brief Enabled code-generation improvements. */
+    TranslatorOptions m_options;
+
+    /** @brief Instructions emitted so far. */
+    std::size_t m_emitted{};
+    /** @brief Instructions on the longest path through the code emitted so far. */
+    std::size_t m_pathLength{};
+
+    /** @brief Stack growth not yet written to `SP` (spBatching only): the real top is `RAM[SP] + m_spOffset`. */
+    int m_spOffset{};
+
+    /** @brief Emits `@symbol`. */
+    void emitA(std::string_view symbol);
+    /** @brief Emits `@value`. */
+    void emitA(uint32_t value);
+    /** @brief Emits `dest=comp;jump`; empty fields are omitted. */
+    void emitC(std::string_view dest, std::string_view comp, std::string_view jump = {});
+    /** @brief Emits a `(label)` declaration. */
+    void emitLabel(std::string_view label);
+    /** @brief Pushes D onto the stack: `*SP = D; SP++`. */
+    void pushD();
+    /** @brief Pops the stack top into D: `SP--; D = *SP`. */
+    void popD();
+    /**
+     * @brief Points A at a stack slot relative to the (possibly pending) stack top.
+     * @param fromTop 0 for the next free slot, -1 for the top element. D is preserved.
+     */
+    void addressStack(int fromTop);
+    /** @brief Pops into D and commits any pending offset to `SP` at the same time. */
+    void popDCommitted();
 
   public:
     /**
@@ -34,11 +82,27 @@ class CodeWriter {
      * @param fileName Path to the output `.asm` file.
      */
     CodeWriter(const std::string& fileName);
+
+    /**
+     * @brief Constructs a writer that emits assembly into a caller-owned stream.
+     *
+     * Used to translate each `.vm` file into its own buffer before the buffers
+     * are concatenated into the final `.asm`.
+     * @param out Stream that outlives the writer.
+     */
+    explicit CodeWriter(std::ostream& out);
+
+    /**
+     * @brief Constructs a writer that emits instructions into a caller-owned sink.
+     * @param sink Sink that outlives the writer (e.g. a HackWriter for machine code).
+     */
+    explicit CodeWriter(InstructionSink& sink);
     CodeWriter(const CodeWriter&) = delete;
 
     /**
      * @brief Writes assembly for an arithmetic/logic VM command.
-     * @param cmd One of: "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not".
+     * @param cmd One of: "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not",
+     *            or the translator-internal "drop" (discard the top word).
      */
     void writeArithmetic(const std::string& cmd);
     
@@ -55,19 +119,99 @@ class CodeWriter {
      */
     void writePushPop(CommandType cmdType, const std::string& segment, uint32_t idx);
 
+    /**
+     * @brief Pushes an arbitrary 16-bit word using the cheapest sequence.
+     *
+     * With `aluConstants` enabled, 0, 1 and -1 are written straight from the
+     * ALU (`M=0`, `M=1`, `M=-1`) without a D round-trip; other negative words
+     * are loaded with `D=-A` or `D=!A`.
+     * @param word Two's-complement value to push.
+     */
+    void writePushConstant(uint16_t word);
+
     void writeLabel(const std::string& label);
 
     void writeGoto(const std::string& label);
 
     void writeIf(const std::string& label);
 
-    void writeFunction(const std::string& functionName, uint32_t nVars);
+    /**
+     * @brief Writes a function entry point and zero-initializes its locals.
+     * @param frame Layout its callers push; the function's `return` restores exactly these registers.
+     */
+    void writeFunction(const std::string& functionName, uint32_t nVars, const FrameLayout& frame = {});
+
+    /**
+     * @brief Writes a call: saves the caller's frame, repositions ARG/LCL and jumps.
+     * @param callee Layout the callee was declared with (full frame by default).
+     */
+    void writeCall(const std::string& functionName, uint32_t nArgs, const FrameLayout& callee = {});
 
-    void writeCall(const std::string& functionName, uint32_t nArgs);
+    /**
+     * @brief Writes `call functionName nArgs; return` as a jump that reuses the current frame.
+     *
+     * The new arguments overwrite the caller's own arguments, the saved frame
+     * slides down to sit right above them, and control jumps to the callee
+     * without pushing a return address: the callee's `return` goes straight
+     * back to the current function's caller. The callee must share the
+     * current function's frame layout.
+     * @param callerArgs Argument count of the current function; must be >= nArgs.
+     * @param callee     Layout the callee was declared with.
+     * @throws std::logic_error if nArgs exceeds callerArgs or the layouts differ.
+     */
+    void writeTailCall(const std::string& functionName, uint32_t nArgs, uint32_t callerArgs,
+                       const FrameLayout& callee = {});
 
+    /** @brief Writes a return; functions whose layout has no value discard whatever the stack holds. */
     void writeReturn();
 
+    /**
+     * @brief Writes one Hack instruction of an `asm` command unchanged.
+     *
+     * Any pending stack-pointer adjustment is written first, so the
+     * instruction sees the real `SP`.
+     * @param instruction `@value`, `@symbol`, `(label)` or `dest=comp;jump`.
+     * @throws std::runtime_error if the instruction is malformed.
+     */
+    void writeAsm(const std::string& instruction);
+
+    /**
+     * @brief Sets the current `.vm` file stem.
+     *
+     * The stem prefixes static symbols and the writer's generated labels, so
+     * files translated by independent writers never produce colliding labels.
+     */
     void setCurrentFile(std::string base);
+
+    /**
+     * @brief Writes any pending stack-pointer adjustment to `SP`.
+     *
+     * Called automatically before labels, jumps, calls and returns; callers
+     * must invoke it (or close()) after the last command of a file.
+     */
+    void flushStackPointer();
+
+    /** @brief Instructions (ROM words) emitted so far; labels and comments are free. */
+    std::size_t instructionCount() const { return m_emitted; }
+
+    /**
+     * @brief Instructions executed on the longest path through everything emitted so far.
+     *
+     * Equals instructionCount() minus the shorter result write of every
+     * comparison; called functions are not followed.
+     */
+    std::size_t pathLength() const { return m_pathLength; }
+
+    /** @brief Selects the optional code-generation improvements. */
+    void setOptions(const TranslatorOptions& options);
+
+    /**
+     * @brief Appends already translated assembly verbatim to the output.
+     * @param assembly Assembly text produced by another writer.
+     * @throws std::logic_error if the writer does not produce assembly text.
+     */
+    void append(const std::string& assembly);
+
     /**
      * @brief Flushes and closes the underlying output stream.
      */
@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * @file instructionSink.h
+ * @brief Destination for the Hack instructions produced by CodeWriter.
+ */
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Receives Hack instructions one at a time, already split into fields.
+ *
+ * CodeWriter never formats instruction text itself; a sink either prints the
+ * instructions as assembly (AsmSink) or encodes them straight into machine
+ * words (HackWriter).
+ */
+class InstructionSink {
+  public:
+    virtual ~InstructionSink() = default;
+
+    /** @brief Annotates the following instructions (e.g. the VM command being translated). */
+    virtual void comment(std::string_view text) = 0;
+
+    /** @brief Declares a label bound to the address of the next instruction. */
+    virtual void label(std::string_view name) = 0;
+
+    /** @brief Emits `@symbol` (label, variable or predefined symbol). */
+    virtual void address(std::string_view symbol) = 0;
+
+    /** @brief Emits `@value` for a 15-bit constant. */
+    virtual void address(uint32_t value) = 0;
+
+    /**
+     * @brief Emits a C-instruction `dest=comp;jump`.
+     * @param dest Destination mnemonic, empty for none.
+     * @param comp Computation mnemonic.
+     * @param jump Jump mnemonic, empty for none.
+     */
+    virtual void compute(std::string_view dest, std::string_view comp, std::string_view jump) = 0;
+};
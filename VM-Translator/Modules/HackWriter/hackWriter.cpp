@@ -0,0 +1,127 @@
+#include "hackWriter.h"
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t MAX_ADDRESS   { 0x7FFF };
+constexpr std::size_t ROM_SIZE   { 32768 };
+constexpr uint16_t FIRST_VAR_RAM { 16 };
+
+std::unordered_map<std::string, uint16_t> predefinedSymbols() {
+  std::unordered_map<std::string, uint16_t> symbols {
+    { "SP",     0 },
+    { "LCL",    1 },
+    { "ARG",    2 },
+    { "THIS",   3 },
+    { "THAT",   4 },
+    { "SCREEN", 16384 },
+    { "KBD",    24576 },
+  };
+  for (uint16_t r{}; r < 16; ++r)
+    symbols.emplace("R" + std::to_string(r), r);
+  return symbols;
+}
+
+} // namespace
+
+void HackWriter::comment(std::string_view) {}
+
+void HackWriter::label(std::string_view name) {
+  m_labels.emplace_back(std::string(name), m_words.size());
+}
+
+void HackWriter::address(std::string_view symbol) {
+  m_fixups.push_back({ m_words.size(), std::string(symbol) });
+  m_words.push_back(0);
+}
+
+void HackWriter::address(uint32_t value) {
+  if (value > MAX_ADDRESS)
+    throw std::runtime_error("[ERROR] A-instruction constant out of range: " + std::to_string(value));
+  m_words.push_back(static_cast<uint16_t>(value));
+}
+
+void HackWriter::compute(std::string_view dest, std::string_view comp, std::string_view jump) {
+  uint16_t instruction = (0b111 << 13)
+                       | (m_code.comp(comp) << 6)
+                       | (m_code.dest(dest) << 3)
+                       | (m_code.jump(jump));
+  m_words.push_back(instruction);
+}
+
+const std::vector<uint16_t>& HackWriter::words() const { return m_words; }
+
+const std::vector<Fixup>& HackWriter::fixups() const { return m_fixups; }
+
+const std::vector<std::pair<std::string, std::size_t>>& HackWriter::labels() const { return m_labels; }
+
+std::vector<uint16_t> linkHack(const std::vector<HackWriter>& units) {
+  // First pass: place units and bind labels to absolute ROM addresses.
+  std::unordered_map<std::string, uint16_t> labels;
+  std::size_t romSize {};
+  for (const HackWriter& unit : units) {
+    for (const auto& [name, offset] : unit.labels()) {
+      if (!labels.emplace(name, static_cast<uint16_t>(romSize + offset)).second)
+        throw std::runtime_error("[ERROR] Duplicate label: " + name);
+    }
+    romSize += unit.words().size();
+  }
+
+  if (romSize > ROM_SIZE)
+    throw std::runtime_error("[ERROR] Program does not fit in ROM: " + std::to_string(romSize) + " words");
+
+  // Second pass: copy words and patch symbolic references.
+  const auto predefined = predefinedSymbols();
+  std::unordered_map<std::string, uint16_t> variables;
+  uint16_t nextRAMAddress { FIRST_VAR_RAM };
+
+  std::vector<uint16_t> rom;
+  rom.reserve(romSize);
+  for (const HackWriter& unit : units) {
+    const std::size_t base { rom.size() };
+    rom.insert(rom.end(), unit.words().begin(), unit.words().end());
+
+    for (const Fixup& fixup : unit.fixups()) {
+      uint16_t address {};
+      if (auto it = labels.find(fixup.symbol); it != labels.end())
+        address = it->second;
+      else if (auto pre = predefined.find(fixup.symbol); pre != predefined.end())
+        address = pre->second;
+      else {
+        auto [var, inserted] = variables.try_emplace(fixup.symbol, nextRAMAddress);
+        if (inserted)
+          ++nextRAMAddress;
+        address = var->second;
+      }
+
+      rom[base + fixup.word] = address;
+    }
+  }
+
+  return rom;
+}
+
+void writeRom(const std::string& path, const std::vector<uint16_t>& rom) {
+  const bool text { std::filesystem::path(path).extension() == ".hack" };
+
+  std::ofstream out(path, text ? std::ios::out : std::ios::out | std::ios::binary);
+  if (!out)
+    throw std::runtime_error("[ERROR] Failed to open output: " + path);
+
+  for (uint16_t word : rom) {
+    if (text) {
+      out << std::bitset<16>(word).to_string() << '\n';
+    } else {
+      const char bytes[2] { static_cast<char>(word & 0xFF), static_cast<char>(word >> 8) };
+      out.write(bytes, sizeof(bytes));
+    }
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/**
+ * @file hackWriter.h
+ * @brief InstructionSink that encodes Hack machine code directly, plus the
+ *        linker that joins per-file units into a ROM image.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../CodeWriter/instructionSink.h"
+#include "../../../Assembler/Modules/Code/code.h"
+
+/**
+ * @brief A-instruction whose symbol is resolved at link time.
+ */
+struct Fixup {
+  /** @brief Index of the placeholder word within its unit. */
+  std::size_t word;
+  /** @brief Label, variable or predefined symbol referenced by the word. */
+  std::string symbol;
+};
+
+/**
+ * @brief Encodes instructions into 16-bit words as CodeWriter emits them.
+ *
+ * One HackWriter holds the machine code of one translation unit (a `.vm`
+ * file). Symbolic A-instructions are left as zero words with a Fixup; labels
+ * are recorded relative to the start of the unit. linkHack() places the
+ * units one after another and patches every fixup.
+ */
+class HackWriter : public InstructionSink {
+  private:
+    /** @brief Shared dest/comp/jump encoding tables from the assembler. */
+    Code m_code;
+    /** @brief Encoded instructions of this unit. */
+    std::vector<uint16_t> m_words;
+    /** @brief Symbolic A-instructions awaiting resolution. */
+    std::vector<Fixup> m_fixups;
+    /** @brief Labels declared in this unit with their unit-relative address. */
+    std::vector<std::pair<std::string, std::size_t>> m_labels;
+
+  public:
+    HackWriter() = default;
+
+    void comment(std::string_view text) override;
+    void label(std::string_view name) override;
+    void address(std::string_view symbol) override;
+    void address(uint32_t value) override;
+    void compute(std::string_view dest, std::string_view comp, std::string_view jump) override;
+
+    /** @brief Encoded words of this unit (fixup slots hold zero). */
+    const std::vector<uint16_t>& words() const;
+
+    /** @brief Unresolved symbolic references of this unit. */
+    const std::vector<Fixup>& fixups() const;
+
+    /** @brief Labels declared in this unit, relative to its first word. */
+    const std::vector<std::pair<std::string, std::size_t>>& labels() const;
+};
+
+/**
+ * @brief Concatenates units in order and resolves all symbols.
+ *
+ * Labels resolve to ROM addresses, the Hack predefined symbols (SP, LCL,
+ * ARG, THIS, THAT, R0-R15, SCREEN, KBD) to their fixed RAM addresses, and
+ * any other symbol is allocated a RAM address from 16 upwards in order of
+ * first use, exactly as the assembler's second pass does.
+ * @throws std::runtime_error on duplicate labels or a ROM overflow.
+ */
+std::vector<uint16_t> linkHack(const std::vector<HackWriter>& units);
+
+/**
+ * @brief Writes a linked ROM image.
+ *
+ * A `.hack` path gets one 16-character binary string per line (the
+ * assembler's format); any other extension gets raw little-endian words.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeRom(const std::string& path, const std::vector<uint16_t>& rom);
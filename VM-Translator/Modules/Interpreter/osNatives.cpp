@@ -0,0 +1,136 @@
+#include "osNatives.h"
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+constexpr Word kNewLine    { 128 };
+constexpr Word kBackSpace  { 129 };
+constexpr Word kDoubleQuote{ 34 };
+
+[[noreturn]] void osError(int code, const char* what) {
+  throw std::runtime_error("[ERROR] Sys.error(" + std::to_string(code) + "): " + what);
+}
+
+Word stringLength(const VmInterpreter& vm, Word str)            { return vm.peek(static_cast<Word>(str + 1)); }
+Word stringChar(const VmInterpreter& vm, Word str, Word i)      { return vm.peek(static_cast<Word>(str + 2 + i)); }
+
+void appendChar(VmInterpreter& vm, Word str, Word c) {
+  const Word length = stringLength(vm, str);
+  if (length >= vm.peek(str))
+    osError(17, "String.appendChar: string is full");
+  vm.poke(static_cast<Word>(str + 2 + length), c);
+  vm.poke(static_cast<Word>(str + 1), static_cast<Word>(length + 1));
+}
+
+void printChar(VmInterpreter& vm, Word c) {
+  if (c == kNewLine)
+    vm.output() << '\n';
+  else if (c != kBackSpace)
+    vm.output() << static_cast<char>(c);
+}
+
+const NativeRoutine kNatives[] = {
+  { "Math.multiply", 2, [](VmInterpreter&, const Word* a) -> Word { return static_cast<Word>(a[0] * a[1]); } },
+  { "Math.divide", 2, [](VmInterpreter&, const Word* a) -> Word {
+      if (a[1] == 0) osError(3, "Math.divide: division by zero");
+      return static_cast<Word>(a[0] / a[1]);
+    } },
+  // Compared like `lt`/`gt`, by the sign of the wrapped difference, as the Jack OS does.
+  { "Math.min", 2, [](VmInterpreter&, const Word* a) -> Word { return static_cast<Word>(a[0] - a[1]) < 0 ? a[0] : a[1]; } },
+  { "Math.max", 2, [](VmInterpreter&, const Word* a) -> Word { return static_cast<Word>(a[0] - a[1]) > 0 ? a[0] : a[1]; } },
+  { "Math.abs", 1, [](VmInterpreter&, const Word* a) -> Word { return static_cast<Word>(a[0] < 0 ? -a[0] : a[0]); } },
+  { "Math.sqrt", 1, [](VmInterpreter&, const Word* a) -> Word {
+      if (a[0] < 0) osError(4, "Math.sqrt: negative argument");
+      Word root{};
+      while ((root + 1) * (root + 1) <= a[0]) ++root;
+      return root;
+    } },
+
+  { "Memory.peek", 1, [](VmInterpreter& vm, const Word* a) -> Word { return vm.peek(a[0]); } },
+  { "Memory.poke", 2, [](VmInterpreter& vm, const Word* a) -> Word { vm.poke(a[0], a[1]); return 0; } },
+  { "Memory.alloc", 1, [](VmInterpreter& vm, const Word* a) -> Word {
+      if (a[0] <= 0) osError(5, "Memory.alloc: size must be positive");
+      return vm.alloc(a[0]);
+    } },
+  { "Memory.deAlloc", 1, [](VmInterpreter&, const Word*) -> Word { return 0; } },
+  { "Array.new", 1, [](VmInterpreter& vm, const Word* a) -> Word {
+      if (a[0] <= 0) osError(2, "Array.new: size must be positive");
+      return vm.alloc(a[0]);
+    } },
+  { "Array.dispose", 1, [](VmInterpreter&, const Word*) -> Word { return 0; } },
+
+  { "String.new", 1, [](VmInterpreter& vm, const Word* a) -> Word {
+      if (a[0] < 0) osError(14, "String.new: negative length");
+      const Word str = vm.alloc(static_cast<Word>(a[0] + 2));
+      vm.poke(str, a[0]);
+      vm.poke(static_cast<Word>(str + 1), 0);
+      return str;
+    } },
+  { "String.dispose", 1, [](VmInterpreter&, const Word*) -> Word { return 0; } },
+  { "String.length", 1, [](VmInterpreter& vm, const Word* a) -> Word { return stringLength(vm, a[0]); } },
+  { "String.charAt", 2, [](VmInterpreter& vm, const Word* a) -> Word {
+      if (a[1] < 0 || a[1] >= stringLength(vm, a[0])) osError(15, "String.charAt: index out of bounds");
+      return stringChar(vm, a[0], a[1]);
+    } },
+  { "String.setCharAt", 3, [](VmInterpreter& vm, const Word* a) -> Word {
+      if (a[1] < 0 || a[1] >= stringLength(vm, a[0])) osError(16, "String.setCharAt: index out of bounds");
+      vm.poke(static_cast<Word>(a[0] + 2 + a[1]), a[2]);
+      return 0;
+    } },
+  { "String.appendChar", 2, [](VmInterpreter& vm, const Word* a) -> Word { appendChar(vm, a[0], a[1]); return a[0]; } },
+  { "String.eraseLastChar", 1, [](VmInterpreter& vm, const Word* a) -> Word {
+      const Word length = stringLength(vm, a[0]);
+      if (length == 0) osError(18, "String.eraseLastChar: string is empty");
+      vm.poke(static_cast<Word>(a[0] + 1), static_cast<Word>(length - 1));
+      return 0;
+    } },
+  { "String.intValue", 1, [](VmInterpreter& vm, const Word* a) -> Word {
+      const Word length = stringLength(vm, a[0]);
+      const bool negative = length > 0 && stringChar(vm, a[0], 0) == '-';
+      Word value{};
+      for (Word i = negative ? 1 : 0; i < length; ++i) {
+        const Word c = stringChar(vm, a[0], i);
+        if (c < '0' || c > '9') break;
+        value = static_cast<Word>(value * 10 + (c - '0'));
+      }
+      return negative ? static_cast<Word>(-value) : value;
+    } },
+  { "String.setInt", 2, [](VmInterpreter& vm, const Word* a) -> Word {
+      vm.poke(static_cast<Word>(a[0] + 1), 0);
+      for (char c : std::to_string(a[1]))
+        appendChar(vm, a[0], static_cast<Word>(c));
+      return 0;
+    } },
+  { "String.newLine", 0, [](VmInterpreter&, const Word*) -> Word { return kNewLine; } },
+  { "String.backSpace", 0, [](VmInterpreter&, const Word*) -> Word { return kBackSpace; } },
+  { "String.doubleQuote", 0, [](VmInterpreter&, const Word*) -> Word { return kDoubleQuote; } },
+
+  { "Output.printChar", 1, [](VmInterpreter& vm, const Word* a) -> Word { printChar(vm, a[0]); return 0; } },
+  { "Output.printString", 1, [](VmInterpreter& vm, const Word* a) -> Word {
+      for (Word i{}, length = stringLength(vm, a[0]); i < length; ++i)
+        printChar(vm, stringChar(vm, a[0], i));
+      return 0;
+    } },
+  { "Output.printInt", 1, [](VmInterpreter& vm, const Word* a) -> Word { vm.output() << a[0]; return 0; } },
+  { "Output.println", 0, [](VmInterpreter& vm, const Word*) -> Word { vm.output() << '\n'; return 0; } },
+  { "Output.backSpace", 0, [](VmInterpreter&, const Word*) -> Word { return 0; } },
+  { "Output.moveCursor", 2, [](VmInterpreter&, const Word*) -> Word { return 0; } },
+
+  { "Sys.halt", 0, [](VmInterpreter& vm, const Word*) -> Word { vm.halt(); return 0; } },
+  { "Sys.wait", 1, [](VmInterpreter&, const Word*) -> Word { return 0; } },
+  { "Sys.error", 1, [](VmInterpreter&, const Word* a) -> Word { osError(a[0], "raised by the program"); } },
+};
+}
+
+int32_t findNative(const std::string& name) {
+  for (std::size_t i{}; i < std::size(kNatives); ++i)
+    if (name == kNatives[i].name)
+      return static_cast<int32_t>(i);
+  return -1;
+}
+
+const NativeRoutine& nativeRoutine(int32_t index) {
+  return kNatives[index];
+}
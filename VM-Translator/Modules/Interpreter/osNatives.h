@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * @file osNatives.h
+ * @brief Built-in versions of the non-I/O Jack OS routines for the interpreter.
+ */
+
+#include <cstdint>
+#include <string>
+#include "vmInterpreter.h"
+
+/**
+ * @brief OS routine the interpreter runs natively when the program does not define it.
+ *
+ * Covers `Math`, `Memory`, `Array`, `String`, `Output` and `Sys`; programs
+ * that draw or read the keyboard must load the OS `.vm` files. Strings are
+ * heap blocks laid out as `[maxLength, length, chars...]`.
+ */
+struct NativeRoutine {
+  const char* name;
+  int32_t     nArgs;
+  /** @brief Runs the routine on the arguments (first argument first) and returns its result (0 for void). */
+  Word (*call)(VmInterpreter& vm, const Word* args);
+};
+
+/** @brief Index of the named routine, or -1 when there is no built-in for it. */
+int32_t findNative(const std::string& name);
+
+/** @brief Routine at an index returned by findNative(). */
+const NativeRoutine& nativeRoutine(int32_t index);
@@ -0,0 +1,290 @@
+#include "vmInterpreter.h"
+#include <stdexcept>
+#include <utility>
+#include "osNatives.h"
+#include "../Utils/CommandType.h"
+
+// GCC and Clang dispatch through a table of label addresses (one indirect
+// jump per instruction); other compilers fall back to a switch in a loop.
+#if defined(__GNUC__)
+  #define VM_THREADED_DISPATCH 1
+#else
+  #define VM_THREADED_DISPATCH 0
+#endif
+
+namespace {
+constexpr Word kFrameWords { 5 };
+constexpr Word kStaticBase { 16 };
+constexpr Word kStaticEnd  { 256 };
+
+const std::unordered_map<std::string, Opcode> kArithmetic {
+  { "add", Opcode::Add }, { "sub", Opcode::Sub }, { "neg", Opcode::Neg },
+  { "eq",  Opcode::Eq  }, { "gt",  Opcode::Gt  }, { "lt",  Opcode::Lt  },
+  { "and", Opcode::And }, { "or",  Opcode::Or  }, { "not", Opcode::Not },
+  { "drop", Opcode::Drop },
+};
+
+/** @brief Segment register (RAM[1..4]) of a pointer-based segment, or 0. */
+int32_t segmentRegister(const std::string& segment) {
+  if (segment == "local")    return 1;
+  if (segment == "argument") return 2;
+  if (segment == "this")     return 3;
+  if (segment == "that")     return 4;
+  return 0;
+}
+}
+
+VmInterpreter::VmInterpreter(std::ostream& out)
+  : m_out(out)
+  , m_code{ Instruction{ Opcode::Halt } }
+{}
+
+Word VmInterpreter::fixedAddress(const std::string& stem, const std::string& segment, int32_t index) {
+  if (segment == "pointer" && index >= 0 && index <= 1)
+    return static_cast<Word>(3 + index);
+  if (segment == "temp" && index >= 0 && index <= 7)
+    return static_cast<Word>(5 + index);
+  if (segment == "static" && index >= 0) {
+    const auto slot = m_statics.emplace(stem + "." + std::to_string(index),
+                                        static_cast<Word>(kStaticBase + m_statics.size()));
+    if (slot.first->second >= kStaticEnd)
+      throw std::runtime_error("[ERROR] More than " + std::to_string(kStaticEnd - kStaticBase) + " static variables");
+    return slot.first->second;
+  }
+  throw std::runtime_error("[ERROR] Invalid segment access: " + segment + " " + std::to_string(index));
+}
+
+void VmInterpreter::loadFile(const std::string& stem, const std::vector<VmCommand>& commands) {
+  // Labels are scoped to their function, as in the translated code.
+  std::string function;
+  std::unordered_map<std::string, int32_t> labels;
+  std::vector<std::pair<std::size_t, std::string>> jumps;
+
+  for (const VmCommand& cmd : commands) {
+    const auto here = static_cast<int32_t>(m_code.size());
+    switch (cmd.type) {
+      case CommandType::C_PUSH:
+        if (cmd.arg1 == "constant") {
+          if (cmd.arg2 < 0 || cmd.arg2 > 32767)
+            throw std::runtime_error("[ERROR] Constant out of range: " + std::to_string(cmd.arg2));
+          m_code.push_back({ Opcode::PushConst, cmd.arg2 });
+        } else if (const int32_t reg = segmentRegister(cmd.arg1)) {
+          m_code.push_back({ Opcode::PushSeg, reg, cmd.arg2 });
+        } else {
+          m_code.push_back({ Opcode::PushRam, fixedAddress(stem, cmd.arg1, cmd.arg2) });
+        }
+        break;
+      case CommandType::C_POP:
+        if (const int32_t reg = segmentRegister(cmd.arg1))
+          m_code.push_back({ Opcode::PopSeg, reg, cmd.arg2 });
+        else
+          m_code.push_back({ Opcode::PopRam, fixedAddress(stem, cmd.arg1, cmd.arg2) });
+        break;
+      case CommandType::C_ARITHMETIC: {
+        const auto op = kArithmetic.find(cmd.arg1);
+        if (op == kArithmetic.end())
+          throw std::runtime_error("[ERROR] Unknown arithmetic command: " + cmd.arg1);
+        m_code.push_back({ op->second });
+        break;
+      }
+      case CommandType::C_LABEL:
+        if (!labels.emplace(function + "$" + cmd.arg1, here).second)
+          throw std::runtime_error("[ERROR] Duplicate label " + cmd.arg1 + " in " + stem);
+        break;
+      case CommandType::C_GOTO:
+      case CommandType::C_IF:
+        jumps.emplace_back(m_code.size(), function + "$" + cmd.arg1);
+        m_code.push_back({ cmd.type == CommandType::C_GOTO ? Opcode::Goto : Opcode::IfGoto });
+        break;
+      case CommandType::C_FUNCTION:
+        function = cmd.arg1;
+        if (!m_functions.emplace(function, here).second)
+          throw std::runtime_error("[ERROR] Duplicate function " + function);
+        m_code.push_back({ Opcode::Function, cmd.arg2 });
+        break;
+      case CommandType::C_CALL:
+        m_pendingCalls.emplace_back(m_code.size(), cmd.arg1);
+        m_code.push_back({ Opcode::Call, 0, cmd.arg2 });
+        // call-void returns to a drop of the result.
+        if (cmd.isVoid)
+          m_code.push_back({ Opcode::Drop });
+        break;
+      case CommandType::C_RETURN:
+        if (cmd.isVoid)
+          m_code.push_back({ Opcode::PushConst, 0 });
+        m_code.push_back({ Opcode::Return });
+        break;
+      case CommandType::C_ASM:
+        throw std::runtime_error("[ERROR] Cannot interpret Hack assembly (asm " + cmd.arg1 + ") in " + stem);
+    }
+  }
+
+  for (const auto& [at, label] : jumps) {
+    const auto target = labels.find(label);
+    if (target == labels.end())
+      throw std::runtime_error("[ERROR] Unknown label " + label + " in " + stem);
+    Instruction& jump = m_code[at];
+    jump.a = target->second;
+    // `label END; goto END` is how VM programs stop.
+    if (jump.op == Opcode::Goto && static_cast<std::size_t>(jump.a) == at)
+      jump.op = Opcode::Halt;
+  }
+}
+
+void VmInterpreter::link() {
+  for (const auto& [at, name] : m_pendingCalls) {
+    Instruction& call = m_code[at];
+    if (const auto callee = m_functions.find(name); callee != m_functions.end()) {
+      call.a = callee->second;
+    } else if (const int32_t native = findNative(name); native >= 0) {
+      if (nativeRoutine(native).nArgs != call.b)
+        throw std::runtime_error("[ERROR] " + name + " takes " + std::to_string(nativeRoutine(native).nArgs) +
+                                 " arguments, called with " + std::to_string(call.b));
+      call.op = Opcode::CallNative;
+      call.a = native;
+    } else {
+      throw std::runtime_error("[ERROR] Undefined function " + name);
+    }
+  }
+  m_pendingCalls.clear();
+
+  if (m_code.back().op != Opcode::Halt)
+    m_code.push_back({ Opcode::Halt });
+  if (m_code.size() == 1)
+    throw std::runtime_error("[ERROR] Empty program");
+  if (m_code.size() > 32767)
+    throw std::runtime_error("[ERROR] Program too large: " + std::to_string(m_code.size()) + " instructions");
+}
+
+Word VmInterpreter::alloc(Word size) {
+  if (size > kHeapEnd - m_heapPtr)
+    throw std::runtime_error("[ERROR] Heap exhausted allocating " + std::to_string(size) + " words");
+  const Word base = m_heapPtr;
+  m_heapPtr = static_cast<Word>(m_heapPtr + size);
+  return base;
+}
+
+uint64_t VmInterpreter::run(uint64_t maxSteps) {
+  link();
+  m_ram.fill(0);
+  m_heapPtr = kHeapBase;
+  m_halted = false;
+
+  Word* const ram = m_ram.data();
+  const Instruction* const code = m_code.data();
+  const Instruction* ip = code + 1;
+  int32_t sp = kStackBase;
+  uint64_t steps{};
+
+  #define RAM(address) ram[static_cast<uint16_t>(address) & kAddressMask]
+
+  // Enter the entry function as if called with no arguments from instruction 0 (Halt).
+  auto entry = m_functions.find("Sys.init");
+  if (entry == m_functions.end())
+    entry = m_functions.find("Main.main");
+  if (entry != m_functions.end()) {
+    sp += kFrameWords;
+    ram[2] = kStackBase;
+    ram[1] = static_cast<Word>(sp);
+    ip = code + entry->second;
+  }
+
+#if VM_THREADED_DISPATCH
+  static const void* const kTargets[] = {
+    &&op_PushConst, &&op_PushSeg, &&op_PushRam, &&op_PopSeg, &&op_PopRam,
+    &&op_Add, &&op_Sub, &&op_Neg, &&op_Eq, &&op_Gt, &&op_Lt, &&op_And, &&op_Or, &&op_Not,
+    &&op_Drop, &&op_Goto, &&op_IfGoto, &&op_Function, &&op_Call, &&op_CallNative, &&op_Return, &&op_Halt,
+  };
+  #define OP(name) op_##name:
+  #define NEXT                                                              \
+    if (++steps > maxSteps) goto out_of_steps;                              \
+    goto *kTargets[static_cast<std::size_t>(ip->op)]
+  NEXT;
+  {
+#else
+  #define OP(name) case Opcode::name:
+  #define NEXT                                                              \
+    if (++steps > maxSteps) goto out_of_steps;                              \
+    continue
+  for (;;) switch (ip->op) {
+#endif
+
+    OP(PushConst)  RAM(sp++) = static_cast<Word>(ip->a); ++ip; NEXT;
+    OP(PushSeg)    RAM(sp++) = RAM(ram[ip->a] + ip->b); ++ip; NEXT;
+    OP(PushRam)    RAM(sp++) = ram[ip->a]; ++ip; NEXT;
+    OP(PopSeg)     { const Word value = RAM(--sp); RAM(ram[ip->a] + ip->b) = value; ++ip; NEXT; }
+    OP(PopRam)     ram[ip->a] = RAM(--sp); ++ip; NEXT;
+
+    // Comparisons test the wrapped difference, exactly like the translated code.
+    OP(Add)  --sp; RAM(sp - 1) = static_cast<Word>(RAM(sp - 1) + RAM(sp)); ++ip; NEXT;
+    OP(Sub)  --sp; RAM(sp - 1) = static_cast<Word>(RAM(sp - 1) - RAM(sp)); ++ip; NEXT;
+    OP(And)  --sp; RAM(sp - 1) = static_cast<Word>(RAM(sp - 1) & RAM(sp)); ++ip; NEXT;
+    OP(Or)   --sp; RAM(sp - 1) = static_cast<Word>(RAM(sp - 1) | RAM(sp)); ++ip; NEXT;
+    OP(Eq)   --sp; RAM(sp - 1) = (RAM(sp - 1) == RAM(sp)) ? -1 : 0; ++ip; NEXT;
+    OP(Gt)   --sp; RAM(sp - 1) = (static_cast<Word>(RAM(sp - 1) - RAM(sp)) > 0) ? -1 : 0; ++ip; NEXT;
+    OP(Lt)   --sp; RAM(sp - 1) = (static_cast<Word>(RAM(sp - 1) - RAM(sp)) < 0) ? -1 : 0; ++ip; NEXT;
+    OP(Neg)  RAM(sp - 1) = static_cast<Word>(-RAM(sp - 1)); ++ip; NEXT;
+    OP(Not)  RAM(sp - 1) = static_cast<Word>(~RAM(sp - 1)); ++ip; NEXT;
+    OP(Drop) --sp; ++ip; NEXT;
+
+    OP(Goto)   ip = code + ip->a; NEXT;
+    OP(IfGoto) ip = RAM(--sp) ? code + ip->a : ip + 1; NEXT;
+
+    OP(Function)
+      if (sp + ip->a >= kHeapBase)
+        throw std::runtime_error("[ERROR] Stack overflow entering function at instruction " +
+                                 std::to_string(ip - code));
+      for (int32_t i{}; i < ip->a; ++i)
+        RAM(sp++) = 0;
+      ++ip;
+      NEXT;
+
+    OP(Call)
+      RAM(sp++) = static_cast<Word>(ip - code + 1);
+      RAM(sp++) = ram[1];
+      RAM(sp++) = ram[2];
+      RAM(sp++) = ram[3];
+      RAM(sp++) = ram[4];
+      ram[2] = static_cast<Word>(sp - kFrameWords - ip->b);
+      ram[1] = static_cast<Word>(sp);
+      ip = code + ip->a;
+      NEXT;
+
+    OP(CallNative) {
+      ram[0] = static_cast<Word>(sp);
+      const Word result = nativeRoutine(ip->a).call(*this, &RAM(sp - ip->b));
+      sp -= ip->b;
+      RAM(sp++) = result;
+      ++ip;
+      if (m_halted) goto halted;
+      NEXT;
+    }
+
+    OP(Return) {
+      const Word frame = ram[1];
+      const auto returnTo = static_cast<uint16_t>(RAM(frame - kFrameWords));
+      RAM(ram[2]) = RAM(--sp);
+      sp = ram[2] + 1;
+      ram[4] = RAM(frame - 1);
+      ram[3] = RAM(frame - 2);
+      ram[2] = RAM(frame - 3);
+      ram[1] = RAM(frame - 4);
+      if (returnTo >= m_code.size())
+        throw std::runtime_error("[ERROR] Return to invalid address " + std::to_string(returnTo));
+      ip = code + returnTo;
+      NEXT;
+    }
+
+    OP(Halt) goto halted;
+  }
+
+  #undef OP
+  #undef NEXT
+  #undef RAM
+
+out_of_steps:
+  throw std::runtime_error("[ERROR] Program did not halt within " + std::to_string(maxSteps) + " instructions");
+halted:
+  ram[0] = static_cast<Word>(sp);
+  return steps;
+}
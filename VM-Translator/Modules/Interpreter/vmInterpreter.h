@@ -0,0 +1,142 @@
+#pragma once
+
+/**
+ * @file vmInterpreter.h
+ * @brief Runs loaded VM programs directly, without translating them to assembly.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Utils/VmCommand.h"
+
+/** @brief 16-bit machine word, as in `GprMemory`. */
+using Word = int16_t;
+
+/**
+ * @brief Bytecode operations; every VM command maps to exactly one (labels map to none),
+ *        except `call-void` (`Call`, `Drop`) and `return-void` (`PushConst 0`, `Return`).
+ */
+enum class Opcode : uint8_t {
+  PushConst,   /**< push a */
+  PushSeg,     /**< push RAM[RAM[a] + b] (local/argument/this/that) */
+  PushRam,     /**< push RAM[a] (pointer/temp/static) */
+  PopSeg,      /**< RAM[RAM[a] + b] = pop */
+  PopRam,      /**< RAM[a] = pop */
+  Add, Sub, Neg, Eq, Gt, Lt, And, Or, Not,
+  Drop,        /**< SP-- (emitted by the slot optimizer) */
+  Goto,        /**< jump to a */
+  IfGoto,      /**< jump to a when pop != 0 */
+  Function,    /**< push a zeroed locals */
+  Call,        /**< call instruction a with b arguments */
+  CallNative,  /**< call built-in OS routine a with b arguments */
+  Return,
+  Halt,
+};
+
+/** @brief One bytecode instruction; all labels and names are already resolved to integers. */
+struct Instruction {
+  Opcode  op;
+  int32_t a{};
+  int32_t b{};
+};
+
+/**
+ * @brief Bytecode interpreter for VM programs.
+ *
+ * Files are compiled into one flat instruction array: labels become
+ * instruction indices, statics get fixed RAM addresses from 16 (in order of
+ * first use, like the assembler), and calls are resolved to the callee's
+ * entry or to a built-in OS routine when the program does not define it.
+ *
+ * The machine state is the same 32K-word RAM the translated code sees
+ * (see `GprMemory`): SP/LCL/ARG/THIS/THAT in RAM[0..4], temps in RAM[5..12],
+ * the stack from 256 and the heap from 2048. Call frames are laid out as
+ * the translator lays them out, so programs that inspect memory behave the
+ * same way.
+ */
+class VmInterpreter {
+  public:
+    static constexpr std::size_t kRamSize   { 32768 };
+    static constexpr Word        kStackBase { 256 };
+    static constexpr Word        kHeapBase  { 2048 };
+    static constexpr Word        kHeapEnd   { 16384 };
+    static constexpr uint64_t    kDefaultStepLimit { 100'000'000 };
+
+    /**
+     * @brief Creates an empty interpreter.
+     * @param out Stream receiving the output of the built-in `Output` routines.
+     */
+    explicit VmInterpreter(std::ostream& out = std::cout);
+
+    /**
+     * @brief Compiles one loaded `.vm` file into the program.
+     * @param stem     File name without extension; scopes the file's statics.
+     * @param commands Commands as loaded by `VMTranslator::loadFile()`.
+     * @throws std::runtime_error on unknown segments, operations or labels, and on `asm`, which it cannot run.
+     */
+    void loadFile(const std::string& stem, const std::vector<VmCommand>& commands);
+
+    /**
+     * @brief Resets RAM and runs the program until it halts.
+     *
+     * Starts at `Sys.init` when the program defines it, otherwise at
+     * `Main.main`, otherwise at the first loaded command. The program halts
+     * when the entry function returns, on `Sys.halt`, or on a jump to itself
+     * (the usual `label END; goto END` loop).
+     * @param maxSteps Instruction budget.
+     * @return Number of instructions executed.
+     * @throws std::runtime_error on an empty program, undefined callees, stack overflow or when the budget runs out.
+     */
+    uint64_t run(uint64_t maxSteps = kDefaultStepLimit);
+
+    /** @brief Reads RAM; addresses wrap to 15 bits like the Hack A register. */
+    Word peek(Word address) const { return m_ram[static_cast<uint16_t>(address) & kAddressMask]; }
+
+    /** @brief Writes RAM; addresses wrap to 15 bits like the Hack A register. */
+    void poke(Word address, Word value) { m_ram[static_cast<uint16_t>(address) & kAddressMask] = value; }
+
+    /**
+     * @brief Bump-allocates heap words, as `GprMemory::alloc()` does.
+     * @throws std::runtime_error when the heap is exhausted.
+     */
+    Word alloc(Word size);
+
+    /** @brief Stops the running program after the current instruction. */
+    void halt() { m_halted = true; }
+
+    /** @brief Stream used by the built-in `Output` routines. */
+    std::ostream& output() { return m_out; }
+
+    /** @brief Compiled program, for inspection. */
+    const std::vector<Instruction>& code() const { return m_code; }
+
+  private:
+    static constexpr uint16_t kAddressMask { 0x7FFF };
+
+    std::ostream& m_out;
+    std::array<Word, kRamSize> m_ram{};
+    /** @brief Compiled program; instruction 0 is a `Halt` the entry function returns to. */
+    std::vector<Instruction> m_code;
+
+    /** @brief Entry instruction of every defined function. */
+    std::unordered_map<std::string, int32_t> m_functions;
+    /** @brief Callee names of `Call` instructions, resolved by link(). */
+    std::vector<std::pair<std::size_t, std::string>> m_pendingCalls;
+    /** @brief RAM address of every `<stem>.<index>` static. */
+    std::unordered_map<std::string, Word> m_statics;
+
+    Word m_heapPtr{ kHeapBase };
+    bool m_halted{};
+
+    /** @brief Resolves pending calls to defined functions or built-ins. */
+    void link();
+
+    /** @brief RAM address of a pointer, temp or static slot. */
+    Word fixedAddress(const std::string& stem, const std::string& segment, int32_t index);
+};
@@ -0,0 +1,86 @@
+#include "slotOptimizer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "../Analysis/functionAnalysis.h"
+#include "../Utils/CommandType.h"
+
+namespace {
+bool isDrop(const VmCommand& cmd) { return cmd.type == CommandType::C_ARITHMETIC && cmd.arg1 == "drop"; }
+
+/** @brief One rewrite round over a function body; returns true if anything changed. */
+bool optimizeBody(const FunctionAnalysis& function, std::vector<VmCommand>& body, SlotOptimizerStats& stats) {
+  std::vector<VmCommand> out;
+  out.reserve(body.size());
+  bool changed = false;
+
+  for (std::size_t i{}; i < body.size(); ++i) {
+    const VmCommand& cmd = body[i];
+    const bool reachable = function.depthBefore(i).has_value();
+
+    if (reachable && cmd.type == CommandType::C_POP) {
+      if (const auto slot = function.slotOf(cmd.arg1, cmd.arg2)) {
+        const bool reloaded = i + 1 < body.size() && body[i + 1].type == CommandType::C_PUSH &&
+                              body[i + 1].arg1 == cmd.arg1 && body[i + 1].arg2 == cmd.arg2;
+        if (reloaded && !function.liveAfter(i + 1)[*slot]) {
+          ++stats.forwarded;
+          changed = true;
+          ++i;
+          continue;
+        }
+        if (!function.liveAfter(i)[*slot]) {
+          ++stats.droppedStores;
+          changed = true;
+          out.push_back(VmCommand{ CommandType::C_ARITHMETIC, "drop", 0 });
+          continue;
+        }
+      }
+    }
+
+    if (reachable && cmd.type == CommandType::C_PUSH && i + 1 < body.size() && isDrop(body[i + 1])) {
+      ++stats.removedPushes;
+      changed = true;
+      ++i;
+      continue;
+    }
+
+    out.push_back(cmd);
+  }
+
+  body = std::move(out);
+  return changed;
+}
+}
+
+SlotOptimizerStats optimizeSlots(std::vector<VmCommand>& commands, bool privateTemps) {
+  SlotOptimizerStats stats;
+  std::vector<VmCommand> result;
+  result.reserve(commands.size());
+
+  const auto isFunction = [](const VmCommand& cmd) { return cmd.type == CommandType::C_FUNCTION; };
+  auto next = std::find_if(commands.begin(), commands.end(), isFunction);
+  result.insert(result.end(), commands.begin(), next);
+
+  while (next != commands.end()) {
+    const auto bodyEnd = std::find_if(next + 1, commands.end(), isFunction);
+    const VmCommand header = *next;
+    std::vector<VmCommand> body(next + 1, bodyEnd);
+
+    try {
+      for (bool changed = true; changed;) {
+        const FunctionAnalysis function(header.arg1, static_cast<uint32_t>(header.arg2), body, privateTemps);
+        changed = optimizeBody(function, body, stats);
+      }
+    } catch (const std::runtime_error&) {
+      // Unanalysable control flow: keep the function exactly as written.
+      body.assign(next + 1, bodyEnd);
+    }
+
+    result.push_back(header);
+    result.insert(result.end(), body.begin(), body.end());
+    next = bodyEnd;
+  }
+
+  commands = std::move(result);
+  return stats;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file slotOptimizer.h
+ * @brief Liveness-driven cleanup of stores into `local` and `temp` slots.
+ */
+#include <cstddef>
+#include <vector>
+#include "../Utils/VmCommand.h"
+
+/**
+ * @brief What optimizeSlots() changed.
+ */
+struct SlotOptimizerStats {
+  std::size_t forwarded{};     /**< `pop x; push x` pairs removed, leaving the value on the stack. */
+  std::size_t droppedStores{}; /**< Pops into dead slots turned into `drop`. */
+  std::size_t removedPushes{}; /**< `push ...; drop` pairs removed. */
+};
+
+/**
+ * @brief Removes stores into `local`/`temp` slots whose value is never read again.
+ *
+ * Per function, using FunctionAnalysis liveness, until nothing changes:
+ * - `pop x; push x` where x is dead after the push is deleted, so the value
+ *   simply stays on the stack;
+ * - any other pop into a dead slot becomes `drop` (an arithmetic pseudo
+ *   command that only decrements SP);
+ * - a push immediately followed by `drop` is deleted.
+ *
+ * Code before the first `function` and functions whose control flow cannot
+ * be analysed are left untouched.
+ * @param commands     One loaded `.vm` file, rewritten in place.
+ * @param privateTemps Assume temps carry no values across calls and returns
+ *                     (true for Jack compiler output); otherwise temps are
+ *                     only optimized between calls.
+ */
+SlotOptimizerStats optimizeSlots(std::vector<VmCommand>& commands, bool privateTemps);
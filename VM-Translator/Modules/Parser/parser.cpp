@@ -1,4 +1,5 @@
 #include "parser.h"
+#include <cctype>
 #include <fstream>
 #include <stdexcept>
 #include <sstream>
@@ -26,7 +27,15 @@ void Parser::advance() {
   m_arg1.clear();
   m_arg2.clear();
 
-  iss >> m_cmd >> m_arg1 >> m_arg2;
+  iss >> m_cmd;
+  if (m_cmd == "asm") {
+    // The rest of the line is one Hack instruction; Hack ignores spaces inside it.
+    for (char c; iss.get(c);)
+      if (!std::isspace(static_cast<unsigned char>(c)))
+        m_arg1.push_back(c);
+    return;
+  }
+  iss >> m_arg1 >> m_arg2;
 }
 
 CommandType Parser::commandType() const {
@@ -43,14 +52,20 @@ CommandType Parser::commandType() const {
     return CommandType::C_IF;
   if (m_cmd == "function")
     return CommandType::C_FUNCTION;
-  if (m_cmd == "call")
+  if (m_cmd == "call" || m_cmd == "call-void")
     return CommandType::C_CALL;
-  if (m_cmd == "return")
+  if (m_cmd == "return" || m_cmd == "return-void")
     return CommandType::C_RETURN;
+  if (m_cmd == "asm")
+    return CommandType::C_ASM;
 
   return CommandType::C_ARITHMETIC;
 }
 
+bool Parser::isVoid() const {
+  return m_cmd == "call-void" || m_cmd == "return-void";
+}
+
 std::string Parser::arg1() const {
   CommandType cmd_type { commandType() };
   if (CommandType::C_RETURN == cmd_type)
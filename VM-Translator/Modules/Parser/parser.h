@@ -49,11 +49,17 @@ class Parser {
      * @brief Returns the type of the current VM command.
      */
     CommandType commandType() const;
+
+    /**
+     * @brief Indicates whether the current command is `call-void` or `return-void`.
+     */
+    bool isVoid() const;
     
     /**
      * @brief Returns the first argument of the current command.
      *
-     * For C_ARITHMETIC, returns the command itself; undefined if no argument.
+     * For C_ARITHMETIC, returns the command itself; for C_ASM, the Hack
+     * instruction with its spaces removed; undefined if no argument.
      */
     std::string arg1() const;
 
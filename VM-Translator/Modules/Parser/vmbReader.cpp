@@ -0,0 +1,109 @@
+#include "vmbReader.h"
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../../../Common/mappedFile.h"
+#include "../../../Common/vmbFormat.h"
+
+std::vector<VmCommand> loadVmb(const std::string& path) {
+  const MappedFile file(path);
+  const unsigned char* const data = reinterpret_cast<const unsigned char*>(file.data());
+  const std::size_t size = file.size();
+  std::size_t pos{};
+
+  const auto malformed = [&path, &pos](const std::string& what) {
+    return std::runtime_error("[ERROR] Malformed .vmb file " + path + " at byte " + std::to_string(pos) + ": " + what);
+  };
+  const auto varint = [&]() {
+    const std::optional<uint32_t> value = vmb::readVarint(data, size, pos);
+    if (!value)
+      throw malformed("truncated number");
+    return *value;
+  };
+  const auto operand = [&]() {
+    const uint32_t value = varint();
+    if (value > vmb::kMaxOperand)
+      throw malformed("operand " + std::to_string(value) + " out of range");
+    return static_cast<int32_t>(value);
+  };
+
+  if (size < sizeof(vmb::kMagic) + 1 || std::memcmp(data, vmb::kMagic, sizeof(vmb::kMagic)) != 0)
+    throw malformed("missing VMB signature");
+  pos = sizeof(vmb::kMagic);
+  const uint8_t version = data[pos++];
+  if (version == 0 || version > vmb::kVersion)
+    throw malformed("unsupported version " + std::to_string(version));
+
+  // Every entry takes at least its length byte, which bounds the count
+  // before anything is allocated for it.
+  const uint32_t stringCount = varint();
+  if (stringCount > size - pos)
+    throw malformed("truncated string table");
+  std::vector<std::string_view> strings(stringCount);
+  for (std::string_view& name : strings) {
+    const uint32_t length = varint();
+    if (length > size - pos)
+      throw malformed("truncated string");
+    name = { reinterpret_cast<const char*>(data + pos), length };
+    pos += length;
+  }
+  const auto string = [&]() {
+    const uint32_t id = varint();
+    if (id >= strings.size())
+      throw malformed("string id " + std::to_string(id) + " out of range");
+    return strings[id];
+  };
+
+  const uint32_t count = varint();
+  std::vector<VmCommand> commands;
+  commands.reserve(std::min<std::size_t>(count, size - pos));
+
+  for (uint32_t n{}; n < count; ++n) {
+    if (pos >= size)
+      throw malformed("truncated command list");
+    const uint8_t op = data[pos++];
+    if (vmb::versionOf(op) > version) {
+      --pos;
+      throw malformed("opcode " + std::to_string(op) + " needs version " + std::to_string(vmb::versionOf(op)));
+    }
+
+    if (op <= vmb::kOpNot) {
+      commands.push_back({ CommandType::C_ARITHMETIC, vmb::kArithmeticNames[op - vmb::kOpAdd] });
+    } else if (op >= vmb::kOpPush && op < vmb::kOpPop + 8) {
+      const CommandType type = (op < vmb::kOpPop) ? CommandType::C_PUSH : CommandType::C_POP;
+      commands.push_back({ type, vmb::kSegmentNames[op & 0x07], operand() });
+    } else {
+      switch (op) {
+        case vmb::kOpLabel:    commands.push_back({ CommandType::C_LABEL, std::string(string()) }); break;
+        case vmb::kOpGoto:     commands.push_back({ CommandType::C_GOTO,  std::string(string()) }); break;
+        case vmb::kOpIfGoto:   commands.push_back({ CommandType::C_IF,    std::string(string()) }); break;
+        case vmb::kOpFunction: {
+          const std::string_view name = string();
+          commands.push_back({ CommandType::C_FUNCTION, std::string(name), operand() });
+          break;
+        }
+        case vmb::kOpCall:
+        case vmb::kOpCallVoid: {
+          const std::string_view name = string();
+          commands.push_back({ CommandType::C_CALL, std::string(name), operand(), op == vmb::kOpCallVoid });
+          break;
+        }
+        case vmb::kOpReturn:     commands.push_back({ CommandType::C_RETURN, {} }); break;
+        case vmb::kOpReturnVoid: commands.push_back({ CommandType::C_RETURN, {}, 0, true }); break;
+        case vmb::kOpAsm:        commands.push_back({ CommandType::C_ASM, std::string(string()) }); break;
+        default:
+          --pos;
+          throw malformed("unknown opcode " + std::to_string(op));
+      }
+    }
+  }
+
+  if (pos != size)
+    throw malformed("trailing bytes");
+  return commands;
+}
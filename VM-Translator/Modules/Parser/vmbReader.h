@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * @file vmbReader.h
+ * @brief Loads binary `.vmb` files written by the compiler's `VmWriter`.
+ */
+
+#include <string>
+#include <vector>
+#include "../Utils/VmCommand.h"
+
+/**
+ * @brief Decodes a `.vmb` file (format in `Common/vmbFormat.h`).
+ *
+ * The file is memory-mapped and decoded from the mapping: there is no read
+ * buffer and no text to tokenize, and the string table is kept as views
+ * into the mapping. `VmCommand` owns its strings, so each command still
+ * copies its name out of the table; names that fit the small-string buffer
+ * cost no allocation. Opcodes newer than the file's version and operands
+ * above `vmb::kMaxOperand` are rejected.
+ * @param path Path of the `.vmb` file.
+ * @return The commands, as `VMTranslator::loadFile()` returns them for text files.
+ * @throws std::runtime_error if the file cannot be mapped or is malformed.
+ */
+std::vector<VmCommand> loadVmb(const std::string& path);
@@ -10,4 +10,5 @@ enum CommandType {
   C_FUNCTION,
   C_RETURN,
   C_CALL,
+  C_ASM,
 };
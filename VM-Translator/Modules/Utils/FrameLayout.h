@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * @file FrameLayout.h
+ * @brief Which caller registers a call frame saves, and whether a value comes back.
+ */
+#include <cstdint>
+
+/**
+ * @brief Shape of the frame a `call` pushes for one particular callee.
+ *
+ * The return address, LCL and ARG are always saved. THIS and THAT are only
+ * saved when the callee itself may overwrite them; the callee's `return`
+ * restores exactly what its callers saved, so every call site of a function
+ * uses that function's layout.
+ *
+ * Likewise a function whose callers all discard its result (`call-void`)
+ * returns without writing a value, and its callers have nothing to drop.
+ */
+struct FrameLayout {
+  bool saveThis     { true }; /**< Frame holds the caller's THIS. */
+  bool saveThat     { true }; /**< Frame holds the caller's THAT. */
+  bool returnsValue { true }; /**< `return` leaves a value at ARG[0] for the caller. */
+
+  /** @brief Number of words the frame occupies between the arguments and the callee's locals. */
+  uint32_t size() const { return 3u + (saveThis ? 1u : 0u) + (saveThat ? 1u : 0u); }
+
+  bool operator==(const FrameLayout& other) const {
+    return saveThis == other.saveThis && saveThat == other.saveThat && returnsValue == other.returnsValue;
+  }
+  bool operator!=(const FrameLayout& other) const { return !(*this == other); }
+};
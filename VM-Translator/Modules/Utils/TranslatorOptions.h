@@ -0,0 +1,55 @@
+#pragma once
+
+/**
+ * @file TranslatorOptions.h
+ * @brief Switches for the optional code-generation improvements.
+ */
+
+/**
+ * @brief Code-generation settings shared by VMTranslator and CodeWriter.
+ */
+struct TranslatorOptions {
+  /**
+   * @brief Push ALU constants (0, 1, -1) with `M=0`/`M=1`/`M=-1` and fold a
+   *        `neg`/`not` that directly follows a `push constant` into the push.
+   */
+  bool aluConstants { true };
+
+  /**
+   * @brief Turn `call f n` directly followed by `return` into a jump that
+   *        reuses the caller's frame, when the caller is known to take at
+   *        least `n` arguments.
+   */
+  bool tailCalls { true };
+
+  /**
+   * @brief Keep stack-pointer adjustments pending within a basic block and
+   *        address stack slots as `SP+k`, committing `SP` once before the
+   *        next label, jump, call or return.
+   */
+  bool spBatching { false };
+
+  /**
+   * @brief Let calls skip saving THIS/THAT for callees that never pop into
+   *        `pointer`, with the callee's return restoring only what was saved.
+   */
+  bool frameSpecialization { true };
+
+  /**
+   * @brief Let functions that are only ever called with `call-void` return
+   *        without a value, so neither side pushes or drops one.
+   */
+  bool voidReturns { true };
+
+  /**
+   * @brief Run the slot optimizer: forward `pop x; push x` through the stack
+   *        and turn pops into dead `local`/`temp` slots into a bare `SP--`.
+   */
+  bool optimizeSlots { true };
+
+  /**
+   * @brief Promise that temps never carry values across calls and returns,
+   *        as in Jack compiler output, so the slot optimizer may drop them.
+   */
+  bool privateTemps { false };
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * @file VmCommand.h
+ * @brief In-memory form of a parsed VM command.
+ */
+#include <cstdint>
+#include <string>
+#include "CommandType.h"
+
+/**
+ * @brief One VM command with its arguments, as read by Parser.
+ *
+ * A file is loaded into a list of these before code generation so the
+ * translator can look ahead across commands.
+ *
+ * Besides the standard commands, the Jack compiler emits `call-void f n`,
+ * which is `call f n` with the result discarded, and `return-void`, which
+ * is `return` with the value 0. Both are read as C_CALL / C_RETURN with
+ * `isVoid` set. It also emits `asm instruction`, one line of Hack assembly
+ * passed through to the output unchanged (C_ASM, with the instruction in
+ * `arg1`). An `asm` command falls through to the next command and leaves
+ * SP and the stack as it found them; the translator does not look inside.
+ */
+struct VmCommand {
+  CommandType type;     /**< Command kind. */
+  std::string arg1;     /**< Arithmetic mnemonic, segment, label, function name or Hack instruction. */
+  int32_t     arg2{};   /**< Index / count for push, pop, function and call; 0 otherwise. */
+  bool        isVoid{}; /**< `call-void` / `return-void`: no value is passed back to the caller. */
+};
+
+/** @brief The command as it is written in a `.vm` file. */
+inline std::string toString(const VmCommand& cmd) {
+  switch (cmd.type) {
+    case C_PUSH:     return "push " + cmd.arg1 + " " + std::to_string(cmd.arg2);
+    case C_POP:      return "pop " + cmd.arg1 + " " + std::to_string(cmd.arg2);
+    case C_LABEL:    return "label " + cmd.arg1;
+    case C_GOTO:     return "goto " + cmd.arg1;
+    case C_IF:       return "if-goto " + cmd.arg1;
+    case C_FUNCTION: return "function " + cmd.arg1 + " " + std::to_string(cmd.arg2);
+    case C_CALL:     return (cmd.isVoid ? "call-void " : "call ") + cmd.arg1 + " " + std::to_string(cmd.arg2);
+    case C_RETURN:   return cmd.isVoid ? "return-void" : "return";
+    case C_ASM:      return "asm " + cmd.arg1;
+    default:         return cmd.arg1;
+  }
+}
@@ -0,0 +1,36 @@
+#include "frameAnalysis.h"
+#include "../Utils/CommandType.h"
+
+std::map<std::string, FunctionFrame> analyzeFrames(const std::vector<std::vector<VmCommand>>& programs) {
+  std::map<std::string, FunctionFrame> frames;
+  std::map<std::string, std::size_t> callSites;
+  std::map<std::string, std::size_t> voidCallSites;
+
+  for (const auto& commands : programs) {
+    FunctionFrame* current = nullptr;
+    for (const VmCommand& cmd : commands) {
+      if (cmd.type == CommandType::C_FUNCTION)
+        current = &frames[cmd.arg1];
+      else if (cmd.type == CommandType::C_CALL)
+        ++(cmd.isVoid ? voidCallSites : callSites)[cmd.arg1];
+      else if (cmd.type == CommandType::C_POP && cmd.arg1 == "pointer" && current)
+        (cmd.arg2 == 0 ? current->writesThis : current->writesThat) = true;
+      else if (cmd.type == CommandType::C_ASM && current)
+        current->writesThis = current->writesThat = true;
+    }
+  }
+
+  for (auto& [name, frame] : frames) {
+    const auto calls = callSites.find(name);
+    const auto voidCalls = voidCallSites.find(name);
+    frame.voidCallSites = (voidCalls != voidCallSites.end()) ? voidCalls->second : 0;
+    frame.callSites = ((calls != callSites.end()) ? calls->second : 0) + frame.voidCallSites;
+    if (frame.callSites == 0)
+      continue;
+    frame.layout.saveThis = frame.writesThis;
+    frame.layout.saveThat = frame.writesThat;
+    frame.layout.returnsValue = frame.voidCallSites < frame.callSites;
+  }
+
+  return frames;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * @file frameAnalysis.h
+ * @brief Whole-program analysis choosing each function's call-frame layout.
+ */
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Utils/FrameLayout.h"
+#include "../Utils/VmCommand.h"
+
+/**
+ * @brief What the analysis found out about one function of the program.
+ */
+struct FunctionFrame {
+  FrameLayout layout;          /**< Layout every call site of the function pushes. */
+  bool writesThis{};           /**< Body contains `pop pointer 0` or `asm`. */
+  bool writesThat{};           /**< Body contains `pop pointer 1` or `asm`. */
+  std::size_t callSites{};     /**< Number of `call` commands targeting the function. */
+  std::size_t voidCallSites{}; /**< How many of them are `call-void`. */
+};
+
+/**
+ * @brief Chooses a frame layout for every function defined in the program.
+ *
+ * A frame only has to preserve the pointers its own function overwrites:
+ * every callee restores whatever it overwrites before returning, so THIS and
+ * THAT survive any call into a function that never pops into `pointer`.
+ * Functions that are never called from inside the program (entry points such
+ * as `Sys.init`) keep the full frame so outside callers still work, as do
+ * calls to functions the program does not define.
+ *
+ * For the same reason, only a function that is called, and only with
+ * `call-void`, returns without a value.
+ * @param programs Loaded `.vm` files, in translation order.
+ * @return Analysis result per defined function, keyed by function name.
+ */
+std::map<std::string, FunctionFrame> analyzeFrames(const std::vector<std::vector<VmCommand>>& programs);
@@ -2,32 +2,68 @@
 #include <filesystem>
 #include <algorithm>
 #include <fstream>
+#include <future>
+#include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
+#include <sstream>
 #include <stdexcept>
 
 #include "../Parser/parser.h"
+#include "../Parser/vmbReader.h"
 #include "../CodeWriter/codeWriter.h"
+#include "../CodeWriter/instructionSink.h"
+#include "../HackWriter/hackWriter.h"
+#include "../Optimizer/slotOptimizer.h"
 #include "../Utils/CommandType.h"
+#include "../../../Common/threadPool.h"
+#include "../Utils/VmCommand.h"
 
 namespace fs = std::filesystem;
 
+namespace {
+/// Counts emitted instructions without keeping them.
+class CountingSink : public InstructionSink {
+  public:
+    std::size_t count{};
+
+    void comment(std::string_view) override {}
+    void label(std::string_view) override {}
+    void address(std::string_view) override { ++count; }
+    void address(uint32_t) override { ++count; }
+    void compute(std::string_view, std::string_view, std::string_view) override { ++count; }
+};
+}
+
+VMTranslator::VMTranslator(TranslatorOptions options)
+  : m_options(options)
+{}
+
 std::vector<std::string> VMTranslator::collectVmFiles(const std::string& inPath) const {
   std::vector<std::string> files;
   fs::path p(inPath);
 
   if (!fs::exists(p)) throw std::runtime_error("Input path does not exist: " + inPath);
 
+  const auto isVm = [](const fs::path& file) { return file.extension() == ".vm" || file.extension() == ".vmb"; };
+
   if (fs::is_directory(p)) {
     for (auto& e : fs::directory_iterator(p)) {
-      if (e.is_regular_file() && e.path().extension() == ".vm")
+      if (e.is_regular_file() && isVm(e.path()))
         files.push_back(e.path().string());
     }
     std::sort(files.begin(), files.end());
   } else {
-    if (p.extension() == ".vm") files.push_back(p.string());
-    else throw std::runtime_error("Input must be a .vm file or a directory.");
+    if (isVm(p)) files.push_back(p.string());
+    else throw std::runtime_error("Input must be a .vm/.vmb file or a directory.");
   }
 
   if (files.empty()) throw std::runtime_error("No .vm files found.");
+
+  // Foo.vm and Foo.vmb would both define Foo's functions and statics.
+  for (std::size_t i{1}; i < files.size(); ++i)
+    if (fs::path(files[i]).stem() == fs::path(files[i - 1]).stem())
+      throw std::runtime_error("[ERROR] Both text and binary VM code for " + fs::path(files[i]).stem().string());
   return files;
 }
 
@@ -40,58 +76,330 @@ std::string VMTranslator::computeOutAsm(const std::string& inPath) const {
   return (p.parent_path() / (p.stem().string() + ".asm")).string();
 }
 
-void VMTranslator::translateFile(const std::string& vmPath, CodeWriter& cw) const {
-  // Static symbol base = file stem
-  cw.setCurrentFile(fs::path(vmPath).stem().string());
+std::vector<VmCommand> VMTranslator::loadFile(const std::string& vmPath) const {
+  if (fs::path(vmPath).extension() == ".vmb")
+    return loadVmb(vmPath);
 
   std::ifstream infile(vmPath);
   if (!infile) throw std::runtime_error("Failed to open: " + vmPath);
 
   Parser parser(infile); // your Parser takes std::ifstream&
 
+  std::vector<VmCommand> commands;
   while (parser.hasMoreLines()) {
     parser.advance();
 
-    switch (parser.commandType()) {
+    VmCommand cmd { parser.commandType(), {}, 0, parser.isVoid() };
+    switch (cmd.type) {
+      case CommandType::C_PUSH:
+      case CommandType::C_POP:
+      case CommandType::C_FUNCTION:
+      case CommandType::C_CALL:
+        cmd.arg2 = parser.arg2();
+        [[fallthrough]];
       case CommandType::C_ARITHMETIC:
-        cw.writeArithmetic(parser.arg1());
+      case CommandType::C_LABEL:
+      case CommandType::C_GOTO:
+      case CommandType::C_IF:
+      case CommandType::C_ASM:
+        cmd.arg1 = parser.arg1();
+        break;
+      case CommandType::C_RETURN:
+        break;
+    }
+    commands.push_back(std::move(cmd));
+  }
+  return commands;
+}
+
+void VMTranslator::collectCallArity(const std::vector<std::vector<VmCommand>>& programs) {
+  m_callArity.clear();
+  std::unordered_set<std::string> inconsistent;
+
+  for (const auto& commands : programs) {
+    for (const VmCommand& cmd : commands) {
+      if (cmd.type != CommandType::C_CALL) continue;
+      const auto [it, inserted] = m_callArity.try_emplace(cmd.arg1, static_cast<uint32_t>(cmd.arg2));
+      if (!inserted && it->second != static_cast<uint32_t>(cmd.arg2))
+        inconsistent.insert(cmd.arg1);
+    }
+  }
+
+  for (const std::string& name : inconsistent)
+    m_callArity.erase(name);
+}
+
+FrameLayout VMTranslator::frameOf(const std::string& functionName) const {
+  const auto frame = m_frames.find(functionName);
+  return (frame != m_frames.end()) ? frame->second.layout : FrameLayout{};
+}
+
+std::size_t VMTranslator::savedPerCall(const FrameLayout& layout) const {
+  const auto cost = [this](const FrameLayout& frame) {
+    CountingSink sink;
+    CodeWriter cw(sink);
+    cw.setOptions(m_options);
+    // A `return-void` and a `call-void`; with a value they need `push constant 0` and a drop.
+    cw.writeFunction("f", 0, frame);
+    if (frame.returnsValue)
+      cw.writePushConstant(0);
+    cw.writeReturn();
+    cw.writeCall("f", 0, frame);
+    if (frame.returnsValue)
+      cw.writeArithmetic("drop");
+    cw.flushStackPointer();
+    return sink.count;
+  };
+  return cost(FrameLayout{}) - cost(layout);
+}
+
+void VMTranslator::writeFrameReport(std::ostream& out) const {
+  std::size_t functions{}, calls{}, saved{};
+
+  out << std::left << std::setw(32) << "Function" << std::setw(24) << "Frame"
+      << std::right << std::setw(8) << "Calls" << std::setw(12) << "Saved/call" << '\n';
+
+  for (const auto& [name, frame] : m_frames) {
+    if (frame.layout == FrameLayout{})
+      continue;
+
+    std::string saves = "ret LCL ARG";
+    if (frame.layout.saveThis) saves += " THIS";
+    if (frame.layout.saveThat) saves += " THAT";
+    if (!frame.layout.returnsValue) saves += " void";
+
+    const std::size_t perCall = savedPerCall(frame.layout);
+    out << std::left << std::setw(32) << name << std::setw(24) << saves
+        << std::right << std::setw(8) << frame.callSites << std::setw(12) << perCall << '\n';
+
+    ++functions;
+    calls += frame.callSites;
+    saved += frame.callSites * perCall;
+  }
+
+  out << functions << " of " << m_frames.size() << " functions specialized, "
+      << calls << " call sites, " << saved << " instructions saved\n";
+}
+
+void VMTranslator::writeCostReport(std::ostream& out) const {
+  const auto endsBlock = [](const VmCommand& cmd) {
+    return cmd.type == CommandType::C_GOTO || cmd.type == CommandType::C_IF || cmd.type == CommandType::C_RETURN;
+  };
+  const auto costLine = [&out](std::size_t indent, const std::string& what, const CommandCost& cost) {
+    out << std::string(indent, ' ') << std::left << std::setw(static_cast<int>(44 - indent)) << what
+        << std::right << std::setw(8) << cost.words << std::setw(8) << cost.path << '\n';
+  };
+
+  std::size_t total{}, functions{};
+  out << std::left << std::setw(44) << "Function / block / command" << std::right
+      << std::setw(8) << "Words" << std::setw(8) << "Path" << '\n';
+
+  for (const TranslatedFile& file : m_translated) {
+    const std::vector<VmCommand>& commands = file.commands;
+
+    for (std::size_t start{}; start < commands.size();) {
+      // A function runs up to the next `function`; code before the first one is reported on its own.
+      std::size_t end = start + 1;
+      while (end < commands.size() && commands[end].type != CommandType::C_FUNCTION)
+        ++end;
+
+      const std::string name = (commands[start].type == CommandType::C_FUNCTION)
+                               ? commands[start].arg1
+                               : fs::path(file.path).filename().string() + " (top level)";
+      std::size_t words{};
+      for (std::size_t i = start; i < end; ++i)
+        words += file.costs[i].words;
+      out << '\n' << name << ": " << words << " words\n";
+
+      std::size_t block{};
+      for (std::size_t first = start; first < end; ++block) {
+        std::size_t last = first + 1;
+        while (last < end && commands[last].type != CommandType::C_LABEL && !endsBlock(commands[last - 1]))
+          ++last;
+
+        CommandCost cost;
+        for (std::size_t i = first; i < last; ++i) {
+          cost.words += file.costs[i].words;
+          cost.path += file.costs[i].path;
+        }
+        costLine(2, "block " + std::to_string(block), cost);
+        for (std::size_t i = first; i < last; ++i)
+          costLine(4, toString(commands[i]), file.costs[i]);
+        first = last;
+      }
+
+      total += words;
+      ++functions;
+      start = end;
+    }
+  }
+
+  out << '\n' << total << " instructions in " << functions << " functions\n";
+}
+
+std::vector<VMTranslator::CommandCost> VMTranslator::translateFile(const std::string& vmPath,
+                                                                  const std::vector<VmCommand>& commands,
+                                                                  CodeWriter& cw) const {
+  // Static symbol base = file stem
+  cw.setCurrentFile(fs::path(vmPath).stem().string());
+  cw.setOptions(m_options);
+
+  // Argument count of the function being translated, if every caller agrees on it.
+  const uint32_t* callerArgs = nullptr;
+  FrameLayout currentFrame;
+
+  std::vector<CommandCost> costs(commands.size());
+
+  for (std::size_t i{}; i < commands.size(); ++i) {
+    const VmCommand& cmd = commands[i];
+    const std::size_t first = i;
+    const CommandCost before { cw.instructionCount(), cw.pathLength() };
+
+    switch (cmd.type) {
+      case CommandType::C_ARITHMETIC:
+        cw.writeArithmetic(cmd.arg1);
         break;
       case CommandType::C_PUSH:
+        if (m_options.aluConstants && cmd.arg1 == "constant") {
+          // Fold any neg/not applied directly to the constant into the push itself.
+          uint16_t word = static_cast<uint16_t>(cmd.arg2);
+          while (i + 1 < commands.size() && commands[i + 1].type == CommandType::C_ARITHMETIC &&
+                 (commands[i + 1].arg1 == "neg" || commands[i + 1].arg1 == "not")) {
+            word = (commands[i + 1].arg1 == "neg") ? static_cast<uint16_t>(0u - word)
+                                                   : static_cast<uint16_t>(~word);
+            ++i;
+          }
+          cw.writePushConstant(word);
+          break;
+        }
+        [[fallthrough]];
       case CommandType::C_POP:
-        cw.writePushPop(parser.commandType(), parser.arg1(), static_cast<uint32_t>(parser.arg2()));
+        cw.writePushPop(cmd.type, cmd.arg1, static_cast<uint32_t>(cmd.arg2));
         break;
       case CommandType::C_LABEL:
-        cw.writeLabel(parser.arg1());
+        cw.writeLabel(cmd.arg1);
         break;
       case CommandType::C_GOTO:
-        cw.writeGoto(parser.arg1());
+        cw.writeGoto(cmd.arg1);
         break;
       case CommandType::C_IF:
-        cw.writeIf(parser.arg1());
+        cw.writeIf(cmd.arg1);
         break;
-      case CommandType::C_FUNCTION:
-        cw.writeFunction(parser.arg1(), static_cast<uint32_t>(parser.arg2()));
+      case CommandType::C_FUNCTION: {
+        currentFrame = frameOf(cmd.arg1);
+        cw.writeFunction(cmd.arg1, static_cast<uint32_t>(cmd.arg2), currentFrame);
+        const auto arity = m_callArity.find(cmd.arg1);
+        callerArgs = (arity != m_callArity.end()) ? &arity->second : nullptr;
         break;
-      case CommandType::C_CALL:
-        cw.writeCall(parser.arg1(), static_cast<uint32_t>(parser.arg2()));
+      }
+      case CommandType::C_CALL: {
+        const FrameLayout calleeFrame = frameOf(cmd.arg1);
+        // `call f n; return` can reuse the current frame when it has room for f's arguments
+        // and f's return expects the same layout. `call-void f n; return-void` only can when
+        // neither function returns a value, since the caller's callers would get f's instead of 0.
+        if (m_options.tailCalls && callerArgs && static_cast<uint32_t>(cmd.arg2) <= *callerArgs &&
+            calleeFrame == currentFrame &&
+            i + 1 < commands.size() && commands[i + 1].type == CommandType::C_RETURN &&
+            commands[i + 1].isVoid == cmd.isVoid && (!cmd.isVoid || !calleeFrame.returnsValue)) {
+          cw.writeTailCall(cmd.arg1, static_cast<uint32_t>(cmd.arg2), *callerArgs, calleeFrame);
+          ++i;
+          break;
+        }
+        cw.writeCall(cmd.arg1, static_cast<uint32_t>(cmd.arg2), calleeFrame);
+        if (cmd.isVoid && calleeFrame.returnsValue)
+          cw.writeArithmetic("drop");
         break;
+      }
       case CommandType::C_RETURN:
+        if (cmd.isVoid && currentFrame.returnsValue)
+          cw.writePushConstant(0);
         cw.writeReturn();
         break;
+      case CommandType::C_ASM:
+        cw.writeAsm(cmd.arg1);
+        break;
       default:
         // no-op / or throw if you prefer strictness
         break;
     }
+
+    // The final SP flush is charged to the last command.
+    if (i + 1 == commands.size())
+      cw.flushStackPointer();
+    costs[first] = { cw.instructionCount() - before.words, cw.pathLength() - before.path };
   }
+
+  cw.flushStackPointer();
+  return costs;
+}
+
+void VMTranslator::translatePerFile(const std::vector<std::string>& vmFiles,
+                                    const std::function<void(std::size_t)>& translateOne) const {
+  ThreadPool pool(std::min<std::size_t>(vmFiles.size(), std::thread::hardware_concurrency()));
+
+  std::vector<std::future<void>> pending;
+  pending.reserve(vmFiles.size());
+  for (std::size_t i{}; i < vmFiles.size(); ++i)
+    pending.push_back(pool.submit([&translateOne, i] { translateOne(i); }));
+
+  // Wait in file order so the first failing file (in sorted order) is reported.
+  for (auto& done : pending) done.get();
+}
+
+bool VMTranslator::isRomOutput(const std::string& outPath) const {
+  const auto ext = fs::path(outPath).extension();
+  return ext == ".hack" || ext == ".bin";
 }
 
 void VMTranslator::translate(const std::string& inPath, const std::string& outAsmPath) {
   const auto vmFiles = collectVmFiles(inPath);
   const std::string out = outAsmPath.empty() ? computeOutAsm(inPath) : outAsmPath;
 
+  std::vector<std::vector<VmCommand>> programs(vmFiles.size());
+  translatePerFile(vmFiles, [this, &vmFiles, &programs](std::size_t i) {
+    programs[i] = loadFile(vmFiles[i]);
+    if (m_options.optimizeSlots)
+      optimizeSlots(programs[i], m_options.privateTemps);
+  });
+  collectCallArity(programs);
+  m_frames.clear();
+  if (m_options.frameSpecialization || m_options.voidReturns) {
+    m_frames = analyzeFrames(programs);
+    for (auto& [name, frame] : m_frames) {
+      if (!m_options.frameSpecialization)
+        frame.layout.saveThis = frame.layout.saveThat = true;
+      if (!m_options.voidReturns)
+        frame.layout.returnsValue = true;
+    }
+  }
+
+  m_translated.assign(vmFiles.size(), {});
+  for (std::size_t i{}; i < vmFiles.size(); ++i)
+    m_translated[i].path = vmFiles[i];
+
+  // Every file gets its own writer and output unit, so files translate independently.
+  if (isRomOutput(out)) {
+    std::vector<HackWriter> units(vmFiles.size());
+    translatePerFile(vmFiles, [this, &vmFiles, &programs, &units](std::size_t i) {
+      CodeWriter fileWriter(units[i]);
+      m_translated[i].costs = translateFile(vmFiles[i], programs[i], fileWriter);
+      m_translated[i].commands = std::move(programs[i]);
+    });
+
+    writeRom(out, linkHack(units));
+    return;
+  }
+
+  std::vector<std::ostringstream> buffers(vmFiles.size());
+  translatePerFile(vmFiles, [this, &vmFiles, &programs, &buffers](std::size_t i) {
+    CodeWriter fileWriter(buffers[i]);
+    m_translated[i].costs = translateFile(vmFiles[i], programs[i], fileWriter);
+    m_translated[i].commands = std::move(programs[i]);
+  });
+
   CodeWriter cw(out); // opens the .asm
 
-  for (const auto& f : vmFiles) translateFile(f, cw);
+  for (const auto& buffer : buffers) cw.append(buffer.str());
 
   cw.close();
 }
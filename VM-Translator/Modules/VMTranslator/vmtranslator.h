@@ -1,31 +1,120 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <ostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "../CodeWriter/codeWriter.h"
+#include "frameAnalysis.h"
+#include "../Utils/FrameLayout.h"
+#include "../Utils/TranslatorOptions.h"
+#include "../Utils/VmCommand.h"
 
 
 class VMTranslator {
 public:
 
+  /**
+   * @brief Creates a translator.
+   * @param options Code-generation improvements applied to every file.
+   */
+  explicit VMTranslator(TranslatorOptions options = {});
+
   /**
    * @brief Translate a single .vm file or all .vm files in a directory.
+   *
+   * All files are parsed first so program-wide facts (such as each
+   * function's argument count) are known; then files are translated
+   * concurrently, each into its own buffer, and the buffers are written out
+   * in the sorted order of collectVmFiles().
+   * An output path ending in `.hack` or `.bin` selects the machine-code
+   * backend: instructions are encoded directly, with no assembly text in
+   * between, and the per-file units are linked into a ROM image.
    * @param inPath      Path to input .vm file or directory containing .vm files.
-   * @param outAsmPath  Optional explicit output .asm path. If empty, a path is computed:
+   * @param outAsmPath  Optional explicit output .asm/.hack/.bin path. If empty, a path is computed:
    *                    - input.vm  -> input.asm
    *                    - Dir/      -> Dir/Dir.asm
    * @throws std::runtime_error on invalid paths or I/O errors.
    */
   void translate(const std::string& inPath, const std::string& outAsmPath = "");
 
-private:
+  /**
+   * @brief Prints the specialized frame layouts chosen by the last translate().
+   *
+   * Lists every function whose callers skip saving THIS and/or THAT, or
+   * that returns no value, with its call sites and the instructions saved
+   * per call (push in the caller plus restore in the callee's return).
+   */
+  void writeFrameReport(std::ostream& out) const;
 
-  /// Collect all .vm files from a file-or-directory input (sorted for deterministic output).
+  /**
+   * @brief Prints the static cost of the code produced by the last translate().
+   *
+   * For every function: its ROM size, then each basic block (split at
+   * labels and after goto/if-goto/return) with its size and the number of
+   * instructions on its longest path, then each VM command with the same
+   * two numbers. Path lengths do not include the time spent in callees.
+   */
+  void writeCostReport(std::ostream& out) const;
+
+  /// Collect all .vm/.vmb files from a file-or-directory input (sorted for deterministic output).
   std::vector<std::string> collectVmFiles(const std::string& inPath) const;
 
+  /// Parse a whole .vm (text) or .vmb (binary) file into memory so code generation can look ahead.
+  std::vector<VmCommand> loadFile(const std::string& vmPath) const;
+
+private:
+
+  /// Instructions emitted for one VM command, and how many of them its longest path executes.
+  struct CommandCost {
+    std::size_t words{};
+    std::size_t path{};
+  };
+
+  /// A translated file with the cost of each of its commands.
+  struct TranslatedFile {
+    std::string path;
+    std::vector<VmCommand> commands;
+    std::vector<CommandCost> costs;
+  };
+
+  TranslatorOptions m_options;
+
+  /// Every file of the last translate(), in output order (for writeCostReport()).
+  std::vector<TranslatedFile> m_translated;
+
+  /// Argument count of every function the program calls, when all its call sites agree.
+  std::unordered_map<std::string, uint32_t> m_callArity;
+
+  /// Frame analysis of every defined function (empty when frame specialization and void returns are off).
+  std::map<std::string, FunctionFrame> m_frames;
+
+  /// Layout used by calls to (and the return of) the named function.
+  FrameLayout frameOf(const std::string& functionName) const;
+
+  /// Instructions a call + return with the given layout saves over the full frame.
+  std::size_t savedPerCall(const FrameLayout& layout) const;
+
   /// Compute default output .asm path based on input path.
   std::string computeOutAsm(const std::string& inPath) const;
 
-  /// Translate a single .vm file using the provided CodeWriter (which owns the open .asm stream).
-  void translateFile(const std::string& vmPath, CodeWriter& cw) const;
+  /// True when the output path asks for a machine-code ROM instead of assembly.
+  bool isRomOutput(const std::string& outPath) const;
+
+  /// Run translateOne(i) for every input file on a thread pool; rethrows the first failure in file order.
+  void translatePerFile(const std::vector<std::string>& vmFiles,
+                        const std::function<void(std::size_t)>& translateOne) const;
+
+  /// Record the argument count of each called function across all loaded files.
+  void collectCallArity(const std::vector<std::vector<VmCommand>>& programs);
+
+  /**
+   * Translate a single loaded .vm file using the provided CodeWriter (one writer per file).
+   * Returns the cost of each command; a command folded into the one before it costs nothing.
+   */
+  std::vector<CommandCost> translateFile(const std::string& vmPath, const std::vector<VmCommand>& commands,
+                                         CodeWriter& cw) const;
 };
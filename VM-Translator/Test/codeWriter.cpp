@@ -7,6 +7,8 @@
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include "../Modules/CodeWriter/codeWriter.h"
 
 using namespace testing;
@@ -326,3 +328,244 @@ TEST_F(CodeWriterTestObject, labelsAreUnqualifiedOutsideFunctionQualifiedInside)
   EXPECT_NE(content.find("@Bar$LOOP"),  std::string::npos);
   EXPECT_NE(content.find("@Bar$END"),   std::string::npos);
 }
+
+/**
+ * @brief Tests that ALU constants are pushed without a D round-trip.
+ *
+ * 0, 1 and -1 are written with M=0 / M=1 / M=-1; other negative words use D=-A.
+ */
+TEST_F(CodeWriterTestObject, writePushConstantUsesAluConstants) {
+  ASSERT_TRUE(codeWriter);
+
+  codeWriter->writePushConstant(0);
+  codeWriter->writePushConstant(1);
+  codeWriter->writePushConstant(0xFFFF);
+  codeWriter->writePushConstant(static_cast<uint16_t>(-5));
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(content.find("@SP\nM=M+1\nA=M-1\nM=0\n"),  std::string::npos);
+  EXPECT_NE(content.find("@SP\nM=M+1\nA=M-1\nM=1\n"),  std::string::npos);
+  EXPECT_NE(content.find("@SP\nM=M+1\nA=M-1\nM=-1\n"), std::string::npos);
+  EXPECT_NE(content.find("@5\nD=-A\n"),                std::string::npos);
+  EXPECT_EQ(content.find("@0\nD=A"),                   std::string::npos);
+}
+
+/**
+ * @brief Tests that disabling ALU constants restores the generic constant push.
+ */
+TEST_F(CodeWriterTestObject, writePushConstantHonoursOptions) {
+  ASSERT_TRUE(codeWriter);
+
+  TranslatorOptions options;
+  options.aluConstants = false;
+  codeWriter->setOptions(options);
+  codeWriter->writePushPop(CommandType::C_PUSH, "constant", 1);
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(content.find("@1\nD=A\n@SP\nA=M\nM=D\n@SP\nM=M+1\n"), std::string::npos);
+}
+
+/**
+ * @brief Tests writeTailCall reuses the caller's frame instead of pushing a new one.
+ *
+ * The argument is popped into ARG[0], LCL/SP are reset above the saved frame
+ * and control jumps to the callee without a return label.
+ */
+TEST_F(CodeWriterTestObject, writeTailCallReusesCallerFrame) {
+  ASSERT_TRUE(codeWriter);
+
+  codeWriter->writeFunction("Main", 0);
+  codeWriter->writeTailCall("Foo", 1, 1);
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_EQ(content.find("$ret."), std::string::npos);
+  EXPECT_NE(content.find("@SP\nAM=M-1\nD=M\n@ARG\nA=M\nM=D\n"), std::string::npos);
+  EXPECT_NE(content.find("@ARG\nD=M\n@6\nD=D+A\n@LCL\nM=D\n@SP\nM=D\n@Foo\n0;JMP\n"), std::string::npos);
+
+  // Same argument count: the saved frame already sits in the right place.
+  EXPECT_EQ(content.find("@R14"), std::string::npos);
+}
+
+/**
+ * @brief Tests writeTailCall slides the saved frame down when passing fewer arguments.
+ */
+TEST_F(CodeWriterTestObject, writeTailCallMovesFrameForFewerArgs) {
+  ASSERT_TRUE(codeWriter);
+
+  codeWriter->writeFunction("Main", 0);
+  codeWriter->writeTailCall("Foo", 0, 2);
+  EXPECT_THROW(codeWriter->writeTailCall("Foo", 3, 2), std::logic_error);
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(content.find("@LCL\nD=M\n@6\nD=D-A\n@R13\nM=D\n@ARG\nD=M-1\n@R14\nM=D\n"), std::string::npos);
+  EXPECT_NE(content.find("@R13\nAM=M+1\nD=M\n@R14\nAM=M+1\nM=D\n"), std::string::npos);
+  EXPECT_NE(content.find("@ARG\nD=M\n@5\nD=D+A\n@LCL\nM=D\n@SP\nM=D\n@Foo\n0;JMP\n"), std::string::npos);
+}
+
+/**
+ * @brief Tests that SP batching addresses stack slots as SP+k and never writes SP within a block.
+ *
+ * `push 7; push 8; add; pop temp 0` leaves the stack where it started, so no
+ * SP adjustment is emitted at all.
+ */
+TEST_F(CodeWriterTestObject, spBatchingAddressesSlotsWithoutWritingSP) {
+  ASSERT_TRUE(codeWriter);
+
+  TranslatorOptions options;
+  options.spBatching = true;
+  codeWriter->setOptions(options);
+  codeWriter->writePushPop(CommandType::C_PUSH, "constant", 7);
+  codeWriter->writePushPop(CommandType::C_PUSH, "constant", 8);
+  codeWriter->writeArithmetic("add");
+  codeWriter->writePushPop(CommandType::C_POP, "temp", 0);
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(content.find("@7\nD=A\n@SP\nA=M\nM=D\n"),            std::string::npos);
+  EXPECT_NE(content.find("@8\nD=A\n@SP\nA=M+1\nM=D\n"),          std::string::npos);
+  EXPECT_NE(content.find("@SP\nA=M+1\nD=M\nA=A-1\nM=M+D\n"),     std::string::npos);
+  EXPECT_NE(content.find("@SP\nA=M\nD=M\n@R5\nM=D\n"),           std::string::npos);
+  EXPECT_EQ(content.find("M=M+1"),                               std::string::npos);
+  EXPECT_EQ(content.find("M=M-1"),                               std::string::npos);
+}
+
+/**
+ * @brief Tests that a pending SP adjustment is committed before a label and folded into if-goto.
+ */
+TEST_F(CodeWriterTestObject, spBatchingCommitsAtBlockBoundaries) {
+  ASSERT_TRUE(codeWriter);
+
+  TranslatorOptions options;
+  options.spBatching = true;
+  codeWriter->setOptions(options);
+  codeWriter->writePushPop(CommandType::C_PUSH, "local", 0);
+  codeWriter->writePushPop(CommandType::C_PUSH, "local", 1);
+  codeWriter->writeLabel("L");
+  codeWriter->writePushPop(CommandType::C_PUSH, "local", 0);
+  codeWriter->writePushPop(CommandType::C_PUSH, "local", 1);
+  codeWriter->writeIf("L");
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(content.find("@SP\nM=M+1\nM=M+1\n(L)\n"),       std::string::npos);
+  EXPECT_NE(content.find("@SP\nAM=M+1\nD=M\n@L\nD;JNE\n"),  std::string::npos);
+}
+
+/**
+ * @brief Tests that a specialized frame layout drops THIS/THAT from both the call and the return.
+ */
+TEST_F(CodeWriterTestObject, reducedFrameSkipsThisAndThat) {
+  ASSERT_TRUE(codeWriter);
+
+  const FrameLayout reduced { false, false };
+  codeWriter->writeFunction("Leaf", 0, reduced);
+  codeWriter->writeReturn();
+  codeWriter->writeCall("Leaf", 2, reduced);
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  // RET = *(FRAME - 3); ARG = SP - 3 - nArgs
+  EXPECT_NE(content.find("@3\nA=D-A\nD=M\n@R14\nM=D\n"),                  std::string::npos);
+  EXPECT_NE(content.find("@SP\nD=M\n@3\nD=D-A\n@2\nD=D-A\n@ARG\nM=D\n"),  std::string::npos);
+  EXPECT_EQ(content.find("@THIS"),                                        std::string::npos);
+  EXPECT_EQ(content.find("@THAT"),                                        std::string::npos);
+}
+
+/**
+ * @brief Tests that the instruction counters charge a comparison's two result writes to one path.
+ */
+TEST_F(CodeWriterTestObject, countsInstructionsAndLongestPath) {
+  ASSERT_TRUE(codeWriter);
+
+  codeWriter->writePushPop(C_PUSH, "local", 0);
+  const std::size_t pushWords = codeWriter->instructionCount();
+  EXPECT_EQ(codeWriter->pathLength(), pushWords);
+
+  codeWriter->writeArithmetic("eq");
+  const std::size_t eqWords = codeWriter->instructionCount() - pushWords;
+  const std::size_t eqPath  = codeWriter->pathLength() - pushWords;
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  std::string line;
+  std::size_t words{};
+  while (std::getline(asmFile, line))
+    if (!line.empty() && line[0] != '(' && line.rfind("//", 0) != 0)
+      ++words;
+
+  EXPECT_EQ(codeWriter->instructionCount(), words);
+  // The false write (A=M, A=A-1, M=0, @END, 0;JMP) is longer than the true one (A=M, A=A-1, M=-1).
+  EXPECT_EQ(eqWords - eqPath, 3u);
+}
+
+/**
+ * @brief Tests that `asm` instructions are written as given, after any pending SP adjustment.
+ */
+TEST_F(CodeWriterTestObject, writeAsmPassesInstructionsThrough) {
+  ASSERT_TRUE(codeWriter);
+
+  TranslatorOptions options;
+  options.spBatching = true;
+  codeWriter->setOptions(options);
+  codeWriter->writePushPop(CommandType::C_PUSH, "local", 0);
+  codeWriter->writeAsm("(Main.f$ASM0.LOOP)");
+  codeWriter->writeAsm("@SCREEN");
+  codeWriter->writeAsm("M=-1");
+  codeWriter->writeAsm("@32767");
+  codeWriter->writeAsm("D;JGT");
+  codeWriter->writeAsm("@Main.f$ASM0.LOOP");
+  codeWriter->writeAsm("AM=M+1;JMP");
+  EXPECT_THROW(codeWriter->writeAsm("D="), std::runtime_error);
+  EXPECT_THROW(codeWriter->writeAsm("@32768"), std::runtime_error);
+  EXPECT_THROW(codeWriter->writeAsm("0;"), std::runtime_error);
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  ASSERT_TRUE(asmFile.is_open());
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(content.find("@SP\nM=M+1\n(Main.f$ASM0.LOOP)\n@SCREEN\nM=-1\n@32767\nD;JGT\n"
+                         "@Main.f$ASM0.LOOP\nAM=M+1;JMP\n"),
+            std::string::npos);
+}
+
+/**
+ * @brief Tests that `asm` mnemonics outside the Hack encoding tables are rejected, not encoded as zero bits.
+ */
+TEST_F(CodeWriterTestObject, writeAsmRejectsUnknownMnemonics) {
+  ASSERT_TRUE(codeWriter);
+
+  for (const char* instruction : { "D=Q+1", "M=D;JXX", "DM=D", "X=1", "D+D", "M=D+1;" })
+    EXPECT_THROW(codeWriter->writeAsm(instruction), std::runtime_error) << instruction;
+  codeWriter->writeAsm("AMD=M|D;JNE");
+  codeWriter->close();
+
+  std::ifstream asmFile(asm_filepath);
+  std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+  EXPECT_EQ(content, "AMD=M|D;JNE\n");
+}
@@ -0,0 +1,120 @@
+/**
+ * @file functionAnalysis.cpp
+ * @brief Unit tests for the VM control-flow, stack-depth and liveness analysis.
+ */
+#include "gtest/gtest.h"
+#include <stdexcept>
+#include <vector>
+#include "../Modules/Analysis/functionAnalysis.h"
+
+using namespace testing;
+
+namespace {
+VmCommand push(const char* segment, int32_t index) { return { CommandType::C_PUSH, segment, index }; }
+VmCommand pop(const char* segment, int32_t index)  { return { CommandType::C_POP, segment, index }; }
+VmCommand op(const char* name)                     { return { CommandType::C_ARITHMETIC, name, 0 }; }
+VmCommand label(const char* name)                  { return { CommandType::C_LABEL, name, 0 }; }
+VmCommand jump(const char* name)                   { return { CommandType::C_GOTO, name, 0 }; }
+VmCommand jumpIf(const char* name)                 { return { CommandType::C_IF, name, 0 }; }
+VmCommand call(const char* name, int32_t nArgs)    { return { CommandType::C_CALL, name, nArgs }; }
+VmCommand function(const char* name, int32_t nVars){ return { CommandType::C_FUNCTION, name, nVars }; }
+VmCommand ret()                                    { return { CommandType::C_RETURN, {}, 0 }; }
+
+/** @brief `while (local 0) {}` followed by `return 1`, with one word kept on the stack throughout. */
+std::vector<VmCommand> loopBody() {
+  return { push("constant", 0),
+           label("LOOP"), push("local", 0), jumpIf("END"),
+           jump("LOOP"),
+           label("END"), push("constant", 1), ret() };
+}
+}
+
+/**
+ * @brief Blocks split at labels and after jumps/returns; edges follow goto, if-goto and fall-through.
+ */
+TEST(FunctionAnalysisTest, buildsBasicBlocksAndEdges) {
+  FunctionAnalysis f("Main.loop", 1, loopBody());
+
+  ASSERT_EQ(f.blocks().size(), 4u);
+  EXPECT_EQ(f.blocks()[0].successors, (std::vector<std::size_t>{ 1 }));
+  EXPECT_EQ(f.blocks()[1].successors, (std::vector<std::size_t>{ 3, 2 }));
+  EXPECT_EQ(f.blocks()[2].successors, (std::vector<std::size_t>{ 1 }));
+  EXPECT_TRUE(f.blocks()[3].successors.empty());
+  EXPECT_EQ(f.blockOf(3), 1u);
+}
+
+/**
+ * @brief Stack depth is tracked through every command, and the high-water mark includes frame and locals.
+ */
+TEST(FunctionAnalysisTest, tracksStackDepth) {
+  FunctionAnalysis f("Main.loop", 1, loopBody());
+
+  EXPECT_EQ(f.depthBefore(0), 0);
+  EXPECT_EQ(f.depthBefore(3), 2);
+  EXPECT_EQ(f.depthBefore(4), 1);
+  EXPECT_EQ(f.depthBefore(7), 2);
+  EXPECT_EQ(f.maxDepth(), 2);
+  EXPECT_EQ(f.maxStackUsage(), 5u + 1u + 2u);
+}
+
+/**
+ * @brief Malformed control flow is reported instead of producing a bogus analysis.
+ */
+TEST(FunctionAnalysisTest, rejectsInconsistentStackAndUnknownLabels) {
+  EXPECT_THROW(FunctionAnalysis("Bad.grow", 0, { label("L"), push("constant", 1), jump("L") }),
+               std::runtime_error);
+  EXPECT_THROW(FunctionAnalysis("Bad.jump", 0, { jump("NOWHERE") }), std::runtime_error);
+  EXPECT_THROW(FunctionAnalysis("Bad.pop", 0, { pop("local", 0), ret() }), std::runtime_error);
+}
+
+/**
+ * @brief A store that is never read again is dead; temps are only private when promised.
+ */
+TEST(FunctionAnalysisTest, computesSlotLiveness) {
+  const std::vector<VmCommand> body {
+    push("constant", 7), pop("local", 0),
+    push("local", 0), pop("local", 1),
+    push("constant", 3), pop("temp", 0),
+    push("constant", 0), ret()
+  };
+
+  FunctionAnalysis shared("Main.f", 2, body);
+  EXPECT_TRUE(shared.liveAfter(1)[*shared.slotOf("local", 0)]);
+  EXPECT_FALSE(shared.liveAfter(3)[*shared.slotOf("local", 1)]);
+  EXPECT_EQ(shared.deadStores(), (std::vector<std::size_t>{ 3 }));
+
+  FunctionAnalysis jack("Main.f", 2, body, true);
+  EXPECT_EQ(jack.deadStores(), (std::vector<std::size_t>{ 3, 5 }));
+  EXPECT_FALSE(jack.slotOf("local", 2));
+}
+
+/**
+ * @brief Loop-carried liveness reaches a fixed point across the back edge.
+ */
+TEST(FunctionAnalysisTest, propagatesLivenessAroundLoops) {
+  FunctionAnalysis f("Main.count", 1, {
+    label("LOOP"), push("local", 0), push("constant", 1), op("sub"), pop("local", 0),
+    push("local", 0), jumpIf("LOOP"),
+    push("constant", 0), ret() });
+
+  EXPECT_TRUE(f.liveAfter(4)[*f.slotOf("local", 0)]);
+  EXPECT_TRUE(f.deadStores().empty());
+}
+
+/**
+ * @brief Call-chain stack usage adds each callee on top of the caller's depth at the call.
+ */
+TEST(FunctionAnalysisTest, computesStackHighWaterAcrossCalls) {
+  const auto functions = analyzeFunctions({
+    function("Main.main", 1), push("constant", 1), push("constant", 2), call("Main.leaf", 2), ret(),
+    function("Main.leaf", 0), push("argument", 0), ret(),
+    function("Main.rec", 0), push("constant", 0), call("Main.rec", 1), ret() });
+
+  ASSERT_EQ(functions.size(), 3u);
+  EXPECT_EQ(functions[0].callees(), (std::vector<std::string>{ "Main.leaf" }));
+
+  // leaf: frame 5 + 1 operand; main: frame 5 + 1 local + 2 args under the callee.
+  EXPECT_EQ(stackHighWater(functions, "Main.leaf"), 6u);
+  EXPECT_EQ(stackHighWater(functions, "Main.main"), 5u + 1u + 2u + 6u);
+  EXPECT_FALSE(stackHighWater(functions, "Main.rec"));
+}
@@ -0,0 +1,129 @@
+/**
+ * @file hackWriter.cpp
+ * @brief Unit tests for direct machine-code emission and linking.
+ */
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../Modules/CodeWriter/codeWriter.h"
+#include "../Modules/HackWriter/hackWriter.h"
+#include "../Modules/VMTranslator/vmtranslator.h"
+
+using namespace testing;
+
+/**
+ * @brief C-instructions are encoded with the assembler's tables.
+ */
+TEST(HackWriterTest, encodesComputeInstructions) {
+  HackWriter unit;
+  unit.compute("D", "A", "");
+  unit.compute("AM", "M-1", "");
+  unit.compute("M", "M+D", "");
+  unit.compute("", "0", "JMP");
+
+  ASSERT_EQ(unit.words().size(), 4u);
+  EXPECT_EQ(unit.words()[0], 0b1110110000010000);
+  EXPECT_EQ(unit.words()[1], 0b1111110010101000);
+  EXPECT_EQ(unit.words()[2], 0b1111000010001000);
+  EXPECT_EQ(unit.words()[3], 0b1110101010000111);
+}
+
+/**
+ * @brief Labels resolve across units; predefined symbols and variables match the assembler.
+ */
+TEST(HackWriterTest, linksLabelsPredefinedSymbolsAndVariables) {
+  std::vector<HackWriter> units(2);
+
+  units[0].address("SP");
+  units[0].address("Target");     // label defined in the second unit
+  units[0].address("Foo.0");      // first variable -> RAM 16
+  units[1].address("Bar.1");      // second variable -> RAM 17
+  units[1].label("Target");
+  units[1].address("Foo.0");
+  units[1].address(7u);
+
+  std::vector<uint16_t> rom = linkHack(units);
+
+  ASSERT_EQ(rom.size(), 6u);
+  EXPECT_EQ(rom[0], 0);
+  EXPECT_EQ(rom[1], 4);
+  EXPECT_EQ(rom[2], 16);
+  EXPECT_EQ(rom[3], 17);
+  EXPECT_EQ(rom[4], 16);
+  EXPECT_EQ(rom[5], 7);
+}
+
+/**
+ * @brief Duplicate labels across units are rejected.
+ */
+TEST(HackWriterTest, rejectsDuplicateLabels) {
+  std::vector<HackWriter> units(2);
+  units[0].label("Main.main");
+  units[1].label("Main.main");
+
+  EXPECT_THROW(linkHack(units), std::runtime_error);
+}
+
+/**
+ * @brief The machine-code backend emits exactly one word per instruction the text backend prints.
+ */
+TEST(HackWriterTest, matchesAssemblyInstructionCount) {
+  std::ostringstream text;
+  HackWriter unit;
+  {
+    CodeWriter asmWriter(text);
+    CodeWriter hackWriter(unit);
+    for (CodeWriter* cw : { &asmWriter, &hackWriter }) {
+      cw->writeFunction("Main.main", 2);
+      cw->writePushPop(CommandType::C_PUSH, "constant", 7);
+      cw->writePushPop(CommandType::C_POP, "local", 1);
+      cw->writeArithmetic("eq");
+      cw->writeCall("Main.main", 0);
+      cw->writeReturn();
+    }
+  }
+
+  std::istringstream lines(text.str());
+  std::size_t instructions {};
+  for (std::string line; std::getline(lines, line);) {
+    if (!line.empty() && line[0] != '(' && line[0] != '/')
+      ++instructions;
+  }
+
+  EXPECT_EQ(unit.words().size(), instructions);
+}
+
+/**
+ * @brief Translating to a `.hack` path writes one 16-bit binary string per instruction.
+ */
+TEST(HackWriterTest, translatorWritesHackRom) {
+  auto vmPath   = std::filesystem::temp_directory_path() / "hackwriter_tmp.vm";
+  auto hackPath = std::filesystem::temp_directory_path() / "hackwriter_tmp.hack";
+  {
+    std::ofstream file(vmPath);
+    file << "push constant 2" << '\n';
+    file << "push constant 3" << '\n';
+    file << "add" << '\n';
+  }
+
+  VMTranslator translator;
+  translator.translate(vmPath.string(), hackPath.string());
+
+  std::ifstream hack(hackPath);
+  std::vector<std::string> words;
+  for (std::string line; std::getline(hack, line);)
+    words.push_back(line);
+
+  ASSERT_FALSE(words.empty());
+  EXPECT_EQ(words[0], "0000000000000010");   // @2
+  EXPECT_EQ(words[2], "0000000000000000");   // @SP
+  for (const std::string& word : words)
+    EXPECT_EQ(word.size(), 16u);
+
+  std::filesystem::remove(vmPath);
+  std::filesystem::remove(hackPath);
+}
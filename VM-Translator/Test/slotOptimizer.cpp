@@ -0,0 +1,251 @@
+/**
+ * @file slotOptimizer.cpp
+ * @brief Unit and differential tests for the local/temp slot optimizer.
+ */
+#include "gtest/gtest.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Modules/Optimizer/slotOptimizer.h"
+
+using namespace testing;
+
+namespace {
+/** @brief Parses VM source text, one command per line. */
+std::vector<VmCommand> parse(const std::string& source) {
+  std::vector<VmCommand> commands;
+  std::istringstream lines(source);
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream words(line);
+    std::string cmd, arg1;
+    int32_t arg2{};
+    if (!(words >> cmd)) continue;
+    words >> arg1 >> arg2;
+
+    if (cmd == "push")          commands.push_back({ CommandType::C_PUSH, arg1, arg2 });
+    else if (cmd == "pop")      commands.push_back({ CommandType::C_POP, arg1, arg2 });
+    else if (cmd == "label")    commands.push_back({ CommandType::C_LABEL, arg1, 0 });
+    else if (cmd == "goto")     commands.push_back({ CommandType::C_GOTO, arg1, 0 });
+    else if (cmd == "if-goto")  commands.push_back({ CommandType::C_IF, arg1, 0 });
+    else if (cmd == "function") commands.push_back({ CommandType::C_FUNCTION, arg1, arg2 });
+    else if (cmd == "call")     commands.push_back({ CommandType::C_CALL, arg1, arg2 });
+    else if (cmd == "return")   commands.push_back({ CommandType::C_RETURN, {}, 0 });
+    else                        commands.push_back({ CommandType::C_ARITHMETIC, cmd, 0 });
+  }
+  return commands;
+}
+
+/**
+ * @brief Minimal reference evaluator used as the differential oracle.
+ *
+ * Runs `entry` with the given arguments and returns its result; statics end
+ * up in `statics`. Segments: constant, local, argument, temp, static.
+ */
+class Evaluator {
+  private:
+    const std::vector<VmCommand>& m_program;
+    std::unordered_map<std::string, std::size_t> m_functions;
+    std::array<int16_t, 8> m_temp{};
+
+    struct Frame { std::size_t function; std::vector<int16_t> args, locals; };
+
+    std::size_t findLabel(std::size_t from, const std::string& label) const {
+      for (std::size_t i = from + 1; i < m_program.size() && m_program[i].type != CommandType::C_FUNCTION; ++i)
+        if (m_program[i].type == CommandType::C_LABEL && m_program[i].arg1 == label)
+          return i;
+      throw std::runtime_error("label " + label);
+    }
+
+  public:
+    std::map<int32_t, int16_t> statics;
+
+    explicit Evaluator(const std::vector<VmCommand>& program) : m_program(program) {
+      for (std::size_t i{}; i < program.size(); ++i)
+        if (program[i].type == CommandType::C_FUNCTION)
+          m_functions[program[i].arg1] = i;
+    }
+
+    int16_t run(const std::string& entry, std::vector<int16_t> args, int depth = 0) {
+      if (depth > 64) throw std::runtime_error("too deep");
+      const std::size_t start = m_functions.at(entry);
+      Frame frame { start, std::move(args), std::vector<int16_t>(m_program[start].arg2, 0) };
+      std::vector<int16_t> stack;
+      const auto pop = [&] { const int16_t v = stack.back(); stack.pop_back(); return v; };
+
+      for (std::size_t pc = start + 1, steps{}; steps < 100000; ++steps) {
+        const VmCommand& cmd = m_program[pc++];
+        switch (cmd.type) {
+          case CommandType::C_PUSH:
+            if (cmd.arg1 == "constant")      stack.push_back(static_cast<int16_t>(cmd.arg2));
+            else if (cmd.arg1 == "local")    stack.push_back(frame.locals.at(cmd.arg2));
+            else if (cmd.arg1 == "argument") stack.push_back(frame.args.at(cmd.arg2));
+            else if (cmd.arg1 == "temp")     stack.push_back(m_temp.at(cmd.arg2));
+            else                             stack.push_back(statics.count(cmd.arg2) ? statics.at(cmd.arg2) : 0);
+            break;
+          case CommandType::C_POP:
+            if (cmd.arg1 == "local")         frame.locals.at(cmd.arg2) = pop();
+            else if (cmd.arg1 == "argument") frame.args.at(cmd.arg2) = pop();
+            else if (cmd.arg1 == "temp")     m_temp.at(cmd.arg2) = pop();
+            else                             statics[cmd.arg2] = pop();
+            break;
+          case CommandType::C_ARITHMETIC: {
+            if (cmd.arg1 == "drop") { pop(); break; }
+            if (cmd.arg1 == "neg")  { stack.back() = static_cast<int16_t>(-stack.back()); break; }
+            if (cmd.arg1 == "not")  { stack.back() = static_cast<int16_t>(~stack.back()); break; }
+            const int16_t y = pop(), x = pop();
+            int16_t r{};
+            if (cmd.arg1 == "add")      r = static_cast<int16_t>(x + y);
+            else if (cmd.arg1 == "sub") r = static_cast<int16_t>(x - y);
+            else if (cmd.arg1 == "and") r = static_cast<int16_t>(x & y);
+            else if (cmd.arg1 == "or")  r = static_cast<int16_t>(x | y);
+            else if (cmd.arg1 == "eq")  r = (x == y) ? -1 : 0;
+            else if (cmd.arg1 == "gt")  r = (x > y) ? -1 : 0;
+            else                        r = (x < y) ? -1 : 0;
+            stack.push_back(r);
+            break;
+          }
+          case CommandType::C_GOTO:
+            pc = findLabel(start, cmd.arg1);
+            break;
+          case CommandType::C_IF:
+            if (pop() != 0) pc = findLabel(start, cmd.arg1);
+            break;
+          case CommandType::C_CALL: {
+            std::vector<int16_t> callArgs(stack.end() - cmd.arg2, stack.end());
+            stack.resize(stack.size() - cmd.arg2);
+            stack.push_back(run(cmd.arg1, std::move(callArgs), depth + 1));
+            break;
+          }
+          case CommandType::C_RETURN:
+            return pop();
+          default:
+            break;
+        }
+      }
+      throw std::runtime_error("step limit");
+    }
+};
+
+/** @brief Random but well-formed function bodies over locals, temps, statics and a helper call. */
+std::string randomProgram(std::mt19937& rng) {
+  const auto pick = [&](int n) { return static_cast<int>(rng() % static_cast<unsigned>(n)); };
+  const char* binary[] = { "add", "sub", "and", "or", "eq", "gt", "lt" };
+  const char* slots[]  = { "local", "temp", "static" };
+
+  std::ostringstream out;
+  out << "function Main.f 3\n";
+  int depth = 0, labels = 0;
+  for (int n = 10 + pick(30); n > 0; --n) {
+    const int r = pick(20);
+    if (depth < 2 || r < 7) {
+      const int kind = pick(5);
+      if (kind == 0)      out << "push constant " << pick(100) << '\n';
+      else if (kind == 1) out << "push argument " << pick(2) << '\n';
+      else                out << "push " << slots[kind - 2] << ' ' << pick(3) << '\n';
+      ++depth;
+    } else if (r < 11) {
+      out << binary[pick(7)] << '\n';
+      --depth;
+    } else if (r < 15) {
+      const int slot = pick(3);
+      out << "pop " << slots[slot] << ' ' << pick(3) << '\n';
+      if (pick(2) == 0) { out << "push " << slots[slot] << ' ' << pick(3) << '\n'; ++depth; }
+      --depth;
+    } else if (r < 17) {
+      out << "if-goto SKIP" << labels << "\npush constant 1\npop local " << pick(3) << "\nlabel SKIP" << labels << '\n';
+      ++labels;
+      --depth;
+    } else {
+      out << "call Main.g 1\n";
+    }
+  }
+  out << "push local 0\npush local 1\nadd\npush local 2\nadd\n";
+  for (++depth; depth > 1; --depth) out << "add\n";
+  out << "return\n";
+  out << "function Main.g 1\npush argument 0\npush constant 3\nadd\npop local 0\npush local 0\npush local 0\nadd\nreturn\n";
+  return out.str();
+}
+}
+
+/**
+ * @brief `pop x; push x` with x dead afterwards leaves the value on the stack.
+ */
+TEST(SlotOptimizerTest, forwardsDeadReloads) {
+  auto program = parse("function Main.f 1\npush constant 5\npop local 0\npush local 0\nreturn\n");
+  const SlotOptimizerStats stats = optimizeSlots(program, false);
+
+  EXPECT_EQ(stats.forwarded, 1u);
+  ASSERT_EQ(program.size(), 3u);
+  EXPECT_EQ(program[1].type, CommandType::C_PUSH);
+  EXPECT_EQ(program[2].type, CommandType::C_RETURN);
+}
+
+/**
+ * @brief Discarded call results become `drop` only when temps are private to each function.
+ */
+TEST(SlotOptimizerTest, dropsDeadTempStoresOnlyWhenTempsArePrivate) {
+  const std::string source = "function Main.f 0\ncall Main.g 0\npop temp 0\npush constant 0\nreturn\n";
+
+  auto shared = parse(source);
+  EXPECT_EQ(optimizeSlots(shared, false).droppedStores, 0u);
+  EXPECT_EQ(shared[2].type, CommandType::C_POP);
+
+  auto jack = parse(source);
+  EXPECT_EQ(optimizeSlots(jack, true).droppedStores, 1u);
+  EXPECT_EQ(jack[2].type, CommandType::C_ARITHMETIC);
+  EXPECT_EQ(jack[2].arg1, "drop");
+}
+
+/**
+ * @brief A push whose value is immediately dropped disappears together with the drop.
+ */
+TEST(SlotOptimizerTest, removesPushesFeedingDeadStores) {
+  auto program = parse("function Main.f 2\npush local 1\npop local 0\npush constant 0\nreturn\n");
+  const SlotOptimizerStats stats = optimizeSlots(program, false);
+
+  EXPECT_EQ(stats.droppedStores, 1u);
+  EXPECT_EQ(stats.removedPushes, 1u);
+  EXPECT_EQ(program.size(), 3u);
+}
+
+/**
+ * @brief Functions the analysis rejects, and code outside functions, are left as written.
+ */
+TEST(SlotOptimizerTest, leavesUnanalysableCodeAlone) {
+  const std::string source =
+    "push constant 1\npop temp 0\n"
+    "function Main.f 1\nlabel L\npush constant 1\npop local 0\npush constant 2\ngoto L\n";
+  auto program = parse(source);
+  optimizeSlots(program, true);
+
+  EXPECT_EQ(program.size(), parse(source).size());
+}
+
+/**
+ * @brief Differential run: optimized random programs compute the same results as the originals.
+ */
+TEST(SlotOptimizerTest, preservesBehaviourOnRandomPrograms) {
+  std::mt19937 rng(2024);
+  std::size_t removed{};
+
+  for (int trial{}; trial < 300; ++trial) {
+    const auto original = parse(randomProgram(rng));
+    auto optimized = original;
+    optimizeSlots(optimized, false);
+    removed += original.size() - optimized.size();
+
+    for (int16_t a : { 0, 1, 7 }) {
+      Evaluator before(original), after(optimized);
+      ASSERT_EQ(before.run("Main.f", { a, 3 }), after.run("Main.f", { a, 3 })) << "trial " << trial;
+      ASSERT_EQ(before.statics, after.statics) << "trial " << trial;
+    }
+  }
+  EXPECT_GT(removed, 0u);
+}
@@ -0,0 +1,235 @@
+/**
+ * @file vmInterpreter.cpp
+ * @brief Unit tests for running VM programs on the bytecode interpreter.
+ */
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "../Modules/Interpreter/vmInterpreter.h"
+#include "../Modules/VMTranslator/vmtranslator.h"
+
+using namespace testing;
+
+/**
+ * @class VmInterpreterTestObject
+ * @brief Test fixture that loads `.vm` sources through the translator's parser.
+ */
+class VmInterpreterTestObject : public ::testing::Test {
+  protected:
+    /** @brief Temporary directory holding the `.vm` files. */
+    std::filesystem::path dir;
+    /** @brief Output of the built-in `Output` routines. */
+    std::ostringstream out;
+    VmInterpreter vm { out };
+
+    void SetUp() override {
+      dir = std::filesystem::temp_directory_path() / "vminterpreter_tmp";
+      std::filesystem::remove_all(dir);
+      std::filesystem::create_directory(dir);
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(dir);
+    }
+
+    void load(const std::string& stem, const std::string& source) {
+      const std::filesystem::path path = dir / (stem + ".vm");
+      std::ofstream(path) << source;
+      vm.loadFile(stem, VMTranslator().loadFile(path.string()));
+    }
+};
+
+/**
+ * @brief Main.main runs from the stack base and leaves its result there.
+ */
+TEST_F(VmInterpreterTestObject, returnsEntryResultOnStackBase) {
+  load("Main",
+       "function Main.main 0\n"
+       "push constant 7\n"
+       "push constant 9\n"
+       "sub\n"
+       "neg\n"
+       "return\n");
+  vm.run();
+
+  EXPECT_EQ(vm.peek(0), VmInterpreter::kStackBase + 1);
+  EXPECT_EQ(vm.peek(VmInterpreter::kStackBase), 2);
+}
+
+/**
+ * @brief Calls resolve across files and build the translator's frames.
+ */
+TEST_F(VmInterpreterTestObject, runsRecursiveCallsAcrossFiles) {
+  load("Fib",
+       "function Fib.fib 0\n"
+       "push argument 0\n"
+       "push constant 2\n"
+       "lt\n"
+       "if-goto BASE\n"
+       "push argument 0\n"
+       "push constant 1\n"
+       "sub\n"
+       "call Fib.fib 1\n"
+       "push argument 0\n"
+       "push constant 2\n"
+       "sub\n"
+       "call Fib.fib 1\n"
+       "add\n"
+       "return\n"
+       "label BASE\n"
+       "push argument 0\n"
+       "return\n");
+  load("Sys",
+       "function Sys.init 0\n"
+       "push constant 20\n"
+       "call Fib.fib 1\n"
+       "pop static 0\n"
+       "label END\n"
+       "goto END\n");
+  vm.run();
+
+  EXPECT_EQ(vm.peek(16), 6765);
+}
+
+/**
+ * @brief Statics get addresses from 16 in order of first use, one set per file.
+ */
+TEST_F(VmInterpreterTestObject, allocatesStaticsPerFileInFirstUseOrder) {
+  load("A", "push constant 1\npop static 3\npush constant 2\npop static 0\n");
+  load("B", "push constant 3\npop static 3\n");
+  vm.run();
+
+  EXPECT_EQ(vm.peek(16), 1);
+  EXPECT_EQ(vm.peek(17), 2);
+  EXPECT_EQ(vm.peek(18), 3);
+}
+
+/**
+ * @brief OS routines the program does not define run natively; strings live on the heap.
+ */
+TEST_F(VmInterpreterTestObject, runsBuiltInOsRoutines) {
+  load("Main",
+       "function Main.main 0\n"
+       "push constant 2\n"
+       "call String.new 1\n"
+       "push constant 72\n"
+       "call String.appendChar 2\n"
+       "push constant 105\n"
+       "call String.appendChar 2\n"
+       "call Output.printString 1\n"
+       "pop temp 0\n"
+       "push constant 6\n"
+       "push constant 7\n"
+       "call Math.multiply 2\n"
+       "call Output.printInt 1\n"
+       "pop temp 0\n"
+       "call Sys.halt 0\n"
+       "push constant 1\n"
+       "pop static 0\n"
+       "push constant 0\n"
+       "return\n");
+  vm.run();
+
+  EXPECT_EQ(out.str(), "Hi42");
+  EXPECT_EQ(vm.peek(VmInterpreter::kHeapBase), 2);
+  EXPECT_EQ(vm.peek(16), 0);
+}
+
+/**
+ * @brief `Math.min`/`Math.max` compare like `lt`/`gt`, so compiled inline
+ *        code and the built-ins agree when the difference overflows.
+ */
+TEST_F(VmInterpreterTestObject, comparesMinAndMaxLikeLt) {
+  load("Main",
+       "function Main.main 0\n"
+       "push constant 32767\n"
+       "push constant 2\n"
+       "neg\n"
+       "call Math.min 2\n"
+       "call Output.printInt 1\n"
+       "pop temp 0\n"
+       "push constant 5\n"
+       "push constant 9\n"
+       "call Math.max 2\n"
+       "call Output.printInt 1\n"
+       "pop temp 0\n"
+       "push constant 32767\n"
+       "push constant 2\n"
+       "neg\n"
+       "call Math.max 2\n"
+       "return\n");
+  vm.run();
+
+  EXPECT_EQ(out.str(), "327679");
+  EXPECT_EQ(vm.peek(VmInterpreter::kStackBase), -2);
+}
+
+/**
+ * @brief `call-void` discards the result and `return-void` returns 0 to callers that want one.
+ */
+TEST_F(VmInterpreterTestObject, runsVoidCallsAndReturns) {
+  load("Main",
+       "function Main.main 0\n"
+       "push constant 4\n"
+       "call-void Main.show 1\n"
+       "push constant 3\n"
+       "call-void Output.printInt 1\n"
+       "push constant 2\n"
+       "call Main.show 1\n"
+       "return\n"
+       "function Main.show 0\n"
+       "push argument 0\n"
+       "call-void Output.printInt 1\n"
+       "return-void\n");
+  vm.run();
+
+  EXPECT_EQ(out.str(), "432");
+  EXPECT_EQ(vm.peek(0), VmInterpreter::kStackBase + 1);
+  EXPECT_EQ(vm.peek(VmInterpreter::kStackBase), 0);
+}
+
+/**
+ * @brief Program-defined functions take precedence over the built-ins.
+ */
+TEST_F(VmInterpreterTestObject, prefersProgramDefinitionsOverBuiltIns) {
+  load("Math", "function Math.multiply 0\npush constant 1\nreturn\n");
+  load("Main", "function Main.main 0\npush constant 6\npush constant 7\ncall Math.multiply 2\nreturn\n");
+  vm.run();
+
+  EXPECT_EQ(vm.peek(VmInterpreter::kStackBase), 1);
+}
+
+/**
+ * @brief A program without commands is an error rather than a jump past the code.
+ */
+TEST_F(VmInterpreterTestObject, rejectsEmptyPrograms) {
+  VmInterpreter empty;
+  EXPECT_THROW(empty.run(), std::runtime_error);
+
+  empty.loadFile("Main", {});
+  EXPECT_THROW(empty.run(), std::runtime_error);
+}
+
+/**
+ * @brief Undefined callees, Hack assembly, runaway loops and deep recursion are reported as errors.
+ */
+TEST_F(VmInterpreterTestObject, reportsUndefinedCallsAndRunawayPrograms) {
+  VmInterpreter undefined;
+  undefined.loadFile("Main", { { CommandType::C_CALL, "Screen.drawPixel", 2 } });
+  EXPECT_THROW(undefined.run(), std::runtime_error);
+
+  VmInterpreter assembly;
+  EXPECT_THROW(assembly.loadFile("Main", { { CommandType::C_ASM, "D=M" } }), std::runtime_error);
+
+  load("Main", "function Main.main 0\nlabel LOOP\npush constant 0\nnot\nif-goto LOOP\nreturn\n");
+  EXPECT_THROW(vm.run(1000), std::runtime_error);
+
+  VmInterpreter recursive;
+  recursive.loadFile("Main", { { CommandType::C_FUNCTION, "Main.main", 0 },
+                               { CommandType::C_CALL, "Main.main", 0 },
+                               { CommandType::C_RETURN, {}, 0 } });
+  EXPECT_THROW(recursive.run(), std::runtime_error);
+}
@@ -0,0 +1,280 @@
+/**
+ * @file vmTranslator.cpp
+ * @brief Unit tests for directory translation through VMTranslator.
+ */
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include "../Modules/VMTranslator/vmtranslator.h"
+
+using namespace testing;
+
+/**
+ * @class VMTranslatorTestObject
+ * @brief Test fixture that builds a temporary directory of `.vm` files.
+ */
+class VMTranslatorTestObject : public ::testing::Test {
+  protected:
+    /** @brief Temporary directory holding the input `.vm` files. */
+    std::filesystem::path dir;
+    /** @brief Output path for the translated assembly. */
+    std::filesystem::path asm_filepath;
+
+    void SetUp() override {
+      dir = std::filesystem::temp_directory_path() / "vmtranslator_tmp";
+      std::filesystem::remove_all(dir);
+      std::filesystem::create_directory(dir);
+      asm_filepath = dir / "out.asm";
+
+      // Written out of order on purpose; output must follow sorted file order.
+      for (const char* stem : { "Zeta", "Alpha", "Mid" }) {
+        std::ofstream file(dir / (std::string(stem) + ".vm"));
+        file << "function " << stem << ".run 0" << '\n';
+        file << "push constant 1" << '\n';
+        file << "push constant 2" << '\n';
+        file << "eq" << '\n';
+        file << "pop static 0" << '\n';
+        file << "call " << stem << ".run 0" << '\n';
+        file << "return" << '\n';
+      }
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(dir);
+    }
+
+    std::string translateDir(TranslatorOptions options = {}) {
+      VMTranslator translator(options);
+      translator.translate(dir.string(), asm_filepath.string());
+
+      std::ifstream asmFile(asm_filepath);
+      return std::string((std::istreambuf_iterator<char>(asmFile)), {});
+    }
+};
+
+/**
+ * @brief Files are concatenated in sorted order regardless of creation order.
+ */
+TEST_F(VMTranslatorTestObject, concatenatesFilesInSortedOrder) {
+  std::string content = translateDir();
+
+  size_t alpha = content.find("(Alpha.run)");
+  size_t mid   = content.find("(Mid.run)");
+  size_t zeta  = content.find("(Zeta.run)");
+
+  ASSERT_NE(alpha, std::string::npos);
+  ASSERT_NE(mid,   std::string::npos);
+  ASSERT_NE(zeta,  std::string::npos);
+  EXPECT_LT(alpha, mid);
+  EXPECT_LT(mid,   zeta);
+}
+
+/**
+ * @brief Each file gets its own label namespace, so per-file counters never collide.
+ */
+TEST_F(VMTranslatorTestObject, namespacesGeneratedLabelsPerFile) {
+  std::string content = translateDir();
+
+  EXPECT_NE(content.find("(Alpha$TRUE0)"), std::string::npos);
+  EXPECT_NE(content.find("(Mid$TRUE0)"),   std::string::npos);
+  EXPECT_NE(content.find("(Zeta$TRUE0)"),  std::string::npos);
+  EXPECT_NE(content.find("@Alpha.0"),      std::string::npos);
+  EXPECT_NE(content.find("@Zeta.0"),       std::string::npos);
+}
+
+/**
+ * @brief Concurrent translation produces byte-identical output on every run.
+ */
+TEST_F(VMTranslatorTestObject, outputIsDeterministic) {
+  std::string first = translateDir();
+  for (int run{}; run < 5; ++run)
+    EXPECT_EQ(translateDir(), first);
+}
+
+/**
+ * @brief `push constant 0` + `not` (Jack's `true`) folds into a single M=-1 push.
+ */
+TEST_F(VMTranslatorTestObject, foldsUnaryOpsIntoConstantPush) {
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directory(dir);
+  {
+    std::ofstream file(dir / "Fold.vm");
+    file << "push constant 0" << '\n';
+    file << "not" << '\n';
+    file << "push constant 7" << '\n';
+    file << "neg" << '\n';
+  }
+
+  std::string content = translateDir();
+
+  EXPECT_NE(content.find("M=-1\n"),     std::string::npos);
+  EXPECT_NE(content.find("@7\nD=-A\n"), std::string::npos);
+  EXPECT_EQ(content.find("// not"),     std::string::npos);
+  EXPECT_EQ(content.find("// neg"),     std::string::npos);
+}
+
+/**
+ * @brief `call f n` followed by `return` becomes a frame-reusing jump when the caller's arity is known.
+ */
+TEST_F(VMTranslatorTestObject, turnsCallReturnIntoTailCall) {
+  std::string content = translateDir();
+
+  EXPECT_NE(content.find("// tail call Alpha.run\n"), std::string::npos);
+  EXPECT_EQ(content.find("$ret."),                    std::string::npos);
+
+  TranslatorOptions options;
+  options.tailCalls = false;
+  content = translateDir(options);
+
+  EXPECT_EQ(content.find("// tail call"),       std::string::npos);
+  EXPECT_NE(content.find("(Alpha.run$ret.1)"),  std::string::npos);
+}
+
+/**
+ * @brief Frames save THIS/THAT only for callees that pop into `pointer`; entry points keep the full frame.
+ */
+TEST_F(VMTranslatorTestObject, specializesFramesOfCalledFunctions) {
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directory(dir);
+  {
+    std::ofstream file(dir / "Shape.vm");
+    file << "function Shape.leaf 0" << '\n';
+    file << "push constant 1" << '\n';
+    file << "return" << '\n';
+    file << "function Shape.method 0" << '\n';
+    file << "push argument 0" << '\n';
+    file << "pop pointer 0" << '\n';
+    file << "call Shape.leaf 0" << '\n';
+    file << "pop temp 0" << '\n';
+    file << "push constant 0" << '\n';
+    file << "return" << '\n';
+    file << "function Shape.main 0" << '\n';
+    file << "push constant 5" << '\n';
+    file << "call Shape.method 1" << '\n';
+    file << "pop temp 0" << '\n';
+    file << "push constant 0" << '\n';
+    file << "return" << '\n';
+  }
+
+  VMTranslator translator;
+  translator.translate(dir.string(), asm_filepath.string());
+  std::ostringstream report;
+  translator.writeFrameReport(report);
+
+  EXPECT_NE(report.str().find("Shape.leaf"),                 std::string::npos);
+  EXPECT_NE(report.str().find("ret LCL ARG THIS"),           std::string::npos);
+  EXPECT_EQ(report.str().find("Shape.main"),                 std::string::npos);
+  EXPECT_NE(report.str().find("2 of 3 functions specialized"), std::string::npos);
+
+  TranslatorOptions options;
+  options.frameSpecialization = false;
+  options.voidReturns = false;
+  VMTranslator plain(options);
+  plain.translate(dir.string(), asm_filepath.string());
+  std::ostringstream none;
+  plain.writeFrameReport(none);
+
+  EXPECT_NE(none.str().find("0 of 0 functions specialized"), std::string::npos);
+}
+
+/**
+ * @brief A function only reached by `call-void` returns no value and its callers drop none;
+ *        one also called for its value keeps returning 0 from `return-void`.
+ */
+TEST_F(VMTranslatorTestObject, returnsNoValueToVoidCallers) {
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directory(dir);
+  {
+    std::ofstream file(dir / "Main.vm");
+    file << "function Main.main 0" << '\n';
+    file << "call-void Main.show 0" << '\n';
+    file << "call-void Main.count 0" << '\n';
+    file << "call Main.count 0" << '\n';
+    file << "return" << '\n';
+    file << "function Main.show 0" << '\n';
+    file << "return-void" << '\n';
+    file << "function Main.count 0" << '\n';
+    file << "return-void" << '\n';
+  }
+
+  TranslatorOptions options;
+  options.optimizeSlots = false;
+  VMTranslator translator(options);
+  translator.translate(dir.string(), asm_filepath.string());
+  std::ostringstream report;
+  translator.writeFrameReport(report);
+  std::ifstream asmFile(asm_filepath);
+  const std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  EXPECT_NE(report.str().find("ret LCL ARG void"), std::string::npos);
+  EXPECT_NE(report.str().find("2 of 3 functions specialized"), std::string::npos);
+
+  // Main.show: SP = ARG, without writing ARG[0]; Main.count pushes 0 and is dropped after the void call.
+  EXPECT_NE(content.find("(Main.show)\n@LCL\nD=M\n@R13\nM=D\n@3\nA=D-A\nD=M\n@R14\nM=D\n@ARG\nD=M\n@SP\nM=D\n"),
+            std::string::npos);
+  EXPECT_NE(content.find("(Main.count)\n@SP\nM=M+1\nA=M-1\nM=0\n"), std::string::npos);
+  EXPECT_NE(content.find("(Main.main$ret.1)\n// drop\n"), std::string::npos);
+  EXPECT_EQ(content.find("(Main.main$ret.0)\n// drop\n"), std::string::npos);
+}
+
+/**
+ * @brief `asm` lines reach the output unchanged; the slots and pointers they may use are kept.
+ */
+TEST_F(VMTranslatorTestObject, passesAsmThroughOpaquely) {
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directory(dir);
+  {
+    std::ofstream file(dir / "Main.vm");
+    file << "function Main.main 0" << '\n';
+    file << "call-void Main.fill 0" << '\n';
+    file << "return-void" << '\n';
+    file << "function Main.fill 1" << '\n';
+    file << "push constant 5" << '\n';
+    file << "pop local 0" << '\n';
+    file << "asm @LCL" << '\n';
+    file << "asm A = M" << '\n';
+    file << "asm D = M" << '\n';
+    file << "asm @THIS" << '\n';
+    file << "asm M = D" << '\n';
+    file << "return-void" << '\n';
+  }
+
+  TranslatorOptions options;
+  options.privateTemps = true;
+  VMTranslator translator(options);
+  translator.translate(dir.string(), asm_filepath.string());
+  std::ostringstream report;
+  translator.writeFrameReport(report);
+  std::ifstream asmFile(asm_filepath);
+  const std::string content((std::istreambuf_iterator<char>(asmFile)), {});
+
+  // The store into local 0 is kept, since the asm may read it.
+  EXPECT_NE(content.find("@R13\nA=M\nM=D\n@LCL\nA=M\nD=M\n@THIS\nM=D\n"), std::string::npos);
+  EXPECT_NE(report.str().find("ret LCL ARG THIS THAT void"), std::string::npos);
+}
+
+/**
+ * @brief The cost report splits each function into blocks and adds up to the emitted code.
+ */
+TEST_F(VMTranslatorTestObject, reportsStaticCostPerFunctionAndBlock) {
+  const std::string content = translateDir();
+
+  std::size_t words{};
+  std::istringstream lines(content);
+  for (std::string line; std::getline(lines, line);)
+    if (!line.empty() && line[0] != '(' && line.rfind("//", 0) != 0)
+      ++words;
+
+  VMTranslator translator;
+  translator.translate(dir.string(), asm_filepath.string());
+  std::ostringstream report;
+  translator.writeCostReport(report);
+
+  EXPECT_NE(report.str().find("\nAlpha.run: "),     std::string::npos);
+  EXPECT_NE(report.str().find("  block 0 "),        std::string::npos);
+  EXPECT_NE(report.str().find("    pop static 0 "), std::string::npos);
+  EXPECT_NE(report.str().find(std::to_string(words) + " instructions in 3 functions"), std::string::npos);
+}
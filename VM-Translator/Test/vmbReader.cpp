@@ -0,0 +1,180 @@
+/**
+ * @file vmbReader.cpp
+ * @brief Unit tests for loading binary `.vmb` files.
+ */
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../Modules/Parser/vmbReader.h"
+#include "../Modules/VMTranslator/vmtranslator.h"
+#include "../../Common/vmbFormat.h"
+
+using namespace testing;
+
+/**
+ * @class VmbReaderTestObject
+ * @brief Test fixture holding the same program as `.vm` text and as `.vmb` bytes.
+ */
+class VmbReaderTestObject : public ::testing::Test {
+  protected:
+    /** @brief Temporary directory holding the input files. */
+    std::filesystem::path dir;
+
+    const std::string text {
+      "function Main.main 2\n"
+      "push constant 300\n"
+      "pop local 1\n"
+      "label Main.main$LOOP\n"
+      "push local 1\n"
+      "push static 0\n"
+      "lt\n"
+      "if-goto Main.main$LOOP\n"
+      "call Main.main 0\n"
+      "pop temp 0\n"
+      "asm D = M\n"
+      "call-void Main.main 0\n"
+      "goto Main.main$LOOP\n"
+      "return-void\n"
+    };
+
+    /** @brief `text` encoded as the compiler's binary writer encodes it. */
+    std::string binary() const {
+      std::string code;
+      uint32_t count{};
+      const auto op = [&code, &count](uint8_t opcode, std::initializer_list<uint32_t> operands = {}) {
+        code.push_back(static_cast<char>(opcode));
+        for (uint32_t operand : operands) vmb::appendVarint(code, operand);
+        ++count;
+      };
+      op(vmb::kOpFunction, { 0, 2 });
+      op(vmb::kOpPush + 0, { 300 });  // constant
+      op(vmb::kOpPop + 2, { 1 });     // local
+      op(vmb::kOpLabel, { 1 });
+      op(vmb::kOpPush + 2, { 1 });
+      op(vmb::kOpPush + 3, { 0 });    // static
+      op(vmb::kOpAdd + 5);            // lt
+      op(vmb::kOpIfGoto, { 1 });
+      op(vmb::kOpCall, { 0, 0 });
+      op(vmb::kOpPop + 7, { 0 });     // temp
+      op(vmb::kOpAsm, { 2 });
+      op(vmb::kOpCallVoid, { 0, 0 });
+      op(vmb::kOpGoto, { 1 });
+      op(vmb::kOpReturnVoid);
+
+      std::string out(vmb::kMagic, sizeof(vmb::kMagic));
+      out.push_back(static_cast<char>(vmb::kVersion));
+      vmb::appendVarint(out, 3);
+      for (const std::string name : { "Main.main", "Main.main$LOOP", "D=M" }) {
+        vmb::appendVarint(out, static_cast<uint32_t>(name.size()));
+        out += name;
+      }
+      vmb::appendVarint(out, count);
+      return out + code;
+    }
+
+    void SetUp() override {
+      dir = std::filesystem::temp_directory_path() / "vmbreader_tmp";
+      std::filesystem::remove_all(dir);
+      std::filesystem::create_directory(dir);
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(dir);
+    }
+
+    std::filesystem::path write(const std::string& name, const std::string& content) const {
+      const std::filesystem::path path = dir / name;
+      std::ofstream(path, std::ios::binary) << content;
+      return path;
+    }
+};
+
+/**
+ * @brief A `.vmb` file loads into exactly the commands of its text form.
+ */
+TEST_F(VmbReaderTestObject, loadsSameCommandsAsText) {
+  VMTranslator loader;
+  const std::vector<VmCommand> fromText   = loader.loadFile(write("Main.vm", text).string());
+  const std::vector<VmCommand> fromBinary = loader.loadFile(write("Main.vmb", binary()).string());
+
+  ASSERT_EQ(fromBinary.size(), fromText.size());
+  EXPECT_EQ(fromText[10].arg1, "D=M");
+  EXPECT_TRUE(fromText[11].isVoid);
+  for (std::size_t i{}; i < fromText.size(); ++i) {
+    EXPECT_EQ(fromBinary[i].type, fromText[i].type)  << "command " << i;
+    EXPECT_EQ(fromBinary[i].arg1, fromText[i].arg1)  << "command " << i;
+    EXPECT_EQ(fromBinary[i].arg2, fromText[i].arg2)  << "command " << i;
+    EXPECT_EQ(fromBinary[i].isVoid, fromText[i].isVoid) << "command " << i;
+  }
+}
+
+/**
+ * @brief Truncated, unknown and inconsistent data is rejected instead of misread.
+ */
+TEST_F(VmbReaderTestObject, rejectsMalformedFiles) {
+  const std::string bytes = binary();
+  std::string unknownOpcode = bytes;
+  unknownOpcode.back() = '\x7f';
+  std::string badStringId = bytes;
+  badStringId[badStringId.size() - 3] = 9;  // goto operand
+
+  EXPECT_NO_THROW(loadVmb(write("ok.vmb", bytes).string()));
+  EXPECT_THROW(loadVmb(write("a.vmb", "VMX\x01").string()),                         std::runtime_error);
+  EXPECT_THROW(loadVmb(write("b.vmb", bytes.substr(0, bytes.size() - 1)).string()), std::runtime_error);
+  EXPECT_THROW(loadVmb(write("c.vmb", bytes + '\x25').string()),                    std::runtime_error);
+  EXPECT_THROW(loadVmb(write("d.vmb", unknownOpcode).string()),                     std::runtime_error);
+  EXPECT_THROW(loadVmb(write("e.vmb", badStringId).string()),                       std::runtime_error);
+}
+
+/**
+ * @brief Opcodes must exist in the file's version and operands must fit an A-instruction.
+ */
+TEST_F(VmbReaderTestObject, checksVersionAndOperandRange) {
+  const auto file = [](uint8_t version, uint8_t opcode, uint32_t operand) {
+    std::string out(vmb::kMagic, sizeof(vmb::kMagic));
+    out.push_back(static_cast<char>(version));
+    vmb::appendVarint(out, 1);
+    vmb::appendVarint(out, 6);
+    out += "Main.f";
+    vmb::appendVarint(out, 2);
+    out.push_back(static_cast<char>(opcode));
+    vmb::appendVarint(out, 0);
+    vmb::appendVarint(out, operand);
+    out.push_back(static_cast<char>(vmb::kOpReturn));
+    return out;
+  };
+
+  EXPECT_NO_THROW(loadVmb(write("a.vmb", file(1, vmb::kOpCall, 0x7FFF)).string()));
+  EXPECT_NO_THROW(loadVmb(write("b.vmb", file(2, vmb::kOpCallVoid, 2)).string()));
+  EXPECT_THROW(loadVmb(write("c.vmb", file(1, vmb::kOpCallVoid, 2)).string()), std::runtime_error);
+  EXPECT_THROW(loadVmb(write("d.vmb", file(1, vmb::kOpFunction, 0x8000)).string()), std::runtime_error);
+  EXPECT_THROW(loadVmb(write("e.vmb", file(1, vmb::kOpCall, 0xFFFFFFFF)).string()), std::runtime_error);
+
+  std::string asmInVersion2 = binary();
+  asmInVersion2[sizeof(vmb::kMagic)] = 2;
+  EXPECT_THROW(loadVmb(write("f.vmb", asmInVersion2).string()), std::runtime_error);
+
+  std::string hugeStringTable(vmb::kMagic, sizeof(vmb::kMagic));
+  hugeStringTable.push_back(static_cast<char>(vmb::kVersion));
+  vmb::appendVarint(hugeStringTable, 0xFFFFFFFF);
+  EXPECT_THROW(loadVmb(write("g.vmb", hugeStringTable).string()), std::runtime_error);
+}
+
+/**
+ * @brief Directories may mix text and binary files, but not both forms of the same file.
+ */
+TEST_F(VmbReaderTestObject, translatesBinaryFilesInDirectories) {
+  write("Main.vmb", binary());
+  write("Other.vm", "function Other.f 0\npush constant 0\nreturn\n");
+
+  VMTranslator translator;
+  EXPECT_EQ(translator.collectVmFiles(dir.string()).size(), 2u);
+  EXPECT_NO_THROW(translator.translate(dir.string(), (dir / "out.asm").string()));
+
+  write("Main.vm", text);
+  EXPECT_THROW(translator.collectVmFiles(dir.string()), std::runtime_error);
+}
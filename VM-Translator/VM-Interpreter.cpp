@@ -0,0 +1,36 @@
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Modules/Interpreter/vmInterpreter.h"
+#include "Modules/VMTranslator/vmtranslator.h"
+
+int main(int argc, char** argv) {
+  const std::string usage { "[ERROR] Usage: VM-Interpreter [--max-steps N] <input.vm | directory>\n" };
+
+  uint64_t maxSteps { VmInterpreter::kDefaultStepLimit };
+  std::vector<std::string> paths;
+  for (int i{1}; i < argc; ++i) {
+    const std::string arg { argv[i] };
+    if (arg == "--max-steps" && i + 1 < argc)
+      maxSteps = std::stoull(argv[++i]);
+    else if (arg.rfind("--", 0) == 0)
+      throw std::logic_error(usage);
+    else
+      paths.push_back(arg);
+  }
+  if (paths.size() != 1)
+    throw std::logic_error(usage);
+
+  VMTranslator loader;
+  VmInterpreter interpreter(std::cout);
+  for (const std::string& vmFile : loader.collectVmFiles(paths[0]))
+    interpreter.loadFile(std::filesystem::path(vmFile).stem().string(), loader.loadFile(vmFile));
+
+  const uint64_t steps = interpreter.run(maxSteps);
+  std::cout << std::flush;
+  std::cerr << steps << " instructions executed, SP=" << interpreter.peek(0) << '\n';
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Modules/Analysis/functionAnalysis.h"
+#include "Modules/VMTranslator/vmtranslator.h"
+
+int main(int argc, char** argv) {
+  const std::string usage { "[ERROR] Usage: VM-Stats [--private-temps] <input.vm | directory>\n" };
+
+  bool privateTemps {};
+  std::vector<std::string> paths;
+  for (int i{1}; i < argc; ++i) {
+    const std::string arg { argv[i] };
+    if (arg == "--private-temps")
+      privateTemps = true;
+    else if (arg.rfind("--", 0) == 0)
+      throw std::logic_error(usage);
+    else
+      paths.push_back(arg);
+  }
+  if (paths.size() != 1)
+    throw std::logic_error(usage);
+
+  VMTranslator loader;
+  std::vector<FunctionAnalysis> functions;
+  for (const std::string& vmFile : loader.collectVmFiles(paths[0]))
+    for (FunctionAnalysis& function : analyzeFunctions(loader.loadFile(vmFile), privateTemps))
+      functions.push_back(std::move(function));
+
+  std::cout << std::left << std::setw(32) << "Function" << std::right
+            << std::setw(8) << "Blocks" << std::setw(8) << "Edges" << std::setw(8) << "Locals"
+            << std::setw(10) << "MaxDepth" << std::setw(10) << "MaxStack" << std::setw(12) << "DeadStores" << '\n';
+
+  std::set<std::string> called;
+  for (const FunctionAnalysis& function : functions) {
+    std::size_t edges{};
+    for (const BasicBlock& block : function.blocks())
+      edges += block.successors.size();
+
+    std::cout << std::left << std::setw(32) << function.name() << std::right
+              << std::setw(8) << function.blocks().size() << std::setw(8) << edges
+              << std::setw(8) << function.localCount() << std::setw(10) << function.maxDepth()
+              << std::setw(10) << function.maxStackUsage() << std::setw(12) << function.deadStores().size() << '\n';
+
+    for (const std::string& callee : function.callees())
+      if (callee != function.name())
+        called.insert(callee);
+  }
+
+  // Entry points are the functions nothing else in the program calls.
+  std::cout << "\nStack high-water mark (words, including callees):\n";
+  for (const FunctionAnalysis& function : functions) {
+    if (called.count(function.name()))
+      continue;
+    const auto words = stackHighWater(functions, function.name());
+    std::cout << "  " << function.name() << ": "
+              << (words ? std::to_string(*words) : std::string("unbounded (recursive)")) << '\n';
+  }
+
+  return 0;
+}
@@ -1,12 +1,53 @@
+#include <iostream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 #include "Modules/VMTranslator/vmtranslator.h"
 
 int main(int argc, char** argv) {
-  if (argc < 2 || argc > 3)
-    std::logic_error("[ERROR] Usage: VmTranslator <input.vm | directory> [output.asm]\n");
+  const std::string usage {
+    "[ERROR] Usage: VmTranslator [--no-alu-constants] [--no-tail-calls] [--batch-sp] [--no-frame-specialization] [--no-void-returns] [--report-frames] [--report-costs] [--no-optimize-slots] [--private-temps] <input.vm | directory> [output.asm | output.hack | output.bin]\n"
+  };
 
-  VMTranslator translator;
-  translator.translate(argv[1], argc == 3 ? argv[2] : "");
+  TranslatorOptions options;
+  bool reportFrames {};
+  bool reportCosts {};
+  std::vector<std::string> paths;
+  for (int i{1}; i < argc; ++i) {
+    const std::string arg { argv[i] };
+    if (arg == "--no-alu-constants")
+      options.aluConstants = false;
+    else if (arg == "--no-tail-calls")
+      options.tailCalls = false;
+    else if (arg == "--batch-sp")
+      options.spBatching = true;
+    else if (arg == "--no-frame-specialization")
+      options.frameSpecialization = false;
+    else if (arg == "--no-void-returns")
+      options.voidReturns = false;
+    else if (arg == "--report-frames")
+      reportFrames = true;
+    else if (arg == "--report-costs")
+      reportCosts = true;
+    else if (arg == "--no-optimize-slots")
+      options.optimizeSlots = false;
+    else if (arg == "--private-temps")
+      options.privateTemps = true;
+    else if (arg.rfind("--", 0) == 0)
+      throw std::logic_error(usage);
+    else
+      paths.push_back(arg);
+  }
+
+  if (paths.empty() || paths.size() > 2)
+    throw std::logic_error(usage);
+
+  VMTranslator translator(options);
+  translator.translate(paths[0], paths.size() == 2 ? paths[1] : "");
+  if (reportFrames)
+    translator.writeFrameReport(std::cout);
+  if (reportCosts)
+    translator.writeCostReport(std::cout);
 
   return 0;
 }